@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "algorithm.hpp"
+#include "functional.hpp"
+#include "utility.hpp"
+
+namespace mrsuyi {
+// counting bloom filter over hash codes, blocked by cache line
+// a code picks one 64-byte block and sets up to 8 of its 4-bit counters, the
+// i-th one in the i-th word of the block. a query thus touches a single cache
+// line, and the probes are independent multiply-shifts over 8 lanes that the
+// compiler is free to vectorize. counters saturate at 15 and then stay, so an
+// erase can never make a present code look absent
+class counting_bloom_filter {
+ public:
+  // ctor & dtor
+  counting_bloom_filter();
+  // room for [capacity] codes at a false positive rate of about [fp_rate]
+  counting_bloom_filter(size_t capacity, double fp_rate);
+  counting_bloom_filter(const counting_bloom_filter& other);
+  counting_bloom_filter(counting_bloom_filter&& other) noexcept;
+  ~counting_bloom_filter();
+
+  counting_bloom_filter& operator=(counting_bloom_filter other) noexcept;
+
+  // modifiers
+  void insert(uint64_t code);
+  // [code] must have been inserted
+  void erase(uint64_t code);
+  void clear();
+  void swap(counting_bloom_filter& other) noexcept;
+
+  // lookup
+  // false only if [code] was never inserted
+  bool may_contain(uint64_t code) const;
+
+  // observers
+  size_t capacity() const;
+  double fp_rate() const;
+  size_t block_count() const;
+  size_t probes() const;
+
+ protected:
+  struct block {
+    uint64_t words[8];
+  };
+
+  // two rounds of mixing, one leaves structured codes(e.g. consecutive
+  // integers) clustered enough to show in the false positive rate
+  static uint64_t mix(uint64_t code);
+  block& block_of(uint64_t h) const;
+  // word of the [i]-th probe, with fewer than 8 probes each code starts at
+  // its own word so that all of them get used
+  static size_t word_of(uint64_t h, size_t i);
+  // bit offset of the counter of the [i]-th probe in its word
+  static size_t shift_of(uint64_t h, size_t i);
+  // false positive rate with [per_code] counters per code and [k] probes
+  static double expected_fp(double per_code, size_t k);
+
+  static const uint64_t counter_max = 15;
+  static const size_t max_per_code = 64;
+
+ protected:
+  block* blocks_;
+  size_t block_count_;
+  size_t probes_;
+  size_t capacity_;
+  double fp_rate_;
+};
+
+//=================================== basic ==================================//
+inline counting_bloom_filter::counting_bloom_filter()
+    : blocks_(nullptr),
+      block_count_(0),
+      probes_(0),
+      capacity_(0),
+      fp_rate_(1) {}
+inline counting_bloom_filter::counting_bloom_filter(size_t capacity,
+                                                    double fp_rate)
+    : capacity_(capacity), fp_rate_(fp_rate) {
+  // the fewest counters per code, with the best probe count for them, that
+  // reach [fp_rate]. blocking costs more counters than the classic sizing,
+  // the more so the lower the rate, so that is where the search starts
+  double ln2 = std::log(2.0);
+  double per_code = max(1.0, std::floor(-std::log(fp_rate) / (ln2 * ln2)));
+  for (;; per_code += 0.5) {
+    double best = 1;
+    for (size_t k = 1; k <= 8; ++k) {
+      double fp = expected_fp(per_code, k);
+      if (fp < best) {
+        best = fp;
+        probes_ = k;
+      }
+    }
+    if (best <= fp_rate || per_code >= max_per_code)
+      break;
+  }
+  block_count_ = max(size_t(1), size_t(std::ceil(per_code * capacity / 128)));
+  void* p;
+  if (posix_memalign(&p, 64, block_count_ * sizeof(block)))
+    throw std::bad_alloc();
+  blocks_ = static_cast<block*>(p);
+  clear();
+}
+inline counting_bloom_filter::counting_bloom_filter(
+    const counting_bloom_filter& other)
+    : blocks_(nullptr),
+      block_count_(other.block_count_),
+      probes_(other.probes_),
+      capacity_(other.capacity_),
+      fp_rate_(other.fp_rate_) {
+  if (other.blocks_) {
+    void* p;
+    if (posix_memalign(&p, 64, block_count_ * sizeof(block)))
+      throw std::bad_alloc();
+    blocks_ = static_cast<block*>(p);
+    memcpy(blocks_, other.blocks_, block_count_ * sizeof(block));
+  }
+}
+inline counting_bloom_filter::counting_bloom_filter(
+    counting_bloom_filter&& other) noexcept
+    : counting_bloom_filter() {
+  swap(other);
+}
+inline counting_bloom_filter::~counting_bloom_filter() {
+  free(blocks_);
+}
+// =
+inline counting_bloom_filter& counting_bloom_filter::operator=(
+    counting_bloom_filter other) noexcept {
+  swap(other);
+  return *this;
+}
+
+//================================= modifiers ================================//
+inline void counting_bloom_filter::insert(uint64_t code) {
+  uint64_t h = mix(code);
+  block& b = block_of(h);
+  for (size_t i = 0; i < probes_; ++i) {
+    uint64_t& w = b.words[word_of(h, i)];
+    size_t s = shift_of(h, i);
+    if ((w >> s & counter_max) != counter_max)
+      w += uint64_t(1) << s;
+  }
+}
+inline void counting_bloom_filter::erase(uint64_t code) {
+  uint64_t h = mix(code);
+  block& b = block_of(h);
+  for (size_t i = 0; i < probes_; ++i) {
+    uint64_t& w = b.words[word_of(h, i)];
+    size_t s = shift_of(h, i);
+    uint64_t c = w >> s & counter_max;
+    if (c && c != counter_max)
+      w -= uint64_t(1) << s;
+  }
+}
+inline void counting_bloom_filter::clear() {
+  if (blocks_)
+    memset(blocks_, 0, block_count_ * sizeof(block));
+}
+inline void counting_bloom_filter::swap(counting_bloom_filter& other) noexcept {
+  mrsuyi::swap(blocks_, other.blocks_);
+  mrsuyi::swap(block_count_, other.block_count_);
+  mrsuyi::swap(probes_, other.probes_);
+  mrsuyi::swap(capacity_, other.capacity_);
+  mrsuyi::swap(fp_rate_, other.fp_rate_);
+}
+
+//================================== lookup ==================================//
+inline bool counting_bloom_filter::may_contain(uint64_t code) const {
+  if (!blocks_)
+    return true;
+  uint64_t h = mix(code);
+  const block& b = block_of(h);
+  // no early exit, every probe is already in the cache line
+  bool res = true;
+  for (size_t i = 0; i < probes_; ++i)
+    res &= (b.words[word_of(h, i)] >> shift_of(h, i) & counter_max) != 0;
+  return res;
+}
+
+//================================= observers ================================//
+inline size_t counting_bloom_filter::capacity() const {
+  return capacity_;
+}
+inline double counting_bloom_filter::fp_rate() const {
+  return fp_rate_;
+}
+inline size_t counting_bloom_filter::block_count() const {
+  return block_count_;
+}
+inline size_t counting_bloom_filter::probes() const {
+  return probes_;
+}
+
+//================================= protected ================================//
+inline uint64_t counting_bloom_filter::mix(uint64_t code) {
+  return hash_mix(hash_int(code) ^ hash_secret[2], hash_secret[3]);
+}
+inline counting_bloom_filter::block& counting_bloom_filter::block_of(
+    uint64_t h) const {
+  // the high bits pick the block, the low ones the words & counters
+  return blocks_[((h >> 32) * block_count_) >> 32];
+}
+inline size_t counting_bloom_filter::word_of(uint64_t h, size_t i) {
+  return ((h >> 32) + i) & 7;
+}
+inline size_t counting_bloom_filter::shift_of(uint64_t h, size_t i) {
+  // odd constants, a multiply-shift per word (Impala & Parquet use the same)
+  static const uint32_t salts[8] = {0x47b6137bu, 0x44974d91u, 0x8824ad5bu,
+                                    0xa2b7289du, 0x705495c7u, 0x2df1424bu,
+                                    0x9efc4947u, 0x5c6bfb31u};
+  return ((uint32_t(h) * salts[i]) >> 28) * 4;
+}
+inline double counting_bloom_filter::expected_fp(double per_code, size_t k) {
+  // the codes per block are poisson distributed, a block of [j] codes got
+  // j * k / 8 probes per word, any of which may have taken a given counter
+  double mean = 128 / per_code;
+  double p = std::exp(-mean), res = 0, seen = 0;
+  for (size_t j = 0; seen < 1 - 1e-9 && j < 10 * mean + 100; ++j) {
+    double taken = 1 - std::pow(15.0 / 16, double(j) * k / 8);
+    res += p * std::pow(taken, double(k));
+    seen += p;
+    p *= mean / (j + 1);
+  }
+  return res;
+}
+}  // namespace mrsuyi
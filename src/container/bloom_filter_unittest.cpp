@@ -0,0 +1,52 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "bloom_filter.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(BloomFilterTest, Basic) {
+  // an unsized filter rules nothing out
+  counting_bloom_filter empty;
+  assert(empty.may_contain(1));
+
+  counting_bloom_filter f(1000, 0.01);
+  EXPECT_EQ(1000, f.capacity());
+  EXPECT_GE(f.probes(), 1);
+  EXPECT_LE(f.probes(), 8);
+  for (uint64_t i = 0; i < 1000; ++i)
+    f.insert(i);
+  for (uint64_t i = 0; i < 1000; ++i)
+    assert(f.may_contain(i));
+
+  // counting, a code stays until erased as often as inserted
+  f.insert(5000);
+  f.insert(5000);
+  f.erase(5000);
+  assert(f.may_contain(5000));
+  for (uint64_t i = 0; i < 1000; i += 2)
+    f.erase(i);
+  for (uint64_t i = 1; i < 1000; i += 2)
+    assert(f.may_contain(i));
+
+  counting_bloom_filter copy(f);
+  f.clear();
+  assert(copy.may_contain(1));
+  counting_bloom_filter moved(mrsuyi::move(copy));
+  assert(moved.may_contain(1));
+}
+
+TEST(BloomFilterTest, FalsePositiveRate) {
+  const double rates[] = {0.1, 0.01, 0.001};
+  for (double rate : rates) {
+    const uint64_t n = 100000;
+    counting_bloom_filter f(n, rate);
+    for (uint64_t i = 0; i < n; ++i)
+      f.insert(i);
+    size_t passed = 0;
+    for (uint64_t i = n; i < 2 * n; ++i)
+      passed += f.may_contain(i);
+    EXPECT_LT(double(passed) / n, rate * 1.5);
+  }
+}
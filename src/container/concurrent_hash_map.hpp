@@ -0,0 +1,299 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "functional.hpp"
+#include "hash_table.hpp"
+#include "memory.hpp"
+#include "utility.hpp"
+
+namespace mrsuyi {
+// reader-writer spinlock favoring writers: a waiting writer turns new readers
+// away, so a steady stream of readers cannot starve it
+class rw_spinlock {
+ public:
+  rw_spinlock() : state_(0) {}
+  rw_spinlock(const rw_spinlock&) = delete;
+  rw_spinlock& operator=(const rw_spinlock&) = delete;
+
+  void lock_shared() {
+    for (size_t spins = 0;; relax(spins)) {
+      uint32_t s = state_.load(std::memory_order_relaxed);
+      if (!(s & (writer | pending)) &&
+          state_.compare_exchange_weak(s, s + reader,
+                                       std::memory_order_acquire))
+        return;
+    }
+  }
+  void unlock_shared() { state_.fetch_sub(reader, std::memory_order_release); }
+  void lock() {
+    for (size_t spins = 0;; relax(spins)) {
+      uint32_t s = state_.load(std::memory_order_relaxed);
+      if ((s == 0 || s == pending) &&
+          state_.compare_exchange_weak(s, writer, std::memory_order_acquire))
+        return;
+      if (!(s & pending))
+        state_.fetch_or(pending, std::memory_order_relaxed);
+    }
+  }
+  void unlock() { state_.fetch_and(~writer, std::memory_order_release); }
+
+ private:
+  static const uint32_t writer = 1;
+  static const uint32_t pending = 2;
+  static const uint32_t reader = 4;
+
+  // busy-wait a little, then give the core away
+  static void relax(size_t& spins) {
+    if (++spins > 64)
+      std::this_thread::yield();
+  }
+
+  std::atomic<uint32_t> state_;
+};
+
+// hash map split into independently locked hash_table segments, picked by
+// the high bits of the hash. no iterator ever leaves the map, values are
+// copied out or visited while their segment is locked
+template <class Key,
+          class T,
+          class Hash = hash<Key>,
+          class KeyEqual = equal_to<Key>,
+          class Allocator = allocator<pair<const Key, T>>>
+class concurrent_hash_map {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = pair<const Key, T>;
+  using size_type = size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using table_type = hash_table<value_type,
+                                Key,
+                                Hash,
+                                select1st<value_type>,
+                                KeyEqual,
+                                Allocator>;
+
+ private:
+  struct segment {
+    mutable rw_spinlock lock;
+    table_type table;
+    // keeps the lock of the next segment off this cache line
+    char pad[64];
+  };
+  struct read_guard {
+    explicit read_guard(const segment& seg) : lock(seg.lock) {
+      lock.lock_shared();
+    }
+    ~read_guard() { lock.unlock_shared(); }
+
+    rw_spinlock& lock;
+  };
+  using write_guard = std::lock_guard<rw_spinlock>;
+
+ public:
+  // ctor & dtor
+  // [segments] is rounded up to a power of two
+  explicit concurrent_hash_map(size_t segments = 16,
+                               const Hash& = Hash(),
+                               const KeyEqual& = KeyEqual(),
+                               const Allocator& = Allocator());
+  concurrent_hash_map(const concurrent_hash_map&) = delete;
+  ~concurrent_hash_map();
+
+  concurrent_hash_map& operator=(const concurrent_hash_map&) = delete;
+
+  // capacity, only exact while nobody writes
+  bool empty() const;
+  size_t size() const;
+
+  // modifiers
+  void clear();
+  // insert unless [key] is present, returns whether inserted
+  bool insert(const Key& key, const T& val);
+  // insert or overwrite, returns whether [key] was absent
+  bool insert_or_assign(const Key& key, const T& val);
+  size_t erase(const Key& key);
+
+  // lookup
+  // copy the value of [key] to [val], returns whether present
+  bool find(const Key& key, T& val) const;
+  size_t count(const Key& key) const;
+  // call [fn] on the element of [key] while holding its segment, exclusively
+  // for visit and shared for cvisit. returns whether [key] was present
+  template <class F>
+  bool visit(const Key& key, F fn);
+  template <class F>
+  bool cvisit(const Key& key, F fn) const;
+  // call [fn] on every element, locking one segment at a time
+  template <class F>
+  void cvisit_all(F fn) const;
+
+  // hash policy
+  size_t segment_count() const;
+  void reserve(size_t count);
+
+  // observers
+  Hash hash_function() const;
+  KeyEqual key_eq() const;
+
+ private:
+  segment& segment_of(const Key& key) const;
+
+ private:
+  segment* segments_;
+  size_t mask_;
+  Hash hash_;
+};
+
+//=================================== basic ==================================//
+template <class K, class T, class H, class Q, class A>
+concurrent_hash_map<K, T, H, Q, A>::concurrent_hash_map(size_t segments,
+                                                        const H& hash,
+                                                        const Q& key_equal,
+                                                        const A& alloc)
+    : hash_(hash) {
+  size_t count = 1;
+  for (; count < segments; count *= 2)
+    ;
+  segments_ = new segment[count];
+  mask_ = count - 1;
+  for (size_t i = 0; i < count; ++i)
+    segments_[i].table = table_type(prime_nums[0], hash, key_equal, alloc);
+}
+template <class K, class T, class H, class Q, class A>
+concurrent_hash_map<K, T, H, Q, A>::~concurrent_hash_map() {
+  delete[] segments_;
+}
+
+//================================= capacity =================================//
+template <class K, class T, class H, class Q, class A>
+bool concurrent_hash_map<K, T, H, Q, A>::empty() const {
+  return size() == 0;
+}
+template <class K, class T, class H, class Q, class A>
+size_t concurrent_hash_map<K, T, H, Q, A>::size() const {
+  size_t res = 0;
+  for (size_t i = 0; i <= mask_; ++i) {
+    read_guard guard(segments_[i]);
+    res += segments_[i].table.size();
+  }
+  return res;
+}
+
+//================================= modifiers ================================//
+template <class K, class T, class H, class Q, class A>
+void concurrent_hash_map<K, T, H, Q, A>::clear() {
+  for (size_t i = 0; i <= mask_; ++i) {
+    write_guard guard(segments_[i].lock);
+    segments_[i].table.clear();
+  }
+}
+template <class K, class T, class H, class Q, class A>
+bool concurrent_hash_map<K, T, H, Q, A>::insert(const K& key, const T& val) {
+  segment& seg = segment_of(key);
+  write_guard guard(seg.lock);
+  return seg.table.emplace_unique(key, val).second;
+}
+template <class K, class T, class H, class Q, class A>
+bool concurrent_hash_map<K, T, H, Q, A>::insert_or_assign(const K& key,
+                                                          const T& val) {
+  segment& seg = segment_of(key);
+  write_guard guard(seg.lock);
+  auto it = seg.table.find(key);
+  if (it != seg.table.end()) {
+    it->second = val;
+    return false;
+  }
+  seg.table.emplace_unique(key, val);
+  return true;
+}
+template <class K, class T, class H, class Q, class A>
+size_t concurrent_hash_map<K, T, H, Q, A>::erase(const K& key) {
+  segment& seg = segment_of(key);
+  write_guard guard(seg.lock);
+  return seg.table.erase_unique(key);
+}
+
+//================================== lookup ==================================//
+template <class K, class T, class H, class Q, class A>
+bool concurrent_hash_map<K, T, H, Q, A>::find(const K& key, T& val) const {
+  return cvisit(key, [&val](const value_type& v) { val = v.second; });
+}
+template <class K, class T, class H, class Q, class A>
+size_t concurrent_hash_map<K, T, H, Q, A>::count(const K& key) const {
+  const segment& seg = segment_of(key);
+  read_guard guard(seg);
+  return seg.table.count_unique(key);
+}
+template <class K, class T, class H, class Q, class A>
+template <class F>
+bool concurrent_hash_map<K, T, H, Q, A>::visit(const K& key, F fn) {
+  segment& seg = segment_of(key);
+  write_guard guard(seg.lock);
+  auto it = seg.table.find(key);
+  if (it == seg.table.end())
+    return false;
+  fn(*it);
+  return true;
+}
+template <class K, class T, class H, class Q, class A>
+template <class F>
+bool concurrent_hash_map<K, T, H, Q, A>::cvisit(const K& key, F fn) const {
+  const segment& seg = segment_of(key);
+  read_guard guard(seg);
+  auto it = seg.table.find(key);
+  if (it == seg.table.end())
+    return false;
+  fn(*it);
+  return true;
+}
+template <class K, class T, class H, class Q, class A>
+template <class F>
+void concurrent_hash_map<K, T, H, Q, A>::cvisit_all(F fn) const {
+  for (size_t i = 0; i <= mask_; ++i) {
+    const segment& seg = segments_[i];
+    read_guard guard(seg);
+    for (auto it = seg.table.begin(); it != seg.table.end(); ++it)
+      fn(*it);
+  }
+}
+
+//=============================== hash policy ================================//
+template <class K, class T, class H, class Q, class A>
+size_t concurrent_hash_map<K, T, H, Q, A>::segment_count() const {
+  return mask_ + 1;
+}
+template <class K, class T, class H, class Q, class A>
+void concurrent_hash_map<K, T, H, Q, A>::reserve(size_t count) {
+  // the hash spreads keys evenly, give every segment its share
+  for (size_t i = 0; i <= mask_; ++i) {
+    write_guard guard(segments_[i].lock);
+    segments_[i].table.reserve(count / (mask_ + 1) + 1);
+  }
+}
+
+//================================= observers ================================//
+template <class K, class T, class H, class Q, class A>
+H concurrent_hash_map<K, T, H, Q, A>::hash_function() const {
+  return hash_;
+}
+template <class K, class T, class H, class Q, class A>
+Q concurrent_hash_map<K, T, H, Q, A>::key_eq() const {
+  return segments_[0].table.key_eq();
+}
+
+//================================= private ==================================//
+template <class K, class T, class H, class Q, class A>
+typename concurrent_hash_map<K, T, H, Q, A>::segment&
+concurrent_hash_map<K, T, H, Q, A>::segment_of(const K& key) const {
+  // the tables reduce the low bits, segments take the high ones of the mixed
+  // hash so that both stay spread out
+  uint64_t h = uint64_t(hash_(key)) * 0x9E3779B97F4A7C15ull;
+  return segments_[(h >> 32) & mask_];
+}
+}  // namespace mrsuyi
@@ -0,0 +1,98 @@
+#include <thread>
+#include <vector>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "concurrent_hash_map.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(ConcurrentHashMapTest, Basic) {
+  concurrent_hash_map<int, int> m(5);
+  EXPECT_EQ(8, m.segment_count());
+  assert(m.empty());
+
+  assert(m.insert(1, 10));
+  assert(!m.insert(1, 11));
+  assert(!m.insert_or_assign(1, 12));
+  assert(m.insert_or_assign(2, 20));
+  EXPECT_EQ(2, m.size());
+
+  int val = 0;
+  assert(m.find(1, val));
+  EXPECT_EQ(12, val);
+  assert(!m.find(3, val));
+  EXPECT_EQ(1, m.count(2));
+  EXPECT_EQ(0, m.count(3));
+
+  assert(m.visit(2, [](pair<const int, int>& p) { p.second += 1; }));
+  assert(!m.visit(3, [](pair<const int, int>& p) { p.second += 1; }));
+  int seen = 0;
+  assert(m.cvisit(2, [&](const pair<const int, int>& p) { seen = p.second; }));
+  EXPECT_EQ(21, seen);
+
+  int sum = 0;
+  m.cvisit_all([&](const pair<const int, int>& p) { sum += p.second; });
+  EXPECT_EQ(33, sum);
+
+  EXPECT_EQ(1, m.erase(1));
+  EXPECT_EQ(0, m.erase(1));
+  m.clear();
+  assert(m.empty());
+}
+
+TEST(ConcurrentHashMapTest, Threads) {
+  concurrent_hash_map<int, int> m;
+  const int threads = 8, per_thread = 2000, counters = 16;
+  for (int c = 0; c < counters; ++c)
+    m.insert(-1 - c, 0);
+
+  std::vector<std::thread> pool;
+  for (int t = 0; t < threads; ++t) {
+    pool.emplace_back([&m, t] {
+      for (int i = 0; i < per_thread; ++i) {
+        int key = t * per_thread + i;
+        m.insert(key, key);
+        int val = -1;
+        EXPECT_TRUE(m.find(key, val));
+        EXPECT_EQ(key, val);
+        // shared counters are only ever touched under their segment lock
+        m.visit(-1 - i % counters,
+                [](pair<const int, int>& p) { ++p.second; });
+        if (i % 2)
+          m.erase(key);
+      }
+    });
+  }
+  for (auto& th : pool)
+    th.join();
+
+  EXPECT_EQ(threads * per_thread / 2 + counters, m.size());
+  int total = 0;
+  m.cvisit_all([&](const pair<const int, int>& p) {
+    if (p.first < 0)
+      total += p.second;
+  });
+  EXPECT_EQ(threads * per_thread, total);
+}
+
+TEST(ConcurrentHashMapTest, Readers) {
+  // readers share the lock of the one segment, and with
+  // MRSUYI_HASH_TABLE_STATS the lookup counters of its table
+  concurrent_hash_map<int, int> m(1);
+  for (int i = 0; i < 100; ++i)
+    m.insert(i, i);
+  std::vector<std::thread> pool;
+  for (int t = 0; t < 4; ++t) {
+    pool.emplace_back([&m] {
+      for (int i = 0; i < 10000; ++i) {
+        int val = -1;
+        EXPECT_EQ(i % 200 < 100, m.find(i % 200, val));
+        EXPECT_EQ(i % 2, m.count(i % 2 ? 1 : -1));
+      }
+    });
+  }
+  for (auto& th : pool)
+    th.join();
+}
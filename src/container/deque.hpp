@@ -0,0 +1,643 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "algorithm.hpp"
+#include "iterator.hpp"
+#include "memory.hpp"
+#include "utility.hpp"
+
+namespace mrsuyi {
+// elements per block of a deque, the largest power of two(at least 16) whose
+// block fits in 4K, so that indexing is a shift & a mask
+constexpr size_t __deque_block_size(size_t size, size_t n = 16) {
+  return n * 2 * size <= 4096 ? __deque_block_size(size, n * 2) : n;
+}
+
+// the [idx]-th slot of the blocks in [map], [E] is const for const_iterator
+template <class E, size_t B>
+class __deque_iterator {
+  template <class, size_t>
+  friend class __deque_iterator;
+
+  using T = typename std::remove_const<E>::type;
+
+ public:
+  using value_type = T;
+  using difference_type = ptrdiff_t;
+  using reference = E&;
+  using pointer = E*;
+  using iterator_category = mrsuyi::random_access_iterator_tag;
+
+  __deque_iterator() : map_(nullptr), idx_(0) {}
+  __deque_iterator(T* const* map, size_t idx) : map_(map), idx_(idx) {}
+  operator __deque_iterator<const T, B>() const {
+    return __deque_iterator<const T, B>(map_, idx_);
+  }
+
+  E& operator*() const { return map_[idx_ / B][idx_ % B]; }
+  E* operator->() const { return &**this; }
+  E& operator[](difference_type n) const { return *(*this + n); }
+
+  __deque_iterator& operator++() {
+    ++idx_;
+    return *this;
+  }
+  __deque_iterator operator++(int) {
+    auto res = *this;
+    ++*this;
+    return res;
+  }
+  __deque_iterator& operator--() {
+    --idx_;
+    return *this;
+  }
+  __deque_iterator operator--(int) {
+    auto res = *this;
+    --*this;
+    return res;
+  }
+  __deque_iterator& operator+=(difference_type n) {
+    idx_ += n;
+    return *this;
+  }
+  __deque_iterator& operator-=(difference_type n) {
+    idx_ -= n;
+    return *this;
+  }
+  __deque_iterator operator+(difference_type n) const {
+    return __deque_iterator(map_, idx_ + n);
+  }
+  __deque_iterator operator-(difference_type n) const {
+    return __deque_iterator(map_, idx_ - n);
+  }
+  difference_type operator-(const __deque_iterator& it) const {
+    return difference_type(idx_ - it.idx_);
+  }
+
+  bool operator==(const __deque_iterator& it) const { return idx_ == it.idx_; }
+  bool operator!=(const __deque_iterator& it) const { return idx_ != it.idx_; }
+  bool operator<(const __deque_iterator& it) const { return idx_ < it.idx_; }
+  bool operator>(const __deque_iterator& it) const { return idx_ > it.idx_; }
+  bool operator<=(const __deque_iterator& it) const { return idx_ <= it.idx_; }
+  bool operator>=(const __deque_iterator& it) const { return idx_ >= it.idx_; }
+
+ protected:
+  T* const* map_;
+  size_t idx_;
+};
+
+// double-ended queue over fixed-size blocks, found through a map of block
+// pointers. pushing at either end never moves an element, so references stay
+// valid, and a block emptied by a pop stays in its slot of the map, to be
+// filled again once the map is recentred. see shrink_to_fit
+template <class T, class Alloc = allocator<T>>
+class deque {
+  // typedefs
+ public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using reference = T&;
+  using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using difference_type = ptrdiff_t;
+  using size_type = size_t;
+
+  static const size_t block_size = __deque_block_size(sizeof(T));
+
+  // iterators
+  using iterator = __deque_iterator<T, block_size>;
+  using const_iterator = __deque_iterator<const T, block_size>;
+  using reverse_iterator = mrsuyi::reverse_iterator<iterator>;
+  using const_reverse_iterator = mrsuyi::reverse_iterator<const_iterator>;
+
+ public:
+  // ctor & dtor
+  // default
+  deque();
+  explicit deque(const Alloc& alloc);
+  // fill
+  explicit deque(size_t n, const Alloc& alloc = Alloc());
+  deque(size_t n, const T& val, const Alloc& alloc = Alloc());
+  // range
+  template <class InputIterator>
+  deque(
+      InputIterator first,
+      InputIterator last,
+      const Alloc& alloc = Alloc(),
+      typename std::enable_if<!std::is_integral<InputIterator>::value>::type* =
+          0);
+  // copy
+  deque(const deque& x);
+  deque(const deque& x, const Alloc& alloc);
+  // move
+  deque(deque&& x);
+  // list
+  deque(std::initializer_list<T> il, const Alloc& alloc = Alloc());
+  // des
+  ~deque() noexcept;
+
+  // assignment
+  deque& operator=(const deque& x);
+  deque& operator=(deque&& x);
+  deque& operator=(std::initializer_list<T> il);
+
+  template <class InputIterator>
+  void assign(
+      InputIterator first,
+      InputIterator last,
+      typename std::enable_if<!std::is_integral<InputIterator>::value>::type* =
+          0);
+  void assign(size_t n, const T& val);
+  void assign(std::initializer_list<T> il);
+
+  Alloc get_allocator() const noexcept;
+
+  // element access
+  T& at(size_t n);
+  const T& at(size_t n) const;
+  T& operator[](size_t n);
+  const T& operator[](size_t n) const;
+  T& front();
+  const T& front() const;
+  T& back();
+  const T& back() const;
+
+  // iterators
+  iterator begin() noexcept;
+  iterator end() noexcept;
+  const_iterator begin() const noexcept;
+  const_iterator end() const noexcept;
+  const_iterator cbegin() const noexcept;
+  const_iterator cend() const noexcept;
+  reverse_iterator rbegin() noexcept;
+  reverse_iterator rend() noexcept;
+  const_reverse_iterator rbegin() const noexcept;
+  const_reverse_iterator rend() const noexcept;
+  const_reverse_iterator crbegin() const noexcept;
+  const_reverse_iterator crend() const noexcept;
+
+  // capacity
+  bool empty() const noexcept;
+  size_t size() const noexcept;
+  size_t max_size() const;
+  // free the blocks holding no element
+  void shrink_to_fit();
+
+  // modifiers
+  // the blocks are kept
+  void clear();
+
+  void push_back(const T& val);
+  void push_back(T&& val);
+  template <class... Args>
+  void emplace_back(Args&&... args);
+  void push_front(const T& val);
+  void push_front(T&& val);
+  template <class... Args>
+  void emplace_front(Args&&... args);
+  void pop_back();
+  void pop_front();
+
+  void resize(size_t size, T val = T());
+
+  void swap(deque& x);
+
+ protected:
+  using map_allocator = typename Alloc::template other<T*>;
+
+  // the [idx]-th slot of the blocks, counted from the start of the map
+  T& slot(size_t idx) const;
+  // have a block at map_[b], unless one was left there
+  void fill_block(size_t b);
+  // make room for one more element before the front or after the back
+  // when that crosses into another block, which may need the map remapped.
+  // within a block there is nothing to do, as [start_] only ever points
+  // inside a block that is there
+  void grow_front();
+  void grow_back();
+  // move the blocks in use so that at least [front] slots of the map precede
+  // them and [back] follow them, the map doubles if it is less than twice as
+  // big as needed
+  void remap(size_t front, size_t back);
+  // destroy the elements and free every block & the map
+  void release();
+
+ protected:
+  T** map_ = nullptr;
+  size_t map_size_ = 0;
+  // indices of the front element & past the back one, counted from the start
+  // of the map. each end moves alone, a size would tie pops to both
+  size_t start_ = 0;
+  size_t end_ = 0;
+  Alloc alloc_;
+};
+
+template <class T, class Alloc>
+const size_t deque<T, Alloc>::block_size;
+
+//================================ protected =================================//
+template <class T, class Alloc>
+T& deque<T, Alloc>::slot(size_t idx) const {
+  return map_[idx / block_size][idx % block_size];
+}
+template <class T, class Alloc>
+void deque<T, Alloc>::fill_block(size_t b) {
+  if (!map_[b])
+    map_[b] = alloc_.allocate(block_size);
+}
+template <class T, class Alloc>
+void deque<T, Alloc>::grow_front() {
+  if (start_ == 0)
+    remap(1, 0);
+  fill_block(start_ / block_size - 1);
+}
+template <class T, class Alloc>
+void deque<T, Alloc>::grow_back() {
+  if ((end_) / block_size == map_size_)
+    remap(0, 1);
+  fill_block((end_) / block_size);
+}
+template <class T, class Alloc>
+void deque<T, Alloc>::remap(size_t front, size_t back) {
+  size_t first = start_ / block_size;
+  size_t used = (end_ + block_size - 1) / block_size - first;
+  size_t need = used + front + back;
+  size_t new_size = map_size_;
+  if (new_size < need * 2)
+    new_size = max(size_t(8), max(map_size_ * 2, need * 2));
+  size_t new_first = (new_size - used) / 2;
+
+  if (new_size == map_size_) {
+    // recentre in place. swapping in the direction of the move keeps every
+    // pointer, and the spares passed over end up on the side that is growing
+    if (new_first < first)
+      for (size_t i = 0; i < used; ++i)
+        mrsuyi::swap(map_[new_first + i], map_[first + i]);
+    else
+      for (size_t i = used; i-- > 0;)
+        mrsuyi::swap(map_[new_first + i], map_[first + i]);
+  } else {
+    map_allocator map_alloc(alloc_);
+    T** new_map = map_alloc.allocate(new_size);
+    for (size_t i = 0; i < new_size; ++i)
+      new_map[i] = nullptr;
+    for (size_t i = 0; i < used; ++i)
+      new_map[new_first + i] = map_[first + i];
+    // spare blocks go next to the end that is growing, where they are needed
+    // first, and to the other end once that is full
+    size_t before = new_first, after = new_first + used;
+    for (size_t i = 0; i < map_size_; ++i) {
+      if (!map_[i] || (i >= first && i < first + used))
+        continue;
+      if (back ? after < new_size : before == 0)
+        new_map[after++] = map_[i];
+      else
+        new_map[--before] = map_[i];
+    }
+    if (map_)
+      map_alloc.deallocate(map_, map_size_);
+    map_ = new_map;
+    map_size_ = new_size;
+  }
+  size_t size = end_ - start_;
+  start_ = new_first * block_size + start_ % block_size;
+  end_ = start_ + size;
+}
+template <class T, class Alloc>
+void deque<T, Alloc>::release() {
+  destroy(begin(), end());
+  for (size_t i = 0; i < map_size_; ++i)
+    if (map_[i])
+      alloc_.deallocate(map_[i], block_size);
+  if (map_)
+    map_allocator(alloc_).deallocate(map_, map_size_);
+}
+
+//================================== basic ===================================//
+// default
+template <class T, class Alloc>
+deque<T, Alloc>::deque() : deque(Alloc()) {}
+template <class T, class Alloc>
+deque<T, Alloc>::deque(const Alloc& alloc) : alloc_(alloc) {}
+// fill
+template <class T, class Alloc>
+deque<T, Alloc>::deque(size_t n, const Alloc& alloc) : deque(n, T(), alloc) {}
+template <class T, class Alloc>
+deque<T, Alloc>::deque(size_t n, const T& val, const Alloc& alloc)
+    : alloc_(alloc) {
+  assign(n, val);
+}
+// range
+template <class T, class Alloc>
+template <class InputIterator>
+deque<T, Alloc>::deque(
+    InputIterator first,
+    InputIterator last,
+    const Alloc& alloc,
+    typename std::enable_if<!std::is_integral<InputIterator>::value>::type*)
+    : alloc_(alloc) {
+  for (; first != last; ++first)
+    emplace_back(*first);
+}
+// copy
+template <class T, class Alloc>
+deque<T, Alloc>::deque(const deque& x) : deque(x, Alloc()) {}
+template <class T, class Alloc>
+deque<T, Alloc>::deque(const deque& x, const Alloc& alloc)
+    : deque(x.begin(), x.end(), alloc) {}
+// move
+template <class T, class Alloc>
+deque<T, Alloc>::deque(deque&& x)
+    : map_(x.map_),
+      map_size_(x.map_size_),
+      start_(x.start_),
+      end_(x.end_),
+      alloc_(x.alloc_) {
+  x.map_ = nullptr;
+  x.map_size_ = x.start_ = x.end_ = 0;
+}
+// list
+template <class T, class Alloc>
+deque<T, Alloc>::deque(std::initializer_list<T> il, const Alloc& alloc)
+    : deque(il.begin(), il.end(), alloc) {}
+// dtor
+template <class T, class Alloc>
+deque<T, Alloc>::~deque() noexcept {
+  release();
+}
+// =
+template <class T, class Alloc>
+deque<T, Alloc>& deque<T, Alloc>::operator=(const deque& x) {
+  deque(x).swap(*this);
+  return *this;
+}
+template <class T, class Alloc>
+deque<T, Alloc>& deque<T, Alloc>::operator=(deque&& x) {
+  deque(move(x)).swap(*this);
+  return *this;
+}
+template <class T, class Alloc>
+deque<T, Alloc>& deque<T, Alloc>::operator=(std::initializer_list<T> il) {
+  assign(il);
+  return *this;
+}
+// assign
+template <class T, class Alloc>
+template <class InputIterator>
+void deque<T, Alloc>::assign(
+    InputIterator first,
+    InputIterator last,
+    typename std::enable_if<!std::is_integral<InputIterator>::value>::type*) {
+  clear();
+  for (; first != last; ++first)
+    emplace_back(*first);
+}
+template <class T, class Alloc>
+void deque<T, Alloc>::assign(size_t n, const T& val) {
+  clear();
+  for (; n; --n)
+    emplace_back(val);
+}
+template <class T, class Alloc>
+void deque<T, Alloc>::assign(std::initializer_list<T> il) {
+  assign(il.begin(), il.end());
+}
+// get_allocator
+template <class T, class Alloc>
+Alloc deque<T, Alloc>::get_allocator() const noexcept {
+  return alloc_;
+}
+
+//============================= element access ===============================//
+template <class T, class Alloc>
+T& deque<T, Alloc>::at(size_t n) {
+  if (n >= size())
+    throw std::out_of_range("deque");
+  return (*this)[n];
+}
+template <class T, class Alloc>
+const T& deque<T, Alloc>::at(size_t n) const {
+  if (n >= size())
+    throw std::out_of_range("deque");
+  return (*this)[n];
+}
+template <class T, class Alloc>
+T& deque<T, Alloc>::operator[](size_t n) {
+  return slot(start_ + n);
+}
+template <class T, class Alloc>
+const T& deque<T, Alloc>::operator[](size_t n) const {
+  return slot(start_ + n);
+}
+template <class T, class Alloc>
+T& deque<T, Alloc>::front() {
+  return slot(start_);
+}
+template <class T, class Alloc>
+const T& deque<T, Alloc>::front() const {
+  return slot(start_);
+}
+template <class T, class Alloc>
+T& deque<T, Alloc>::back() {
+  return slot(end_ - 1);
+}
+template <class T, class Alloc>
+const T& deque<T, Alloc>::back() const {
+  return slot(end_ - 1);
+}
+
+//================================ iterators =================================//
+template <class T, class Alloc>
+typename deque<T, Alloc>::iterator deque<T, Alloc>::begin() noexcept {
+  return iterator(map_, start_);
+}
+template <class T, class Alloc>
+typename deque<T, Alloc>::iterator deque<T, Alloc>::end() noexcept {
+  return iterator(map_, end_);
+}
+template <class T, class Alloc>
+typename deque<T, Alloc>::const_iterator deque<T, Alloc>::begin() const
+    noexcept {
+  return const_iterator(map_, start_);
+}
+template <class T, class Alloc>
+typename deque<T, Alloc>::const_iterator deque<T, Alloc>::end() const
+    noexcept {
+  return const_iterator(map_, end_);
+}
+template <class T, class Alloc>
+typename deque<T, Alloc>::const_iterator deque<T, Alloc>::cbegin() const
+    noexcept {
+  return begin();
+}
+template <class T, class Alloc>
+typename deque<T, Alloc>::const_iterator deque<T, Alloc>::cend() const
+    noexcept {
+  return end();
+}
+template <class T, class Alloc>
+typename deque<T, Alloc>::reverse_iterator deque<T, Alloc>::rbegin() noexcept {
+  return reverse_iterator(end());
+}
+template <class T, class Alloc>
+typename deque<T, Alloc>::reverse_iterator deque<T, Alloc>::rend() noexcept {
+  return reverse_iterator(begin());
+}
+template <class T, class Alloc>
+typename deque<T, Alloc>::const_reverse_iterator deque<T, Alloc>::rbegin()
+    const noexcept {
+  return const_reverse_iterator(end());
+}
+template <class T, class Alloc>
+typename deque<T, Alloc>::const_reverse_iterator deque<T, Alloc>::rend() const
+    noexcept {
+  return const_reverse_iterator(begin());
+}
+template <class T, class Alloc>
+typename deque<T, Alloc>::const_reverse_iterator deque<T, Alloc>::crbegin()
+    const noexcept {
+  return rbegin();
+}
+template <class T, class Alloc>
+typename deque<T, Alloc>::const_reverse_iterator deque<T, Alloc>::crend()
+    const noexcept {
+  return rend();
+}
+
+//================================ capacity ==================================//
+template <class T, class Alloc>
+bool deque<T, Alloc>::empty() const noexcept {
+  return start_ == end_;
+}
+template <class T, class Alloc>
+size_t deque<T, Alloc>::size() const noexcept {
+  return end_ - start_;
+}
+template <class T, class Alloc>
+size_t deque<T, Alloc>::max_size() const {
+  return std::numeric_limits<size_t>::max();
+}
+template <class T, class Alloc>
+void deque<T, Alloc>::shrink_to_fit() {
+  // an empty deque keeps no block, not even the one [start_] points inside
+  if (empty())
+    start_ = end_ = start_ - start_ % block_size;
+  size_t first = start_ / block_size;
+  size_t last = empty() ? first : (end_ - 1) / block_size;
+  for (size_t i = 0; i < map_size_; ++i) {
+    if (map_[i] && (i < first || i > last || empty())) {
+      alloc_.deallocate(map_[i], block_size);
+      map_[i] = nullptr;
+    }
+  }
+}
+
+//================================ modifiers =================================//
+// clear
+template <class T, class Alloc>
+void deque<T, Alloc>::clear() {
+  destroy(begin(), end());
+  end_ = start_;
+}
+// push_back
+template <class T, class Alloc>
+void deque<T, Alloc>::push_back(const T& val) {
+  emplace_back(val);
+}
+template <class T, class Alloc>
+void deque<T, Alloc>::push_back(T&& val) {
+  emplace_back(move(val));
+}
+// emplace_back
+template <class T, class Alloc>
+template <class... Args>
+void deque<T, Alloc>::emplace_back(Args&&... args) {
+  if ((end_) % block_size == 0)
+    grow_back();
+  construct(&slot(end_), forward<Args>(args)...);
+  ++end_;
+}
+// push_front
+template <class T, class Alloc>
+void deque<T, Alloc>::push_front(const T& val) {
+  emplace_front(val);
+}
+template <class T, class Alloc>
+void deque<T, Alloc>::push_front(T&& val) {
+  emplace_front(move(val));
+}
+// emplace_front
+template <class T, class Alloc>
+template <class... Args>
+void deque<T, Alloc>::emplace_front(Args&&... args) {
+  if (start_ % block_size == 0)
+    grow_front();
+  construct(&slot(start_ - 1), forward<Args>(args)...);
+  --start_;
+}
+// pop
+template <class T, class Alloc>
+void deque<T, Alloc>::pop_back() {
+  --end_;
+  destroy_at(&slot(end_));
+}
+template <class T, class Alloc>
+void deque<T, Alloc>::pop_front() {
+  destroy_at(&slot(start_));
+  ++start_;
+}
+// resize
+template <class T, class Alloc>
+void deque<T, Alloc>::resize(size_t new_size, T val) {
+  while (size() > new_size)
+    pop_back();
+  while (size() < new_size)
+    emplace_back(val);
+}
+// swap
+template <class T, class Alloc>
+void deque<T, Alloc>::swap(deque& x) {
+  mrsuyi::swap(map_, x.map_);
+  mrsuyi::swap(map_size_, x.map_size_);
+  mrsuyi::swap(start_, x.start_);
+  mrsuyi::swap(end_, x.end_);
+  mrsuyi::swap(alloc_, x.alloc_);
+}
+
+//=========================== non-member functions ===========================//
+template <class T, class Alloc>
+void swap(deque<T, Alloc>& x, deque<T, Alloc>& y) {
+  x.swap(y);
+}
+template <class T, class Alloc>
+bool operator==(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
+  return lhs.size() == rhs.size() && equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+template <class T, class Alloc>
+bool operator!=(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
+  return !(lhs == rhs);
+}
+template <class T, class Alloc>
+bool operator<(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
+  return lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),
+                                 rhs.end());
+}
+template <class T, class Alloc>
+bool operator<=(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
+  return !(rhs < lhs);
+}
+template <class T, class Alloc>
+bool operator>(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
+  return rhs < lhs;
+}
+template <class T, class Alloc>
+bool operator>=(const deque<T, Alloc>& lhs, const deque<T, Alloc>& rhs) {
+  return !(lhs < rhs);
+}
+}  // namespace mrsuyi
@@ -0,0 +1,131 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "deque.hpp"
+#include "memory/unique_ptr.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(DequeTest, Ctor) {
+  deque<int> empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(empty.begin(), empty.end());
+  deque<int> fill(3, 7);
+  EXPECT_THAT(fill, ElementsAre(7, 7, 7));
+  deque<int> il = {1, 2, 3};
+  EXPECT_THAT(il, ElementsAre(1, 2, 3));
+  deque<int> copy(il);
+  EXPECT_THAT(copy, ElementsAre(1, 2, 3));
+  deque<int> moved(mrsuyi::move(copy));
+  EXPECT_THAT(moved, ElementsAre(1, 2, 3));
+  EXPECT_TRUE(copy.empty());
+  copy.push_back(4);
+  EXPECT_THAT(copy, ElementsAre(4));
+  copy = il;
+  EXPECT_THAT(copy, ElementsAre(1, 2, 3));
+  assert(copy == il);
+  copy = {5};
+  assert(copy != il);
+  assert(il < copy);
+}
+
+TEST(DequeTest, PushPop) {
+  // across many blocks at both ends
+  deque<int> dq;
+  const int n = 10000;
+  for (int i = 0; i < n; ++i) {
+    dq.push_back(i);
+    dq.emplace_front(-i - 1);
+  }
+  EXPECT_EQ(2 * n, dq.size());
+  EXPECT_EQ(-n, dq.front());
+  EXPECT_EQ(n - 1, dq.back());
+  for (int i = 0; i < 2 * n; ++i)
+    EXPECT_EQ(i - n, dq[i]);
+  EXPECT_EQ(dq.size(), dq.end() - dq.begin());
+  EXPECT_EQ(n - 1, *dq.rbegin());
+  EXPECT_EQ(0, *(dq.cbegin() + n));
+  EXPECT_THROW(dq.at(2 * n), std::out_of_range);
+
+  for (int i = 0; i < n; ++i) {
+    dq.pop_front();
+    dq.pop_back();
+  }
+  EXPECT_TRUE(dq.empty());
+
+  dq.resize(5, 1);
+  dq.resize(3);
+  EXPECT_THAT(dq, ElementsAre(1, 1, 1));
+  dq.clear();
+  EXPECT_TRUE(dq.empty());
+
+  deque<unique_ptr<int>> ptrs;
+  ptrs.push_back(unique_ptr<int>(new int(1)));
+  ptrs.emplace_front(new int(0));
+  EXPECT_EQ(1, *ptrs.back());
+  EXPECT_EQ(0, *ptrs.front());
+}
+
+TEST(DequeTest, StableReferences) {
+  deque<int> dq = {0};
+  int* first = &dq.front();
+  for (int i = 1; i < 100000; ++i) {
+    dq.push_back(i);
+    dq.push_front(-i);
+  }
+  EXPECT_EQ(&dq[99999], first);
+  EXPECT_EQ(0, *first);
+}
+
+template <class T>
+struct block_counting_allocator : allocator<T> {
+  template <class U>
+  using other = block_counting_allocator<U>;
+
+  block_counting_allocator() {}
+  template <class U>
+  block_counting_allocator(const block_counting_allocator<U>&) {}
+
+  T* allocate(size_t n) {
+    ++allocations;
+    ++live;
+    return allocator<T>::allocate(n);
+  }
+  void deallocate(T* p, size_t n) {
+    --live;
+    allocator<T>::deallocate(p, n);
+  }
+
+  static int allocations, live;
+};
+template <class T>
+int block_counting_allocator<T>::allocations = 0;
+template <class T>
+int block_counting_allocator<T>::live = 0;
+
+TEST(DequeTest, BlockReuse) {
+  using counter = block_counting_allocator<int>;
+  {
+    // a FIFO sliding through far more elements than it ever holds
+    deque<int, counter> fifo;
+    for (int i = 0; i < 100; ++i)
+      fifo.push_back(i);
+    for (int i = 100; i < 1000000; ++i) {
+      fifo.push_back(i);
+      EXPECT_EQ(i - 100, fifo.front());
+      fifo.pop_front();
+    }
+    EXPECT_EQ(100, fifo.size());
+    EXPECT_LE(counter::allocations, 16);
+
+    fifo.clear();
+    fifo.shrink_to_fit();
+    EXPECT_EQ(0, counter::live);
+    fifo.push_front(1);
+    fifo.push_back(2);
+    EXPECT_EQ(2, counter::live);
+    EXPECT_THAT(fifo, ElementsAre(1, 2));
+  }
+  EXPECT_EQ(0, counter::live);
+}
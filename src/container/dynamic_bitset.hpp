@@ -0,0 +1,690 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "iterator.hpp"
+#include "memory.hpp"
+#include "vector.hpp"
+
+namespace mrsuyi {
+//================================ word kernels ==============================//
+// loops over whole words shared by every dynamic_bitset, 4 words a step with
+// AVX2 and one otherwise
+struct __bit_and {
+  uint64_t operator()(uint64_t a, uint64_t b) const { return a & b; }
+#ifdef __AVX2__
+  __m256i operator()(__m256i a, __m256i b) const {
+    return _mm256_and_si256(a, b);
+  }
+#endif
+};
+struct __bit_or {
+  uint64_t operator()(uint64_t a, uint64_t b) const { return a | b; }
+#ifdef __AVX2__
+  __m256i operator()(__m256i a, __m256i b) const {
+    return _mm256_or_si256(a, b);
+  }
+#endif
+};
+struct __bit_xor {
+  uint64_t operator()(uint64_t a, uint64_t b) const { return a ^ b; }
+#ifdef __AVX2__
+  __m256i operator()(__m256i a, __m256i b) const {
+    return _mm256_xor_si256(a, b);
+  }
+#endif
+};
+struct __bit_and_not {
+  uint64_t operator()(uint64_t a, uint64_t b) const { return a & ~b; }
+#ifdef __AVX2__
+  __m256i operator()(__m256i a, __m256i b) const {
+    return _mm256_andnot_si256(b, a);
+  }
+#endif
+};
+
+// dst[i] = op(dst[i], src[i]) for [n] words
+template <class Op>
+void __bit_apply(uint64_t* dst, const uint64_t* src, size_t n, Op op) {
+  size_t i = 0;
+#ifdef __AVX2__
+  for (; i + 4 <= n; i += 4) {
+    auto d = reinterpret_cast<__m256i*>(dst + i);
+    auto s = reinterpret_cast<const __m256i*>(src + i);
+    _mm256_storeu_si256(d,
+                        op(_mm256_loadu_si256(d), _mm256_loadu_si256(s)));
+  }
+#endif
+  for (; i < n; ++i)
+    dst[i] = op(dst[i], src[i]);
+}
+
+#ifdef __AVX2__
+// bits set in 4 words, as 4 counts of up to 64 each. a nibble lookup through
+// vpshufb(Mula), which needs no popcnt and does 32 bytes per step
+inline __m256i __bit_count4(__m256i v) {
+  const __m256i lookup =
+      _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1,
+                       2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0f);
+  __m256i lo = _mm256_and_si256(v, low);
+  __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+  __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                  _mm256_shuffle_epi8(lookup, hi));
+  return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+}
+inline size_t __bit_sum4(__m256i acc) {
+  return _mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) +
+         _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3);
+}
+#endif
+
+// bits set in op(a[i], b[i]) over [n] words, without writing the result
+template <class Op>
+size_t __bit_count(const uint64_t* a, const uint64_t* b, size_t n, Op op) {
+  size_t i = 0, res = 0;
+#ifdef __AVX2__
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 4 <= n; i += 4) {
+    auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    acc = _mm256_add_epi64(acc, __bit_count4(op(x, y)));
+  }
+  res = __bit_sum4(acc);
+#endif
+  for (; i < n; ++i)
+    res += __builtin_popcountll(op(a[i], b[i]));
+  return res;
+}
+inline size_t __bit_count(const uint64_t* a, size_t n) {
+  return __bit_count(a, a, n, __bit_and());
+}
+
+//============================== bit references ==============================//
+// proxy for a single bit
+class __bit_reference {
+ public:
+  __bit_reference(uint64_t* word, uint64_t mask) : word_(word), mask_(mask) {}
+
+  operator bool() const { return *word_ & mask_; }
+  bool operator~() const { return !bool(*this); }
+  __bit_reference& operator=(bool val) {
+    if (val)
+      *word_ |= mask_;
+    else
+      *word_ &= ~mask_;
+    return *this;
+  }
+  __bit_reference& operator=(const __bit_reference& x) {
+    return *this = bool(x);
+  }
+  __bit_reference& flip() {
+    *word_ ^= mask_;
+    return *this;
+  }
+
+ protected:
+  uint64_t* word_;
+  uint64_t mask_;
+};
+
+// position of a bit as word & offset, [Word] is const for const_iterator
+template <class Word, class Ref>
+class __bit_iterator {
+ public:
+  using value_type = bool;
+  using difference_type = ptrdiff_t;
+  using reference = Ref;
+  using pointer = void;
+  using iterator_category = mrsuyi::random_access_iterator_tag;
+
+  __bit_iterator() : word_(nullptr), bit_(0) {}
+  __bit_iterator(Word* word, size_t bit) : word_(word), bit_(bit) {}
+  operator __bit_iterator<const uint64_t, bool>() const {
+    return __bit_iterator<const uint64_t, bool>(word_, bit_);
+  }
+
+  Ref operator*() const { return Ref(word_, uint64_t(1) << bit_); }
+  Ref operator[](difference_type n) const { return *(*this + n); }
+
+  __bit_iterator& operator++() {
+    if (++bit_ == 64) {
+      ++word_;
+      bit_ = 0;
+    }
+    return *this;
+  }
+  __bit_iterator operator++(int) {
+    auto res = *this;
+    ++*this;
+    return res;
+  }
+  __bit_iterator& operator--() {
+    if (bit_-- == 0) {
+      --word_;
+      bit_ = 63;
+    }
+    return *this;
+  }
+  __bit_iterator operator--(int) {
+    auto res = *this;
+    --*this;
+    return res;
+  }
+  __bit_iterator& operator+=(difference_type n) {
+    difference_type pos = difference_type(bit_) + n;
+    // floor division, [pos] may be negative
+    difference_type words = (pos >= 0 ? pos : pos - 63) / 64;
+    word_ += words;
+    bit_ = size_t(pos - words * 64);
+    return *this;
+  }
+  __bit_iterator& operator-=(difference_type n) { return *this += -n; }
+  __bit_iterator operator+(difference_type n) const {
+    auto res = *this;
+    return res += n;
+  }
+  __bit_iterator operator-(difference_type n) const {
+    auto res = *this;
+    return res -= n;
+  }
+  difference_type operator-(const __bit_iterator& it) const {
+    return (word_ - it.word_) * 64 + difference_type(bit_) -
+           difference_type(it.bit_);
+  }
+
+  bool operator==(const __bit_iterator& it) const {
+    return word_ == it.word_ && bit_ == it.bit_;
+  }
+  bool operator!=(const __bit_iterator& it) const { return !(*this == it); }
+  bool operator<(const __bit_iterator& it) const { return *this - it < 0; }
+  bool operator>(const __bit_iterator& it) const { return it < *this; }
+  bool operator<=(const __bit_iterator& it) const { return !(it < *this); }
+  bool operator>=(const __bit_iterator& it) const { return !(*this < it); }
+
+ protected:
+  Word* word_;
+  size_t bit_;
+};
+
+// the const "reference" of a bit is the bool itself
+template <>
+inline bool __bit_iterator<const uint64_t, bool>::operator*() const {
+  return *word_ >> bit_ & 1;
+}
+
+//=============================== dynamic_bitset =============================//
+// bits packed 64 to a word, in place of a vector<bool> that spends a byte on
+// each. bits past size() in the last word are always 0, so that counting and
+// comparing can work on whole words. binary operations require both sides to
+// have the same size
+template <class Alloc = allocator<uint64_t>>
+class dynamic_bitset {
+ public:
+  using value_type = bool;
+  using allocator_type = Alloc;
+  using word_type = uint64_t;
+  using reference = __bit_reference;
+  using const_reference = bool;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  // iterators
+  using iterator = __bit_iterator<uint64_t, __bit_reference>;
+  using const_iterator = __bit_iterator<const uint64_t, bool>;
+
+  static const size_t bits_per_word = 64;
+  // returned by the finds when there is no such bit
+  static const size_t npos = size_t(-1);
+
+ public:
+  // ctor & dtor
+  dynamic_bitset();
+  explicit dynamic_bitset(const Alloc& alloc);
+  explicit dynamic_bitset(size_t n,
+                          bool val = false,
+                          const Alloc& alloc = Alloc());
+  dynamic_bitset(std::initializer_list<bool> il, const Alloc& alloc = Alloc());
+
+  Alloc get_allocator() const noexcept;
+
+  // element access
+  reference operator[](size_t n);
+  bool operator[](size_t n) const;
+  // throws std::out_of_range past size()
+  bool test(size_t n) const;
+  reference front();
+  bool front() const;
+  reference back();
+  bool back() const;
+  // the words, bit i of the bitset is bit i % 64 of word i / 64
+  uint64_t* data() noexcept;
+  const uint64_t* data() const noexcept;
+  size_t word_count() const noexcept;
+
+  // iterators
+  iterator begin() noexcept;
+  iterator end() noexcept;
+  const_iterator begin() const noexcept;
+  const_iterator end() const noexcept;
+  const_iterator cbegin() const noexcept;
+  const_iterator cend() const noexcept;
+
+  // capacity
+  bool empty() const noexcept;
+  size_t size() const noexcept;
+  void reserve(size_t size);
+  size_t capacity() const noexcept;
+  void shrink_to_fit();
+
+  // modifiers
+  void clear();
+  void push_back(bool val);
+  void pop_back();
+  void resize(size_t size, bool val = false);
+  void swap(dynamic_bitset& x);
+
+  // bit operations
+  dynamic_bitset& set();
+  dynamic_bitset& set(size_t n, bool val = true);
+  dynamic_bitset& reset();
+  dynamic_bitset& reset(size_t n);
+  dynamic_bitset& flip();
+  dynamic_bitset& flip(size_t n);
+
+  dynamic_bitset& operator&=(const dynamic_bitset& x);
+  dynamic_bitset& operator|=(const dynamic_bitset& x);
+  dynamic_bitset& operator^=(const dynamic_bitset& x);
+  // clear the bits set in [x]
+  dynamic_bitset& operator-=(const dynamic_bitset& x);
+  dynamic_bitset operator~() const;
+
+  // queries
+  size_t count() const noexcept;
+  // bits set in both, same as (*this & x).count() without the temporary
+  size_t count_and(const dynamic_bitset& x) const noexcept;
+  bool any() const noexcept;
+  bool all() const noexcept;
+  bool none() const noexcept;
+  bool intersects(const dynamic_bitset& x) const noexcept;
+  bool is_subset_of(const dynamic_bitset& x) const noexcept;
+  // index of the first set bit, npos if none
+  size_t find_first() const noexcept;
+  // index of the first set bit after [pos], npos if none
+  size_t find_next(size_t pos) const noexcept;
+
+  const vector<uint64_t, Alloc>& words() const noexcept;
+
+ protected:
+  static size_t words_for(size_t bits);
+  static uint64_t mask_of(size_t n);
+  // first set bit in words from the [w]-th on, the [w]-th one given as [word]
+  size_t find_from(size_t w, uint64_t word) const noexcept;
+  // zero the bits of the last word past size()
+  void trim();
+
+ protected:
+  vector<uint64_t, Alloc> words_;
+  size_t size_;
+};
+
+template <class Alloc>
+const size_t dynamic_bitset<Alloc>::bits_per_word;
+template <class Alloc>
+const size_t dynamic_bitset<Alloc>::npos;
+
+//================================ protected =================================//
+template <class Alloc>
+size_t dynamic_bitset<Alloc>::words_for(size_t bits) {
+  return (bits + bits_per_word - 1) / bits_per_word;
+}
+template <class Alloc>
+uint64_t dynamic_bitset<Alloc>::mask_of(size_t n) {
+  return uint64_t(1) << (n % bits_per_word);
+}
+template <class Alloc>
+size_t dynamic_bitset<Alloc>::find_from(size_t w, uint64_t word) const
+    noexcept {
+  for (;;) {
+    if (word)
+      return w * bits_per_word + __builtin_ctzll(word);
+    if (++w >= words_.size())
+      return npos;
+    word = words_[w];
+  }
+}
+template <class Alloc>
+void dynamic_bitset<Alloc>::trim() {
+  if (size_ % bits_per_word)
+    words_.back() &= mask_of(size_) - 1;
+}
+
+//================================== basic ===================================//
+template <class Alloc>
+dynamic_bitset<Alloc>::dynamic_bitset() : dynamic_bitset(Alloc()) {}
+template <class Alloc>
+dynamic_bitset<Alloc>::dynamic_bitset(const Alloc& alloc)
+    : words_(alloc), size_(0) {}
+template <class Alloc>
+dynamic_bitset<Alloc>::dynamic_bitset(size_t n, bool val, const Alloc& alloc)
+    : words_(words_for(n), val ? ~uint64_t(0) : 0, alloc), size_(n) {
+  trim();
+}
+template <class Alloc>
+dynamic_bitset<Alloc>::dynamic_bitset(std::initializer_list<bool> il,
+                                      const Alloc& alloc)
+    : dynamic_bitset(il.size(), false, alloc) {
+  size_t i = 0;
+  for (bool b : il)
+    set(i++, b);
+}
+
+template <class Alloc>
+Alloc dynamic_bitset<Alloc>::get_allocator() const noexcept {
+  return words_.get_allocator();
+}
+
+//============================= element access ===============================//
+template <class Alloc>
+typename dynamic_bitset<Alloc>::reference dynamic_bitset<Alloc>::operator[](
+    size_t n) {
+  return reference(&words_[n / bits_per_word], mask_of(n));
+}
+template <class Alloc>
+bool dynamic_bitset<Alloc>::operator[](size_t n) const {
+  return words_[n / bits_per_word] & mask_of(n);
+}
+template <class Alloc>
+bool dynamic_bitset<Alloc>::test(size_t n) const {
+  if (n >= size_)
+    throw std::out_of_range("dynamic_bitset");
+  return (*this)[n];
+}
+template <class Alloc>
+typename dynamic_bitset<Alloc>::reference dynamic_bitset<Alloc>::front() {
+  return (*this)[0];
+}
+template <class Alloc>
+bool dynamic_bitset<Alloc>::front() const {
+  return (*this)[0];
+}
+template <class Alloc>
+typename dynamic_bitset<Alloc>::reference dynamic_bitset<Alloc>::back() {
+  return (*this)[size_ - 1];
+}
+template <class Alloc>
+bool dynamic_bitset<Alloc>::back() const {
+  return (*this)[size_ - 1];
+}
+template <class Alloc>
+uint64_t* dynamic_bitset<Alloc>::data() noexcept {
+  return words_.data();
+}
+template <class Alloc>
+const uint64_t* dynamic_bitset<Alloc>::data() const noexcept {
+  return words_.data();
+}
+template <class Alloc>
+size_t dynamic_bitset<Alloc>::word_count() const noexcept {
+  return words_.size();
+}
+
+//================================ iterators =================================//
+template <class Alloc>
+typename dynamic_bitset<Alloc>::iterator
+dynamic_bitset<Alloc>::begin() noexcept {
+  return iterator(words_.data(), 0);
+}
+template <class Alloc>
+typename dynamic_bitset<Alloc>::iterator
+dynamic_bitset<Alloc>::end() noexcept {
+  return begin() + size_;
+}
+template <class Alloc>
+typename dynamic_bitset<Alloc>::const_iterator dynamic_bitset<Alloc>::begin()
+    const noexcept {
+  return const_iterator(words_.data(), 0);
+}
+template <class Alloc>
+typename dynamic_bitset<Alloc>::const_iterator dynamic_bitset<Alloc>::end()
+    const noexcept {
+  return begin() + size_;
+}
+template <class Alloc>
+typename dynamic_bitset<Alloc>::const_iterator dynamic_bitset<Alloc>::cbegin()
+    const noexcept {
+  return begin();
+}
+template <class Alloc>
+typename dynamic_bitset<Alloc>::const_iterator dynamic_bitset<Alloc>::cend()
+    const noexcept {
+  return end();
+}
+
+//================================ capacity ==================================//
+template <class Alloc>
+bool dynamic_bitset<Alloc>::empty() const noexcept {
+  return size_ == 0;
+}
+template <class Alloc>
+size_t dynamic_bitset<Alloc>::size() const noexcept {
+  return size_;
+}
+template <class Alloc>
+void dynamic_bitset<Alloc>::reserve(size_t size) {
+  words_.reserve(words_for(size));
+}
+template <class Alloc>
+size_t dynamic_bitset<Alloc>::capacity() const noexcept {
+  return words_.capacity() * bits_per_word;
+}
+template <class Alloc>
+void dynamic_bitset<Alloc>::shrink_to_fit() {
+  words_.shrink_to_fit();
+}
+
+//================================ modifiers =================================//
+template <class Alloc>
+void dynamic_bitset<Alloc>::clear() {
+  words_.clear();
+  size_ = 0;
+}
+template <class Alloc>
+void dynamic_bitset<Alloc>::push_back(bool val) {
+  if (size_ % bits_per_word == 0)
+    words_.push_back(0);
+  set(size_++, val);
+}
+template <class Alloc>
+void dynamic_bitset<Alloc>::pop_back() {
+  reset(--size_);
+  if (size_ % bits_per_word == 0)
+    words_.pop_back();
+}
+template <class Alloc>
+void dynamic_bitset<Alloc>::resize(size_t size, bool val) {
+  if (val && size > size_ && size_ % bits_per_word)
+    words_.back() |= ~(mask_of(size_) - 1);
+  words_.resize(words_for(size), val ? ~uint64_t(0) : 0);
+  size_ = size;
+  trim();
+}
+template <class Alloc>
+void dynamic_bitset<Alloc>::swap(dynamic_bitset& x) {
+  words_.swap(x.words_);
+  mrsuyi::swap(size_, x.size_);
+}
+
+//============================== bit operations ==============================//
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::set() {
+  for (auto& w : words_)
+    w = ~uint64_t(0);
+  trim();
+  return *this;
+}
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::set(size_t n, bool val) {
+  (*this)[n] = val;
+  return *this;
+}
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::reset() {
+  for (auto& w : words_)
+    w = 0;
+  return *this;
+}
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::reset(size_t n) {
+  return set(n, false);
+}
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::flip() {
+  for (auto& w : words_)
+    w = ~w;
+  trim();
+  return *this;
+}
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::flip(size_t n) {
+  (*this)[n].flip();
+  return *this;
+}
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator&=(
+    const dynamic_bitset& x) {
+  __bit_apply(words_.data(), x.words_.data(), words_.size(), __bit_and());
+  return *this;
+}
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator|=(
+    const dynamic_bitset& x) {
+  __bit_apply(words_.data(), x.words_.data(), words_.size(), __bit_or());
+  return *this;
+}
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator^=(
+    const dynamic_bitset& x) {
+  __bit_apply(words_.data(), x.words_.data(), words_.size(), __bit_xor());
+  return *this;
+}
+template <class Alloc>
+dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator-=(
+    const dynamic_bitset& x) {
+  __bit_apply(words_.data(), x.words_.data(), words_.size(),
+              __bit_and_not());
+  return *this;
+}
+template <class Alloc>
+dynamic_bitset<Alloc> dynamic_bitset<Alloc>::operator~() const {
+  auto res = *this;
+  return res.flip();
+}
+
+//================================== queries =================================//
+template <class Alloc>
+size_t dynamic_bitset<Alloc>::count() const noexcept {
+  return __bit_count(words_.data(), words_.size());
+}
+template <class Alloc>
+size_t dynamic_bitset<Alloc>::count_and(const dynamic_bitset& x) const
+    noexcept {
+  return __bit_count(words_.data(), x.words_.data(), words_.size(),
+                     __bit_and());
+}
+template <class Alloc>
+bool dynamic_bitset<Alloc>::any() const noexcept {
+  return find_first() != npos;
+}
+template <class Alloc>
+bool dynamic_bitset<Alloc>::all() const noexcept {
+  size_t full = size_ / bits_per_word;
+  for (size_t i = 0; i < full; ++i)
+    if (~words_[i])
+      return false;
+  return full == words_.size() || words_.back() == mask_of(size_) - 1;
+}
+template <class Alloc>
+bool dynamic_bitset<Alloc>::none() const noexcept {
+  return !any();
+}
+template <class Alloc>
+bool dynamic_bitset<Alloc>::intersects(const dynamic_bitset& x) const
+    noexcept {
+  for (size_t i = 0; i < words_.size(); ++i)
+    if (words_[i] & x.words_[i])
+      return true;
+  return false;
+}
+template <class Alloc>
+bool dynamic_bitset<Alloc>::is_subset_of(const dynamic_bitset& x) const
+    noexcept {
+  for (size_t i = 0; i < words_.size(); ++i)
+    if (words_[i] & ~x.words_[i])
+      return false;
+  return true;
+}
+template <class Alloc>
+size_t dynamic_bitset<Alloc>::find_first() const noexcept {
+  return words_.empty() ? npos : find_from(0, words_[0]);
+}
+template <class Alloc>
+size_t dynamic_bitset<Alloc>::find_next(size_t pos) const noexcept {
+  if (++pos >= size_)
+    return npos;
+  size_t w = pos / bits_per_word;
+  return find_from(w, words_[w] & ~(mask_of(pos) - 1));
+}
+template <class Alloc>
+const vector<uint64_t, Alloc>& dynamic_bitset<Alloc>::words() const noexcept {
+  return words_;
+}
+
+//=========================== non-member functions ===========================//
+template <class Alloc>
+void swap(dynamic_bitset<Alloc>& x, dynamic_bitset<Alloc>& y) {
+  x.swap(y);
+}
+template <class Alloc>
+dynamic_bitset<Alloc> operator&(const dynamic_bitset<Alloc>& x,
+                                const dynamic_bitset<Alloc>& y) {
+  auto res = x;
+  return res &= y;
+}
+template <class Alloc>
+dynamic_bitset<Alloc> operator|(const dynamic_bitset<Alloc>& x,
+                                const dynamic_bitset<Alloc>& y) {
+  auto res = x;
+  return res |= y;
+}
+template <class Alloc>
+dynamic_bitset<Alloc> operator^(const dynamic_bitset<Alloc>& x,
+                                const dynamic_bitset<Alloc>& y) {
+  auto res = x;
+  return res ^= y;
+}
+template <class Alloc>
+dynamic_bitset<Alloc> operator-(const dynamic_bitset<Alloc>& x,
+                                const dynamic_bitset<Alloc>& y) {
+  auto res = x;
+  return res -= y;
+}
+template <class Alloc>
+bool operator==(const dynamic_bitset<Alloc>& x,
+                const dynamic_bitset<Alloc>& y) {
+  if (x.size() != y.size())
+    return false;
+  for (size_t i = 0; i < x.word_count(); ++i)
+    if (x.data()[i] != y.data()[i])
+      return false;
+  return true;
+}
+template <class Alloc>
+bool operator!=(const dynamic_bitset<Alloc>& x,
+                const dynamic_bitset<Alloc>& y) {
+  return !(x == y);
+}
+}  // namespace mrsuyi
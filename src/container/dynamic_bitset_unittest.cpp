@@ -0,0 +1,115 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "dynamic_bitset.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(DynamicBitsetTest, Access) {
+  dynamic_bitset<> bits(130);
+  EXPECT_EQ(130, bits.size());
+  EXPECT_EQ(3, bits.word_count());
+  EXPECT_TRUE(bits.none());
+  bits[0] = true;
+  bits[64] = bits[0];
+  bits.set(129);
+  bits.flip(1);
+  bits.flip(1);
+  EXPECT_TRUE(bits[0]);
+  EXPECT_FALSE(bits[1]);
+  EXPECT_TRUE(bits.test(64));
+  EXPECT_TRUE(bits.back());
+  EXPECT_THROW(bits.test(130), std::out_of_range);
+  EXPECT_EQ(1, bits.data()[1]);
+  EXPECT_EQ(3, bits.count());
+
+  // proxies through iterators
+  size_t set = 0;
+  for (bool b : bits)
+    set += b;
+  EXPECT_EQ(3, set);
+  auto it = bits.begin() + 65;
+  *--it = false;
+  EXPECT_FALSE(bits[64]);
+  EXPECT_EQ(130, bits.end() - bits.begin());
+  EXPECT_EQ(bits.begin() + 129, bits.end() - 1);
+  const auto& cbits = bits;
+  EXPECT_TRUE(*(cbits.begin() + 129));
+
+  dynamic_bitset<> il = {true, false, true};
+  EXPECT_EQ(2, il.count());
+  EXPECT_TRUE(il.front());
+}
+
+TEST(DynamicBitsetTest, Resize) {
+  dynamic_bitset<> bits;
+  for (int i = 0; i < 100; ++i)
+    bits.push_back(i % 3 == 0);
+  EXPECT_EQ(34, bits.count());
+  bits.pop_back();
+  EXPECT_EQ(99, bits.size());
+  EXPECT_EQ(33, bits.count());
+
+  // bits past size() never show
+  bits.resize(10);
+  EXPECT_EQ(4, bits.count());
+  bits.resize(200, true);
+  EXPECT_EQ(194, bits.count());
+  bits.resize(70);
+  bits.flip();
+  EXPECT_EQ(6, bits.count());
+
+  dynamic_bitset<> full(100, true);
+  EXPECT_EQ(100, full.count());
+  EXPECT_TRUE(full.all());
+  full.reset(99);
+  EXPECT_FALSE(full.all());
+  EXPECT_TRUE(dynamic_bitset<>().all());
+  EXPECT_TRUE(dynamic_bitset<>(128, true).all());
+}
+
+TEST(DynamicBitsetTest, Find) {
+  dynamic_bitset<> bits(1000);
+  EXPECT_EQ(dynamic_bitset<>::npos, bits.find_first());
+  vector<size_t> expected = {3, 63, 64, 500, 999};
+  for (auto i : expected)
+    bits.set(i);
+  vector<size_t> found;
+  for (size_t i = bits.find_first(); i != bits.npos; i = bits.find_next(i))
+    found.push_back(i);
+  EXPECT_EQ(expected, found);
+  EXPECT_EQ(bits.npos, bits.find_next(999));
+}
+
+TEST(DynamicBitsetTest, Operations) {
+  // long enough for the vector loops and a scalar tail
+  dynamic_bitset<> a(1000), b(1000);
+  for (size_t i = 0; i < 1000; i += 2)
+    a.set(i);
+  for (size_t i = 0; i < 1000; i += 3)
+    b.set(i);
+
+  EXPECT_EQ(167, (a & b).count());
+  EXPECT_EQ(167, a.count_and(b));
+  EXPECT_EQ(667, (a | b).count());
+  EXPECT_EQ(500, (a ^ b).count());
+  EXPECT_EQ(333, (a - b).count());
+  EXPECT_EQ(500, (~a).count());
+  EXPECT_TRUE(a.intersects(b));
+  EXPECT_FALSE(a.intersects(~a));
+  EXPECT_TRUE((a & b).is_subset_of(b));
+  EXPECT_FALSE(a.is_subset_of(b));
+
+  auto c = a;
+  assert(c == a);
+  c ^= a;
+  EXPECT_TRUE(c.none());
+  c |= b;
+  c -= b;
+  EXPECT_FALSE(c.any());
+  assert(c != a);
+  c.swap(a);
+  EXPECT_EQ(500, c.count());
+  EXPECT_EQ(0, a.count());
+}
@@ -0,0 +1,716 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "algorithm.hpp"
+#include "functional.hpp"
+#include "memory.hpp"
+
+namespace mrsuyi {
+// control bytes of flat_hash_table
+// a full slot stores the low 7 bits of its hash(h2), all the others have the
+// sign-bit set so that a group can be classified with one compare
+static const int8_t ctrl_empty = -128;  // 0b10000000
+static const int8_t ctrl_deleted = -2;  // 0b11111110
+static const int8_t ctrl_sentinel = -1;  // 0b11111111
+
+// 16 control bytes probed at once, every match returns a bit-mask whose i-th
+// bit stands for the i-th slot of the group
+struct flat_group {
+  static const size_t width = 16;
+
+#ifdef __SSE2__
+  explicit flat_group(const int8_t* pos)
+      : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+  uint32_t match(int8_t h2) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_));
+  }
+  uint32_t match_empty() const { return match(ctrl_empty); }
+  uint32_t match_empty_or_deleted() const {
+    return _mm_movemask_epi8(
+        _mm_cmpgt_epi8(_mm_set1_epi8(ctrl_sentinel), ctrl_));
+  }
+
+ private:
+  __m128i ctrl_;
+#else
+  explicit flat_group(const int8_t* pos) { std::memcpy(ctrl_, pos, width); }
+
+  // may report false positives right after a real match, which are sorted
+  // out by the key comparison anyway
+  uint32_t match(int8_t h2) const {
+    uint64_t pattern = lsbs * static_cast<uint8_t>(h2);
+    return gather(ctrl_[0] ^ pattern, ctrl_[1] ^ pattern, [](uint64_t x) {
+      return (x - lsbs) & ~x & msbs;
+    });
+  }
+  uint32_t match_empty() const {
+    return gather(ctrl_[0], ctrl_[1],
+                  [](uint64_t x) { return x & (~x << 6) & msbs; });
+  }
+  uint32_t match_empty_or_deleted() const {
+    return gather(ctrl_[0], ctrl_[1],
+                  [](uint64_t x) { return x & (~x << 7) & msbs; });
+  }
+
+ private:
+  static const uint64_t lsbs = 0x0101010101010101ull;
+  static const uint64_t msbs = 0x8080808080808080ull;
+
+  // squeeze the per-byte sign-bits of both words into a 16-bit mask
+  template <class Pred>
+  static uint32_t gather(uint64_t lo, uint64_t hi, Pred pred) {
+    auto squeeze = [](uint64_t x) {
+      return static_cast<uint32_t>(((x >> 7) * 0x0102040810204080ull) >> 56);
+    };
+    return squeeze(pred(lo)) | (squeeze(pred(hi)) << 8);
+  }
+
+  uint64_t ctrl_[2];
+#endif
+};
+
+// open-addressing hash table with a swiss-table style control-byte array
+// shares the template parameters of hash_table so that unique-key users can
+// switch with a typedef. multi-key operations(*_equal) are not supported
+template <class Value,
+          class Key = Value,
+          class Hash = hash<Key>,
+          class ExtractKey = identity<Value>,
+          class KeyEqual = equal_to<Key>,
+          class Allocator = allocator<Key>>
+class flat_hash_table {
+  template <class E>
+  class iter;
+
+  using ctrl_allocator = typename Allocator::template other<int8_t>;
+  using slot_allocator = typename Allocator::template other<Value>;
+
+ public:
+  using key_type = Key;
+  using value_type = Value;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+
+  using iterator = iter<Value>;
+  using const_iterator = iter<const Value>;
+
+ public:
+  // ctor & dtor
+  flat_hash_table();
+  explicit flat_hash_table(size_t bucket_suggest,
+                           const Hash& = Hash(),
+                           const KeyEqual& = KeyEqual(),
+                           const Allocator& = Allocator());
+  // copy
+  flat_hash_table(const flat_hash_table&);
+  // move
+  flat_hash_table(flat_hash_table&&);
+  ~flat_hash_table();
+
+  flat_hash_table& operator=(const flat_hash_table& other);
+  flat_hash_table& operator=(flat_hash_table&& other);
+
+  Allocator get_allocator() const;
+
+  // iterators
+  iterator begin() noexcept;
+  iterator end() noexcept;
+  const_iterator begin() const noexcept;
+  const_iterator end() const noexcept;
+  const_iterator cbegin() const noexcept;
+  const_iterator cend() const noexcept;
+
+  // capacity
+  bool empty() const noexcept;
+  size_t size() const noexcept;
+  size_t max_size() const noexcept;
+
+  // modifiers
+  void clear();
+
+  template <class... Args>
+  pair<iterator, bool> emplace_unique(Args&&... args);
+
+  iterator erase(const_iterator pos);
+  iterator erase(const_iterator first, const_iterator last);
+  size_t erase_unique(const Key& key);
+
+  void swap(flat_hash_table& other);
+
+  // lookup
+  size_t count_unique(const Key& key) const;
+  iterator find(const Key& key);
+  const_iterator find(const Key& key) const;
+  pair<iterator, iterator> equal_range(const Key& key);
+  pair<const_iterator, const_iterator> equal_range(const Key& key) const;
+
+  // bucket interface
+  size_t bucket_count() const;
+  size_t max_bucket_count() const;
+
+  // hash policy
+  float load_factor() const;
+  float max_load_factor() const;
+  // values above 7/8 are clamped, probing relies on empty slots to stop
+  void max_load_factor(float ml);
+  void rehash(size_t count);
+  void reserve(size_t count);
+
+  // observers
+  Hash hash_function() const;
+  KeyEqual key_eq() const;
+
+ protected:
+  static const size_t npos = size_t(-1);
+
+  // spread the hash over all bits, identity hashes leave the high bits empty
+  size_t hashing(const Key& key) const;
+  // slot index of [key], npos if absent
+  size_t search(const Key& key, size_t h) const;
+  // first empty or deleted slot on the probe sequence of [h]
+  size_t find_first_non_full(size_t h) const;
+  // find the slot of [key] or a free one for it, [h] gets the hash of [key]
+  pair<size_t, bool> prepare_insert(const Key& key, size_t& h);
+  // mark free slot [i] full once its element is constructed
+  void commit_insert(size_t i, size_t h);
+  // set control byte of slot [i] and its cloned byte behind the sentinel
+  void set_ctrl(size_t i, int8_t h);
+  // destroy slot [i] and mark it empty or deleted
+  void erase_slot(size_t i);
+  // slots available before reaching max_load_factor
+  size_t growth_capacity(size_t cap) const;
+  // rebuild in place when tombstones dominate, grow otherwise
+  void grow();
+  // move all elements into a table of [cap] slots
+  void resize(size_t cap);
+  // destroy elements and free the arrays
+  void destroy_slots();
+
+ protected:
+  Hash hash_;
+  ExtractKey extract_key_;
+  KeyEqual key_equal_;
+  Allocator alloc_;
+
+  // [capacity_ + width] bytes: one per slot, the sentinel, then the first
+  // (width - 1) bytes cloned so that a group load never wraps around
+  int8_t* ctrl_;
+  Value* slots_;
+  // always 0 or (2^n - 1), used as mask
+  size_t capacity_;
+  size_t size_;
+  size_t growth_left_;
+  float max_load_factor_;
+};
+
+//=================================== iter ===================================//
+template <class V, class K, class H, class Ex, class Kq, class A>
+template <class E>
+class flat_hash_table<V, K, H, Ex, Kq, A>::iter {
+  friend class flat_hash_table<V, K, H, Ex, Kq, A>;
+
+ public:
+  using value_type = E;
+  using difference_type = ptrdiff_t;
+  using reference = E&;
+  using pointer = E*;
+  using iterator_category = forward_iterator_tag;
+
+  iter() : ctrl_(nullptr), slot_(nullptr) {}
+  iter(int8_t* ctrl, V* slot) : ctrl_(ctrl), slot_(slot) {}
+  iter(const iter& it) : ctrl_(it.ctrl_), slot_(it.slot_) {}
+  iter& operator=(const iter& it) {
+    ctrl_ = it.ctrl_;
+    slot_ = it.slot_;
+    return *this;
+  }
+  E& operator*() const { return *slot_; }
+  E* operator->() const { return slot_; }
+  bool operator==(const iter& it) const { return slot_ == it.slot_; }
+  bool operator!=(const iter& it) const { return slot_ != it.slot_; }
+  iter& operator++() {
+    ++ctrl_;
+    ++slot_;
+    skip_empty_or_deleted();
+    return *this;
+  }
+  iter operator++(int) {
+    auto res = *this;
+    ++*this;
+    return res;
+  }
+  operator iter<const E>() const { return iter<const E>(ctrl_, slot_); }
+
+ protected:
+  // stop at the next full slot, or become end() at the sentinel
+  void skip_empty_or_deleted() {
+    while (*ctrl_ < ctrl_sentinel) {
+      uint32_t shift =
+          __builtin_ctz(~flat_group(ctrl_).match_empty_or_deleted());
+      ctrl_ += shift;
+      slot_ += shift;
+    }
+    if (*ctrl_ == ctrl_sentinel) {
+      ctrl_ = nullptr;
+      slot_ = nullptr;
+    }
+  }
+
+  int8_t* ctrl_;
+  V* slot_;
+};
+
+//================================= protected ================================//
+template <class V, class K, class H, class Ex, class Kq, class A>
+size_t flat_hash_table<V, K, H, Ex, Kq, A>::hashing(const K& key) const {
+  size_t h = hash_(key) * size_t(0x9E3779B97F4A7C15ull);
+  return h ^ (h >> (sizeof(size_t) * 4));
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+size_t flat_hash_table<V, K, H, Ex, Kq, A>::search(const K& key,
+                                                   size_t h) const {
+  if (!capacity_)
+    return npos;
+  int8_t h2 = h & 0x7f;
+  size_t pos = (h >> 7) & capacity_;
+  for (size_t step = flat_group::width;; pos = (pos + step) & capacity_,
+              step += flat_group::width) {
+    flat_group g(ctrl_ + pos);
+    for (uint32_t m = g.match(h2); m; m &= m - 1) {
+      size_t i = (pos + __builtin_ctz(m)) & capacity_;
+      if (key_equal_(extract_key_(slots_[i]), key))
+        return i;
+    }
+    if (g.match_empty())
+      return npos;
+  }
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+size_t flat_hash_table<V, K, H, Ex, Kq, A>::find_first_non_full(
+    size_t h) const {
+  size_t pos = (h >> 7) & capacity_;
+  for (size_t step = flat_group::width;; pos = (pos + step) & capacity_,
+              step += flat_group::width) {
+    uint32_t m = flat_group(ctrl_ + pos).match_empty_or_deleted();
+    if (m)
+      return (pos + __builtin_ctz(m)) & capacity_;
+  }
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+pair<size_t, bool> flat_hash_table<V, K, H, Ex, Kq, A>::prepare_insert(
+    const K& key,
+    size_t& h) {
+  h = hashing(key);
+  size_t i = search(key, h);
+  if (i != npos)
+    return {i, false};
+  if (!growth_left_)
+    grow();
+  return {find_first_non_full(h), true};
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+void flat_hash_table<V, K, H, Ex, Kq, A>::commit_insert(size_t i, size_t h) {
+  growth_left_ -= ctrl_[i] == ctrl_empty;
+  set_ctrl(i, h & 0x7f);
+  ++size_;
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+void flat_hash_table<V, K, H, Ex, Kq, A>::set_ctrl(size_t i, int8_t h) {
+  ctrl_[i] = h;
+  ctrl_[((i - (flat_group::width - 1)) & capacity_) + flat_group::width - 1] =
+      h;
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+void flat_hash_table<V, K, H, Ex, Kq, A>::erase_slot(size_t i) {
+  destroy_at(slots_ + i);
+  --size_;
+  // a probe sequence only stops at an empty slot, so [i] may become empty
+  // again only if no group covering it has ever been seen full
+  size_t before = (i - flat_group::width) & capacity_;
+  uint32_t empty_after = flat_group(ctrl_ + i).match_empty();
+  uint32_t empty_before = flat_group(ctrl_ + before).match_empty();
+  bool was_never_full =
+      empty_before && empty_after &&
+      size_t(__builtin_ctz(empty_after) + __builtin_clz(empty_before) - 16) <
+          flat_group::width;
+  set_ctrl(i, was_never_full ? ctrl_empty : ctrl_deleted);
+  growth_left_ += was_never_full;
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+size_t flat_hash_table<V, K, H, Ex, Kq, A>::growth_capacity(size_t cap) const {
+  return min(size_t(cap * max_load_factor_), cap - 1);
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+void flat_hash_table<V, K, H, Ex, Kq, A>::grow() {
+  if (capacity_ && size_ < growth_capacity(capacity_) / 2)
+    resize(capacity_);
+  else
+    resize(capacity_ ? capacity_ * 2 + 1 : flat_group::width - 1);
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+void flat_hash_table<V, K, H, Ex, Kq, A>::resize(size_t cap) {
+  int8_t* old_ctrl = ctrl_;
+  V* old_slots = slots_;
+  size_t old_capacity = capacity_;
+
+  ctrl_ = ctrl_allocator(alloc_).allocate(cap + flat_group::width);
+  slots_ = slot_allocator(alloc_).allocate(cap);
+  capacity_ = cap;
+  std::memset(ctrl_, ctrl_empty, cap + flat_group::width);
+  ctrl_[cap] = ctrl_sentinel;
+
+  for (size_t i = 0; i < old_capacity; ++i) {
+    if (old_ctrl[i] < 0)
+      continue;
+    size_t h = hashing(extract_key_(old_slots[i]));
+    size_t n = find_first_non_full(h);
+    set_ctrl(n, h & 0x7f);
+    construct(slots_ + n, move(old_slots[i]));
+    destroy_at(old_slots + i);
+  }
+  growth_left_ = growth_capacity(cap) - size_;
+
+  if (old_capacity) {
+    ctrl_allocator(alloc_).deallocate(old_ctrl,
+                                      old_capacity + flat_group::width);
+    slot_allocator(alloc_).deallocate(old_slots, old_capacity);
+  }
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+void flat_hash_table<V, K, H, Ex, Kq, A>::destroy_slots() {
+  if (!capacity_)
+    return;
+  for (size_t i = 0; i < capacity_; ++i)
+    if (ctrl_[i] >= 0)
+      destroy_at(slots_ + i);
+  ctrl_allocator(alloc_).deallocate(ctrl_, capacity_ + flat_group::width);
+  slot_allocator(alloc_).deallocate(slots_, capacity_);
+  ctrl_ = nullptr;
+  slots_ = nullptr;
+  capacity_ = size_ = growth_left_ = 0;
+}
+
+//=================================== basic ==================================//
+// ctor & dtor
+// default
+template <class V, class K, class H, class Ex, class Kq, class A>
+flat_hash_table<V, K, H, Ex, Kq, A>::flat_hash_table() : flat_hash_table(0) {}
+template <class V, class K, class H, class Ex, class Kq, class A>
+flat_hash_table<V, K, H, Ex, Kq, A>::flat_hash_table(size_t bucket_suggest,
+                                                     const H& hash,
+                                                     const Kq& key_equal,
+                                                     const A& alloc)
+    : hash_(hash),
+      extract_key_(Ex()),
+      key_equal_(key_equal),
+      alloc_(alloc),
+      ctrl_(nullptr),
+      slots_(nullptr),
+      capacity_(0),
+      size_(0),
+      growth_left_(0),
+      max_load_factor_(0.875f) {
+  if (bucket_suggest)
+    rehash(bucket_suggest);
+}
+// copy
+template <class V, class K, class H, class Ex, class Kq, class A>
+flat_hash_table<V, K, H, Ex, Kq, A>::flat_hash_table(
+    const flat_hash_table& other)
+    : hash_(other.hash_),
+      extract_key_(Ex()),
+      key_equal_(other.key_equal_),
+      alloc_(A()),
+      ctrl_(nullptr),
+      slots_(nullptr),
+      capacity_(other.capacity_),
+      size_(other.size_),
+      growth_left_(other.growth_left_),
+      max_load_factor_(other.max_load_factor_) {
+  if (!capacity_)
+    return;
+  ctrl_ = ctrl_allocator(alloc_).allocate(capacity_ + flat_group::width);
+  slots_ = slot_allocator(alloc_).allocate(capacity_);
+  std::memcpy(ctrl_, other.ctrl_, capacity_ + flat_group::width);
+  for (size_t i = 0; i < capacity_; ++i)
+    if (ctrl_[i] >= 0)
+      construct(slots_ + i, other.slots_[i]);
+}
+// move
+template <class V, class K, class H, class Ex, class Kq, class A>
+flat_hash_table<V, K, H, Ex, Kq, A>::flat_hash_table(flat_hash_table&& other)
+    : hash_(other.hash_),
+      extract_key_(Ex()),
+      key_equal_(other.key_equal_),
+      alloc_(other.alloc_),
+      ctrl_(other.ctrl_),
+      slots_(other.slots_),
+      capacity_(other.capacity_),
+      size_(other.size_),
+      growth_left_(other.growth_left_),
+      max_load_factor_(other.max_load_factor_) {
+  other.ctrl_ = nullptr;
+  other.slots_ = nullptr;
+  other.capacity_ = other.size_ = other.growth_left_ = 0;
+}
+// dtor
+template <class V, class K, class H, class Ex, class Kq, class A>
+flat_hash_table<V, K, H, Ex, Kq, A>::~flat_hash_table() {
+  destroy_slots();
+}
+// = copy
+template <class V, class K, class H, class Ex, class Kq, class A>
+flat_hash_table<V, K, H, Ex, Kq, A>& flat_hash_table<V, K, H, Ex, Kq, A>::
+operator=(const flat_hash_table& other) {
+  flat_hash_table(other).swap(*this);
+  return *this;
+}
+// = move
+template <class V, class K, class H, class Ex, class Kq, class A>
+flat_hash_table<V, K, H, Ex, Kq, A>& flat_hash_table<V, K, H, Ex, Kq, A>::
+operator=(flat_hash_table&& other) {
+  flat_hash_table(move(other)).swap(*this);
+  return *this;
+}
+// allocator
+template <class V, class K, class H, class Ex, class Kq, class A>
+A flat_hash_table<V, K, H, Ex, Kq, A>::get_allocator() const {
+  return alloc_;
+}
+
+//================================= iterators ================================//
+template <class V, class K, class H, class Ex, class Kq, class A>
+typename flat_hash_table<V, K, H, Ex, Kq, A>::iterator
+flat_hash_table<V, K, H, Ex, Kq, A>::begin() noexcept {
+  if (!capacity_)
+    return end();
+  iterator res(ctrl_, slots_);
+  res.skip_empty_or_deleted();
+  return res;
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+typename flat_hash_table<V, K, H, Ex, Kq, A>::iterator
+flat_hash_table<V, K, H, Ex, Kq, A>::end() noexcept {
+  return iterator();
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+typename flat_hash_table<V, K, H, Ex, Kq, A>::const_iterator
+flat_hash_table<V, K, H, Ex, Kq, A>::begin() const noexcept {
+  return const_cast<flat_hash_table*>(this)->begin();
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+typename flat_hash_table<V, K, H, Ex, Kq, A>::const_iterator
+flat_hash_table<V, K, H, Ex, Kq, A>::end() const noexcept {
+  return const_iterator();
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+typename flat_hash_table<V, K, H, Ex, Kq, A>::const_iterator
+flat_hash_table<V, K, H, Ex, Kq, A>::cbegin() const noexcept {
+  return begin();
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+typename flat_hash_table<V, K, H, Ex, Kq, A>::const_iterator
+flat_hash_table<V, K, H, Ex, Kq, A>::cend() const noexcept {
+  return end();
+}
+
+//================================= capacity =================================//
+template <class V, class K, class H, class Ex, class Kq, class A>
+bool flat_hash_table<V, K, H, Ex, Kq, A>::empty() const noexcept {
+  return size() == 0;
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+size_t flat_hash_table<V, K, H, Ex, Kq, A>::size() const noexcept {
+  return size_;
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+size_t flat_hash_table<V, K, H, Ex, Kq, A>::max_size() const noexcept {
+  return max_bucket_count() - max_bucket_count() / 8;
+}
+
+//================================= modifiers ================================//
+// clear
+template <class V, class K, class H, class Ex, class Kq, class A>
+void flat_hash_table<V, K, H, Ex, Kq, A>::clear() {
+  if (!capacity_)
+    return;
+  for (size_t i = 0; i < capacity_; ++i)
+    if (ctrl_[i] >= 0)
+      destroy_at(slots_ + i);
+  std::memset(ctrl_, ctrl_empty, capacity_ + flat_group::width);
+  ctrl_[capacity_] = ctrl_sentinel;
+  size_ = 0;
+  growth_left_ = growth_capacity(capacity_);
+}
+// emplace
+template <class V, class K, class H, class Ex, class Kq, class A>
+template <class... Args>
+pair<typename flat_hash_table<V, K, H, Ex, Kq, A>::iterator, bool>
+flat_hash_table<V, K, H, Ex, Kq, A>::emplace_unique(Args&&... args) {
+  typename std::aligned_storage<sizeof(V), alignof(V)>::type buf;
+  V* tmp = reinterpret_cast<V*>(&buf);
+  construct(tmp, forward<Args>(args)...);
+  // the slot stays free until its element is there, a throwing hash or
+  // constructor leaves the table as it was
+  try {
+    size_t h;
+    auto res = prepare_insert(extract_key_(*tmp), h);
+    if (res.second) {
+      construct(slots_ + res.first, move(*tmp));
+      commit_insert(res.first, h);
+    }
+    destroy_at(tmp);
+    return {iterator(ctrl_ + res.first, slots_ + res.first), res.second};
+  } catch (...) {
+    destroy_at(tmp);
+    throw;
+  }
+}
+// erase
+template <class V, class K, class H, class Ex, class Kq, class A>
+typename flat_hash_table<V, K, H, Ex, Kq, A>::iterator
+flat_hash_table<V, K, H, Ex, Kq, A>::erase(const_iterator pos) {
+  size_t i = pos.slot_ - slots_;
+  erase_slot(i);
+  iterator res(ctrl_ + i, slots_ + i);
+  res.skip_empty_or_deleted();
+  return res;
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+typename flat_hash_table<V, K, H, Ex, Kq, A>::iterator
+flat_hash_table<V, K, H, Ex, Kq, A>::erase(const_iterator first,
+                                           const_iterator last) {
+  for (; first != last; first = erase(first)) {
+  }
+  return iterator(last.ctrl_, last.slot_);
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+size_t flat_hash_table<V, K, H, Ex, Kq, A>::erase_unique(const K& key) {
+  size_t i = search(key, hashing(key));
+  if (i == npos)
+    return 0;
+  erase_slot(i);
+  return 1;
+}
+// swap
+template <class V, class K, class H, class Ex, class Kq, class A>
+void flat_hash_table<V, K, H, Ex, Kq, A>::swap(flat_hash_table& other) {
+  mrsuyi::swap(hash_, other.hash_);
+  mrsuyi::swap(extract_key_, other.extract_key_);
+  mrsuyi::swap(key_equal_, other.key_equal_);
+  mrsuyi::swap(alloc_, other.alloc_);
+  mrsuyi::swap(ctrl_, other.ctrl_);
+  mrsuyi::swap(slots_, other.slots_);
+  mrsuyi::swap(capacity_, other.capacity_);
+  mrsuyi::swap(size_, other.size_);
+  mrsuyi::swap(growth_left_, other.growth_left_);
+  mrsuyi::swap(max_load_factor_, other.max_load_factor_);
+}
+
+//================================== lookup ==================================//
+// count
+template <class V, class K, class H, class Ex, class Kq, class A>
+size_t flat_hash_table<V, K, H, Ex, Kq, A>::count_unique(const K& key) const {
+  return search(key, hashing(key)) != npos;
+}
+// find
+template <class V, class K, class H, class Ex, class Kq, class A>
+typename flat_hash_table<V, K, H, Ex, Kq, A>::iterator
+flat_hash_table<V, K, H, Ex, Kq, A>::find(const K& key) {
+  size_t i = search(key, hashing(key));
+  return i == npos ? end() : iterator(ctrl_ + i, slots_ + i);
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+typename flat_hash_table<V, K, H, Ex, Kq, A>::const_iterator
+flat_hash_table<V, K, H, Ex, Kq, A>::find(const K& key) const {
+  return const_cast<flat_hash_table*>(this)->find(key);
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+pair<typename flat_hash_table<V, K, H, Ex, Kq, A>::iterator,
+     typename flat_hash_table<V, K, H, Ex, Kq, A>::iterator>
+flat_hash_table<V, K, H, Ex, Kq, A>::equal_range(const K& key) {
+  auto it = find(key);
+  if (it == end())
+    return {it, it};
+  auto nxt = it;
+  return {it, ++nxt};
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+pair<typename flat_hash_table<V, K, H, Ex, Kq, A>::const_iterator,
+     typename flat_hash_table<V, K, H, Ex, Kq, A>::const_iterator>
+flat_hash_table<V, K, H, Ex, Kq, A>::equal_range(const K& key) const {
+  auto p = const_cast<flat_hash_table*>(this)->equal_range(key);
+  return {p.first, p.second};
+}
+
+//============================== bucket interface ============================//
+template <class V, class K, class H, class Ex, class Kq, class A>
+size_t flat_hash_table<V, K, H, Ex, Kq, A>::bucket_count() const {
+  return capacity_;
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+size_t flat_hash_table<V, K, H, Ex, Kq, A>::max_bucket_count() const {
+  return size_t(-1) >> 1;
+}
+
+//=============================== hash policy ================================//
+template <class V, class K, class H, class Ex, class Kq, class A>
+float flat_hash_table<V, K, H, Ex, Kq, A>::load_factor() const {
+  return capacity_ ? float(size()) / bucket_count() : 0;
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+float flat_hash_table<V, K, H, Ex, Kq, A>::max_load_factor() const {
+  return max_load_factor_;
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+void flat_hash_table<V, K, H, Ex, Kq, A>::max_load_factor(float ml) {
+  // slots taken by elements & tombstones stay taken, the room left follows
+  // the new limit at once
+  size_t used = capacity_ ? growth_capacity(capacity_) - growth_left_ : 0;
+  max_load_factor_ = min(ml, 0.875f);
+  if (!capacity_)
+    return;
+  size_t limit = growth_capacity(capacity_);
+  growth_left_ = used < limit ? limit - used : 0;
+  // grows if the elements alone are over the limit, else tombstones go with
+  // the next insertion
+  if (size_ > limit)
+    rehash(0);
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+void flat_hash_table<V, K, H, Ex, Kq, A>::rehash(size_t count) {
+  size_t cap = flat_group::width - 1;
+  for (; cap < count || growth_capacity(cap) < size(); cap = cap * 2 + 1)
+    ;
+  if (cap > capacity_)
+    resize(cap);
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+void flat_hash_table<V, K, H, Ex, Kq, A>::reserve(size_t count) {
+  rehash(std::ceil(count / max_load_factor()));
+}
+//================================= observers ================================//
+template <class V, class K, class H, class Ex, class Kq, class A>
+H flat_hash_table<V, K, H, Ex, Kq, A>::hash_function() const {
+  return hash_;
+}
+template <class V, class K, class H, class Ex, class Kq, class A>
+Kq flat_hash_table<V, K, H, Ex, Kq, A>::key_eq() const {
+  return key_equal_;
+}
+}  // namespace mrsuyi
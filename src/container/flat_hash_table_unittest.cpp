@@ -0,0 +1,187 @@
+#include <stdexcept>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "flat_hash_table.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+template <class T>
+void insert_unique(flat_hash_table<T>& ht, std::initializer_list<T> il) {
+  for (auto it = il.begin(); it != il.end(); ++it)
+    ht.emplace_unique(*it);
+}
+
+TEST(FlatHashTableTest, Constructor) {
+  // default
+  flat_hash_table<int> ht;
+  assert(ht.bucket_count() == 0);
+  assert(ht.begin() == ht.end());
+  insert_unique(ht, {1, 2, 3});
+  EXPECT_THAT(ht, UnorderedElementsAre(1, 2, 3));
+  // copy
+  auto cp(ht);
+  EXPECT_THAT(cp, UnorderedElementsAre(1, 2, 3));
+  EXPECT_THAT(ht, UnorderedElementsAre(1, 2, 3));
+  // move
+  auto mv(mrsuyi::move(ht));
+  EXPECT_THAT(mv, UnorderedElementsAre(1, 2, 3));
+  assert(ht.empty());
+
+  // swap
+  mv.swap(ht);
+  EXPECT_THAT(ht, UnorderedElementsAre(1, 2, 3));
+  assert(mv.empty());
+
+  // = copy
+  mv = ht;
+  EXPECT_THAT(ht, UnorderedElementsAre(1, 2, 3));
+  EXPECT_THAT(mv, UnorderedElementsAre(1, 2, 3));
+
+  // = move
+  mv = mrsuyi::move(ht);
+  EXPECT_THAT(mv, UnorderedElementsAre(1, 2, 3));
+  assert(ht.empty());
+}
+
+TEST(FlatHashTableTest, Emplace) {
+  flat_hash_table<int> ht;
+  assert(ht.emplace_unique(1).second);
+  assert(!ht.emplace_unique(1).second);
+  assert(*ht.emplace_unique(2).first == 2);
+  EXPECT_THAT(ht, UnorderedElementsAre(1, 2));
+  assert(ht.bucket_count() == 15);
+
+  for (int i = 0; i < 1000; ++i)
+    ht.emplace_unique(i);
+  EXPECT_EQ(1000, ht.size());
+  EXPECT_LE(ht.load_factor(), ht.max_load_factor());
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(1, ht.count_unique(i));
+  EXPECT_EQ(0, ht.count_unique(1000));
+}
+
+namespace {
+// counts live objects, moves throw while [fail] is set
+struct fragile {
+  static int live;
+  static bool fail;
+  int val;
+  fragile(int v) : val(v) { ++live; }
+  fragile(const fragile& x) : val(x.val) { ++live; }
+  fragile(fragile&& x) : val(x.val) {
+    if (fail)
+      throw std::runtime_error("move");
+    ++live;
+  }
+  ~fragile() { --live; }
+  bool operator==(const fragile& x) const { return val == x.val; }
+};
+int fragile::live = 0;
+bool fragile::fail = false;
+struct fragile_hash {
+  size_t operator()(const fragile& x) const { return hash<int>()(x.val); }
+};
+}  // namespace
+
+TEST(FlatHashTableTest, EmplaceThrows) {
+  {
+    flat_hash_table<fragile, fragile, fragile_hash> ht;
+    ht.reserve(100);
+    for (int i = 0; i < 10; ++i)
+      ht.emplace_unique(i);
+    fragile::fail = true;
+    EXPECT_THROW(ht.emplace_unique(10), std::runtime_error);
+    fragile::fail = false;
+    // the claimed slot is left free & the temporary is gone
+    EXPECT_EQ(10, ht.size());
+    EXPECT_EQ(10, fragile::live);
+    EXPECT_EQ(0, ht.count_unique(10));
+    for (auto& x : ht)
+      EXPECT_LT(x.val, 10);
+    assert(ht.emplace_unique(10).second);
+    EXPECT_EQ(11, ht.size());
+  }
+  EXPECT_EQ(0, fragile::live);
+}
+
+TEST(FlatHashTableTest, Erase) {
+  // single
+  flat_hash_table<int> ht;
+  insert_unique(ht, {1, 2, 3, 4});
+  ht.erase(ht.find(2));
+  EXPECT_THAT(ht, UnorderedElementsAre(1, 3, 4));
+
+  // range
+  ht.erase(ht.begin(), ++++ht.begin());
+  EXPECT_EQ(1, ht.size());
+
+  // key-unique
+  ht.clear();
+  insert_unique(ht, {8, 9});
+  assert(ht.erase_unique(8) == 1);
+  assert(ht.erase_unique(8) == 0);
+  EXPECT_THAT(ht, UnorderedElementsAre(9));
+
+  // tombstones are reused instead of growing the table forever
+  ht.clear();
+  for (int round = 0; round < 100; ++round) {
+    for (int i = 0; i < 10; ++i)
+      ht.emplace_unique(round * 10 + i);
+    for (int i = 0; i < 10; ++i)
+      ht.erase_unique(round * 10 + i);
+  }
+  assert(ht.empty());
+  EXPECT_EQ(15, ht.bucket_count());
+}
+
+TEST(FlatHashTableTest, Find) {
+  flat_hash_table<int> ht;
+  assert(ht.find(1) == ht.end());
+  insert_unique(ht, {1, 2, 3});
+
+  assert(*ht.find(1) == 1);
+  assert(ht.find(4) == ht.end());
+
+  auto p = ht.equal_range(2);
+  auto it = p.first;
+  assert(*it++ == 2);
+  assert(it == p.second);
+
+  p = ht.equal_range(4);
+  assert(p.first == p.second);
+}
+
+TEST(FlatHashTableTest, Reserve) {
+  flat_hash_table<int> ht;
+  ht.reserve(100);
+  auto buckets = ht.bucket_count();
+  for (int i = 0; i < 100; ++i)
+    ht.emplace_unique(i);
+  EXPECT_EQ(buckets, ht.bucket_count());
+
+  ht.rehash(1000);
+  EXPECT_EQ(1023, ht.bucket_count());
+  EXPECT_EQ(100, ht.size());
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(1, ht.count_unique(i));
+
+  // a lower limit holds at once, not from the next growth on
+  ht.max_load_factor(0.05f);
+  EXPECT_LE(ht.load_factor(), 0.05f);
+  for (int i = 100; i < 300; ++i) {
+    ht.emplace_unique(i);
+    EXPECT_LE(ht.load_factor(), 0.05f);
+  }
+  // and a higher one lets the table fill further
+  ht.max_load_factor(0.5f);
+  buckets = ht.bucket_count();
+  for (int i = 300; i < int(buckets / 2); ++i)
+    ht.emplace_unique(i);
+  EXPECT_EQ(buckets, ht.bucket_count());
+  for (int i = 0; i < int(buckets / 2); ++i)
+    EXPECT_EQ(1, ht.count_unique(i));
+  using iterator = flat_hash_table<int>::iterator;
+  static_assert(std::is_same<ptrdiff_t, iterator::difference_type>::value, "");
+}
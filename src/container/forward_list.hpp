@@ -342,12 +342,12 @@ forward_list<T, Alloc>::forward_list(const forward_list& x,
 // move
 template <class T, class Alloc>
 forward_list<T, Alloc>::forward_list(forward_list&& x)
-    : forward_list(move(x), allocator_type()) {}
+    : forward_list(move(x), x.alloc_) {}
 template <class T, class Alloc>
 forward_list<T, Alloc>::forward_list(forward_list&& x,
                                      const allocator_type& alloc)
     : joint_(x.joint_), alloc_(alloc) {
-  x.joint_ = new_node();
+  x.joint_ = x.new_node();
 }
 // forward_list
 template <class T, class Alloc>
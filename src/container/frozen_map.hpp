@@ -0,0 +1,451 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include "functional.hpp"
+#include "hash_table.hpp"
+#include "memory.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+
+namespace mrsuyi {
+// immutable map over a minimal perfect hash(PTHash-style)
+// keys are split into partitions by hash, which are built independently and
+// so in parallel. a partition spreads its keys over small buckets and keeps a
+// pilot per bucket, a number that sends every key of the bucket to a slot no
+// other key took:
+//   slot = (h ^ hash_int(pilot[bucket(h)])) % table_size
+// the slot table is 2% larger than the partition to keep pilots small, the
+// few keys landing past the end are redirected to the holes left in front.
+// a lookup is thus one probe into the values, stored contiguously
+template <class Key,
+          class T,
+          class Hash = hash<Key>,
+          class KeyEqual = equal_to<Key>,
+          class Allocator = allocator<pair<const Key, T>>>
+class frozen_map {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = pair<const Key, T>;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using allocator_type = Allocator;
+  using reference = const value_type&;
+  using const_reference = const value_type&;
+  using pointer = const value_type*;
+  using const_pointer = const value_type*;
+  using iterator = const value_type*;
+  using const_iterator = const value_type*;
+
+ public:
+  // ctor & dtor
+  frozen_map();
+  // build from [first, last), the first of equal keys wins. partitions are
+  // built by [threads] threads, 0 counts as 1. an exception thrown by [Hash]
+  // or [KeyEqual] on any of them is rethrown here
+  template <class InputIt>
+  frozen_map(InputIt first,
+             InputIt last,
+             size_t threads = 1,
+             const Hash& = Hash(),
+             const KeyEqual& = KeyEqual(),
+             const Allocator& = Allocator());
+  // snapshot of [ht]
+  template <class V, class H2, class X2, class Q2, class A2, class P2, bool C2>
+  explicit frozen_map(const hash_table<V, Key, H2, X2, Q2, A2, P2, C2>& ht,
+                      size_t threads = 1);
+
+  Allocator get_allocator() const;
+
+  // iterators, in slot order
+  const_iterator begin() const noexcept;
+  const_iterator end() const noexcept;
+  const_iterator cbegin() const noexcept;
+  const_iterator cend() const noexcept;
+
+  // capacity
+  bool empty() const noexcept;
+  size_t size() const noexcept;
+
+  // lookup
+  const_iterator find(const Key& key) const;
+  size_t count(const Key& key) const;
+  const T& at(const Key& key) const;
+
+  // observers
+  Hash hash_function() const;
+  KeyEqual key_eq() const;
+
+ protected:
+  struct partition {
+    // first value of the partition in [values_]
+    size_t offset;
+    size_t size;
+    size_t table_size;
+    size_t buckets;
+    size_t pilot_begin;
+    size_t remap_begin;
+  };
+  // what building one partition yields
+  struct partition_build {
+    size_t table_size;
+    size_t buckets;
+    vector<uint32_t> pilots;
+    // slot in front for every slot past the end
+    vector<uint32_t> remap;
+    // index of the item at every slot
+    vector<size_t> items;
+  };
+
+  // seeded hash of [key]
+  uint64_t key_hash(const Key& key) const;
+  // the high half of [h] picks the partition, the low half the bucket
+  static size_t partition_of(uint64_t h, size_t count);
+  static size_t bucket_of(uint64_t h, size_t count);
+  static size_t slot_of(uint64_t h, uint64_t pilot_hash, size_t table_size);
+  // run [fn](i) for every i in [0, n) on [threads] threads
+  template <class F>
+  static void run_parallel(size_t n, size_t threads, F fn);
+  // fill the map from [items], reseeding until every partition builds
+  void build(vector<value_type, Allocator>& items, size_t threads);
+  // build the partition of the [n] items listed at [idx], false if two
+  // different keys share a hash
+  bool build_partition(const vector<value_type, Allocator>& items,
+                       const uint64_t* hashes,
+                       const size_t* idx,
+                       size_t n,
+                       partition_build& res) const;
+
+  // average keys per partition and per bucket
+  static const size_t partition_keys = 1 << 16;
+  static const size_t bucket_keys = 4;
+  // a bucket with no pilot below this fails the build
+  static const uint32_t max_pilot = 1 << 24;
+  // seeds tried before giving up
+  static const size_t max_seeds = 16;
+
+ protected:
+  Hash hash_;
+  KeyEqual key_equal_;
+  uint64_t seed_;
+
+  vector<value_type, Allocator> values_;
+  vector<partition> parts_;
+  vector<uint32_t> pilots_;
+  vector<uint32_t> remap_;
+};
+
+//=================================== basic ==================================//
+template <class K, class T, class H, class Q, class A>
+frozen_map<K, T, H, Q, A>::frozen_map() : seed_(0) {}
+template <class K, class T, class H, class Q, class A>
+template <class InputIt>
+frozen_map<K, T, H, Q, A>::frozen_map(InputIt first,
+                                      InputIt last,
+                                      size_t threads,
+                                      const H& hash,
+                                      const Q& key_equal,
+                                      const A& alloc)
+    : hash_(hash), key_equal_(key_equal), seed_(0), values_(alloc) {
+  vector<value_type, A> items(alloc);
+  for (; first != last; ++first)
+    items.push_back(*first);
+  build(items, threads);
+}
+template <class K, class T, class H, class Q, class A>
+template <class V, class H2, class X2, class Q2, class A2, class P2, bool C2>
+frozen_map<K, T, H, Q, A>::frozen_map(
+    const hash_table<V, K, H2, X2, Q2, A2, P2, C2>& ht,
+    size_t threads)
+    : frozen_map(ht.begin(), ht.end(), threads) {}
+// allocator
+template <class K, class T, class H, class Q, class A>
+A frozen_map<K, T, H, Q, A>::get_allocator() const {
+  return values_.get_allocator();
+}
+
+//================================= iterators ================================//
+template <class K, class T, class H, class Q, class A>
+typename frozen_map<K, T, H, Q, A>::const_iterator
+frozen_map<K, T, H, Q, A>::begin() const noexcept {
+  return values_.data();
+}
+template <class K, class T, class H, class Q, class A>
+typename frozen_map<K, T, H, Q, A>::const_iterator
+frozen_map<K, T, H, Q, A>::end() const noexcept {
+  return values_.data() + values_.size();
+}
+template <class K, class T, class H, class Q, class A>
+typename frozen_map<K, T, H, Q, A>::const_iterator
+frozen_map<K, T, H, Q, A>::cbegin() const noexcept {
+  return begin();
+}
+template <class K, class T, class H, class Q, class A>
+typename frozen_map<K, T, H, Q, A>::const_iterator
+frozen_map<K, T, H, Q, A>::cend() const noexcept {
+  return end();
+}
+
+//================================= capacity =================================//
+template <class K, class T, class H, class Q, class A>
+bool frozen_map<K, T, H, Q, A>::empty() const noexcept {
+  return values_.empty();
+}
+template <class K, class T, class H, class Q, class A>
+size_t frozen_map<K, T, H, Q, A>::size() const noexcept {
+  return values_.size();
+}
+
+//================================== lookup ==================================//
+template <class K, class T, class H, class Q, class A>
+typename frozen_map<K, T, H, Q, A>::const_iterator
+frozen_map<K, T, H, Q, A>::find(const K& key) const {
+  if (values_.empty())
+    return end();
+  uint64_t h = key_hash(key);
+  const partition& part = parts_[partition_of(h, parts_.size())];
+  if (!part.size)
+    return end();
+  uint32_t pilot = pilots_[part.pilot_begin + bucket_of(h, part.buckets)];
+  size_t slot = slot_of(h, hash_int(pilot), part.table_size);
+  if (slot >= part.size)
+    slot = remap_[part.remap_begin + slot - part.size];
+  const value_type* res = values_.data() + part.offset + slot;
+  return key_equal_(res->first, key) ? res : end();
+}
+template <class K, class T, class H, class Q, class A>
+size_t frozen_map<K, T, H, Q, A>::count(const K& key) const {
+  return find(key) != end();
+}
+template <class K, class T, class H, class Q, class A>
+const T& frozen_map<K, T, H, Q, A>::at(const K& key) const {
+  auto it = find(key);
+  if (it == end())
+    throw std::out_of_range("out of range");
+  return it->second;
+}
+
+//================================= observers ================================//
+template <class K, class T, class H, class Q, class A>
+H frozen_map<K, T, H, Q, A>::hash_function() const {
+  return hash_;
+}
+template <class K, class T, class H, class Q, class A>
+Q frozen_map<K, T, H, Q, A>::key_eq() const {
+  return key_equal_;
+}
+
+//================================= protected ================================//
+template <class K, class T, class H, class Q, class A>
+uint64_t frozen_map<K, T, H, Q, A>::key_hash(const K& key) const {
+  return hash_int(uint64_t(hash_(key)) ^ seed_);
+}
+template <class K, class T, class H, class Q, class A>
+size_t frozen_map<K, T, H, Q, A>::partition_of(uint64_t h, size_t count) {
+  return ((h >> 32) * count) >> 32;
+}
+template <class K, class T, class H, class Q, class A>
+size_t frozen_map<K, T, H, Q, A>::bucket_of(uint64_t h, size_t count) {
+  return ((h & 0xffffffffull) * count) >> 32;
+}
+template <class K, class T, class H, class Q, class A>
+size_t frozen_map<K, T, H, Q, A>::slot_of(uint64_t h,
+                                          uint64_t pilot_hash,
+                                          size_t table_size) {
+  return (h ^ pilot_hash) % table_size;
+}
+template <class K, class T, class H, class Q, class A>
+template <class F>
+void frozen_map<K, T, H, Q, A>::run_parallel(size_t n,
+                                             size_t threads,
+                                             F fn) {
+  std::atomic<size_t> next(0);
+  // the first exception stops every thread & is rethrown here
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+  auto work = [&] {
+    try {
+      for (size_t i; (i = next++) < n;)
+        fn(i);
+    } catch (...) {
+      if (!failed.exchange(true))
+        error = std::current_exception();
+      next = n;
+    }
+  };
+  threads = max(size_t(1), min(threads, n));
+  std::thread* pool = new std::thread[threads - 1];
+  for (size_t t = 0; t + 1 < threads; ++t)
+    pool[t] = std::thread(work);
+  work();
+  for (size_t t = 0; t + 1 < threads; ++t)
+    pool[t].join();
+  delete[] pool;
+  if (error)
+    std::rethrow_exception(error);
+}
+template <class K, class T, class H, class Q, class A>
+void frozen_map<K, T, H, Q, A>::build(vector<value_type, A>& items,
+                                      size_t threads) {
+  size_t n = items.size();
+  if (!n)
+    return;
+  threads = max(threads, size_t(1));
+  size_t part_count = n / partition_keys + 1;
+  size_t chunk = n / (threads * 4) + 1024;
+  vector<uint64_t> hashes(n);
+  vector<size_t> idx(n);
+  vector<partition_build> builds(part_count);
+  for (size_t tries = 0;; ++tries, seed_ = hash_int(seed_ + 1)) {
+    // only keys whose [Hash] collides fail this often
+    if (tries == max_seeds)
+      throw std::invalid_argument("keys share a hash");
+    run_parallel((n + chunk - 1) / chunk, threads, [&](size_t c) {
+      for (size_t i = c * chunk; i < min(n, c * chunk + chunk); ++i)
+        hashes[i] = key_hash(items[i].first);
+    });
+    // group the items by partition, keeping their order
+    vector<size_t> starts(part_count + 1, 0);
+    for (size_t i = 0; i < n; ++i)
+      ++starts[partition_of(hashes[i], part_count) + 1];
+    for (size_t p = 0; p < part_count; ++p)
+      starts[p + 1] += starts[p];
+    vector<size_t> fill(starts);
+    for (size_t i = 0; i < n; ++i)
+      idx[fill[partition_of(hashes[i], part_count)]++] = i;
+
+    std::atomic<bool> ok(true);
+    run_parallel(part_count, threads, [&](size_t p) {
+      if (ok && !build_partition(items, hashes.data(), idx.data() + starts[p],
+                                 starts[p + 1] - starts[p], builds[p]))
+        ok = false;
+    });
+    if (ok)
+      break;
+  }
+
+  size_t total = 0;
+  for (size_t p = 0; p < part_count; ++p)
+    total += builds[p].items.size();
+  values_.reserve(total);
+  for (size_t p = 0; p < part_count; ++p) {
+    partition_build& b = builds[p];
+    parts_.push_back({values_.size(), b.items.size(), b.table_size, b.buckets,
+                      pilots_.size(), remap_.size()});
+    for (size_t i = 0; i < b.pilots.size(); ++i)
+      pilots_.push_back(b.pilots[i]);
+    for (size_t i = 0; i < b.remap.size(); ++i)
+      remap_.push_back(b.remap[i]);
+    for (size_t i = 0; i < b.items.size(); ++i)
+      values_.push_back(mrsuyi::move(items[b.items[i]]));
+  }
+}
+template <class K, class T, class H, class Q, class A>
+bool frozen_map<K, T, H, Q, A>::build_partition(
+    const vector<value_type, A>& items,
+    const uint64_t* hashes,
+    const size_t* idx,
+    size_t n,
+    partition_build& res) const {
+  const size_t none = size_t(-1);
+  size_t buckets = n / bucket_keys + 1;
+  size_t table_size = n + n / 50 + 1;
+
+  // bucket members, in input order
+  vector<size_t> starts(buckets + 1, 0), members(n);
+  for (size_t k = 0; k < n; ++k)
+    ++starts[bucket_of(hashes[idx[k]], buckets) + 1];
+  for (size_t b = 0; b < buckets; ++b)
+    starts[b + 1] += starts[b];
+  vector<size_t> fill(starts);
+  for (size_t k = 0; k < n; ++k)
+    members[fill[bucket_of(hashes[idx[k]], buckets)]++] = idx[k];
+
+  // equal keys share a hash & a bucket, only the first one is kept
+  vector<size_t> sizes(buckets, 0);
+  size_t largest = 0;
+  for (size_t b = 0; b < buckets; ++b) {
+    size_t kept = starts[b];
+    for (size_t m = starts[b]; m < starts[b + 1]; ++m) {
+      size_t item = members[m];
+      bool repeated = false;
+      for (size_t j = starts[b]; j < kept && !repeated; ++j) {
+        if (hashes[members[j]] != hashes[item])
+          continue;
+        if (!key_equal_(items[members[j]].first, items[item].first))
+          return false;
+        repeated = true;
+      }
+      if (!repeated)
+        members[kept++] = item;
+    }
+    sizes[b] = kept - starts[b];
+    largest = max(largest, sizes[b]);
+  }
+
+  // place the largest buckets first, while most slots are free
+  vector<size_t> by_size(largest + 2, 0), order(buckets);
+  for (size_t b = 0; b < buckets; ++b)
+    ++by_size[largest - sizes[b] + 1];
+  for (size_t s = 0; s <= largest; ++s)
+    by_size[s + 1] += by_size[s];
+  for (size_t b = 0; b < buckets; ++b)
+    order[by_size[largest - sizes[b]]++] = b;
+
+  vector<uint64_t> taken(table_size / 64 + 1, 0);
+  vector<size_t> slot_items(table_size, none);
+  vector<size_t> slots(largest + 1);
+  res.pilots = vector<uint32_t>(buckets, 0);
+  size_t size = 0;
+  for (size_t o = 0; o < buckets && sizes[order[o]]; ++o) {
+    size_t b = order[o];
+    for (uint32_t pilot = 0;; ++pilot) {
+      if (pilot == max_pilot)
+        return false;
+      uint64_t pilot_hash = hash_int(pilot);
+      bool fits = true;
+      for (size_t k = 0; k < sizes[b] && fits; ++k) {
+        size_t s = slot_of(hashes[members[starts[b] + k]], pilot_hash,
+                           table_size);
+        fits = !(taken[s / 64] >> (s % 64) & 1);
+        for (size_t j = 0; j < k && fits; ++j)
+          fits = slots[j] != s;
+        slots[k] = s;
+      }
+      if (!fits)
+        continue;
+      for (size_t k = 0; k < sizes[b]; ++k) {
+        taken[slots[k] / 64] |= uint64_t(1) << (slots[k] % 64);
+        slot_items[slots[k]] = members[starts[b] + k];
+      }
+      res.pilots[b] = pilot;
+      size += sizes[b];
+      break;
+    }
+  }
+
+  // move the items past [size] into the holes in front
+  res.table_size = table_size;
+  res.buckets = buckets;
+  res.remap = vector<uint32_t>(table_size - size, 0);
+  res.items = vector<size_t>(size);
+  for (size_t s = 0; s < size; ++s)
+    res.items[s] = slot_items[s];
+  size_t hole = 0;
+  for (size_t s = size; s < table_size; ++s) {
+    if (slot_items[s] == none)
+      continue;
+    while (slot_items[hole] != none)
+      ++hole;
+    res.remap[s - size] = hole;
+    res.items[hole++] = slot_items[s];
+  }
+  return true;
+}
+}  // namespace mrsuyi
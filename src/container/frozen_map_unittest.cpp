@@ -0,0 +1,84 @@
+#include <stdexcept>
+#include <vector>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "frozen_map.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(FrozenMapTest, Basic) {
+  frozen_map<int, int> empty;
+  assert(empty.empty());
+  EXPECT_EQ(empty.end(), empty.find(1));
+  EXPECT_EQ(0, empty.count(1));
+
+  std::vector<pair<const int, int>> items = {
+      {1, 10}, {2, 20}, {3, 30}, {1, 11}};
+  frozen_map<int, int> m(items.begin(), items.end());
+  EXPECT_EQ(3, m.size());
+  // the first of equal keys wins
+  EXPECT_EQ(10, m.at(1));
+  EXPECT_EQ(20, m.at(2));
+  EXPECT_EQ(30, m.find(3)->second);
+  EXPECT_EQ(m.end(), m.find(4));
+  EXPECT_EQ(0, m.count(4));
+  EXPECT_THROW(m.at(4), std::out_of_range);
+
+  int sum = 0;
+  for (auto& p : m)
+    sum += p.second;
+  EXPECT_EQ(60, sum);
+}
+
+TEST(FrozenMapTest, HashTable) {
+  hash_table<pair<const long, int>, long, hash<long>,
+             select1st<pair<const long, int>>>
+      ht;
+  for (int i = 0; i < 1000; ++i)
+    ht.emplace_unique(long(i) << 32, i);
+  frozen_map<long, int> m(ht);
+  EXPECT_EQ(1000, m.size());
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(i, m.at(long(i) << 32));
+  EXPECT_EQ(0, m.count(1000));
+}
+
+TEST(FrozenMapTest, Parallel) {
+  // several partitions, built by several threads
+  std::vector<pair<const int, int>> items;
+  const int n = 300000;
+  for (int i = 0; i < n; ++i)
+    items.emplace_back(i * 7, i);
+  frozen_map<int, int> m(items.begin(), items.end(), 4);
+  EXPECT_EQ(n, m.size());
+  for (int i = 0; i < n; ++i) {
+    auto it = m.find(i * 7);
+    assert(it != m.end());
+    EXPECT_EQ(i, it->second);
+    EXPECT_EQ(m.end(), m.find(i * 7 + 1));
+  }
+}
+
+struct throwing_hash {
+  size_t operator()(int key) const {
+    if (key == 4242)
+      throw std::runtime_error("unhashable");
+    return hash<int>()(key);
+  }
+};
+
+TEST(FrozenMapTest, ParallelErrors) {
+  std::vector<pair<const int, int>> items;
+  for (int i = 0; i < 100000; ++i)
+    items.emplace_back(i, i);
+  // no threads means the calling one
+  frozen_map<int, int> m(items.begin(), items.end(), 0);
+  EXPECT_EQ(100000, m.size());
+  EXPECT_EQ(4242, m.at(4242));
+  // what a worker throws reaches the caller
+  using throwing_map = frozen_map<int, int, throwing_hash>;
+  EXPECT_THROW(throwing_map(items.begin(), items.end(), 4),
+               std::runtime_error);
+}
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <initializer_list>
+#include <new>
 #include "algorithm.hpp"
+#include "bloom_filter.hpp"
 #include "functional.hpp"
 #include "memory.hpp"
 #include "vector.hpp"
@@ -73,25 +77,217 @@ static const std::size_t prime_nums[] = {
     /* 61    */ (std::size_t)18446744073709551557ull,
 };
 
+// bucket policies decide the legal bucket counts and how a hash is reduced
+// onto them
+// prime bucket counts, reduced by modulo
+struct prime_bucket_policy {
+  // smallest legal bucket count >= [n]
+  static size_t bucket_count(size_t n) {
+    return *lower_bound(prime_nums, prime_nums + 61, n);
+  }
+  static size_t max_bucket_count() { return prime_nums[61]; }
+  static size_t index(size_t hash, size_t bucket_count) {
+    return hash % bucket_count;
+  }
+};
+// power-of-two bucket counts, reduced by a mask
+// weak hashes(e.g. one returning the integer itself) would leave most
+// buckets empty if only the low bits were used, so the hash is mixed first
+struct pow2_bucket_policy {
+  static size_t bucket_count(size_t n) {
+    size_t count = 2;
+    for (; count < n; count *= 2)
+      ;
+    return count;
+  }
+  static size_t max_bucket_count() {
+    return size_t(1) << (sizeof(size_t) * 8 - 1);
+  }
+};
+// multiply by 2^64/phi and keep the high bits
+struct fibonacci_bucket_policy : pow2_bucket_policy {
+  static size_t index(size_t hash, size_t bucket_count) {
+    return (hash * size_t(0x9E3779B97F4A7C15ull)) >>
+           (sizeof(size_t) * 8 - __builtin_ctzll(bucket_count));
+  }
+};
+// fold the high bits down with xor-shifts(murmur3 finalizer)
+struct xorshift_bucket_policy : pow2_bucket_policy {
+  static size_t index(size_t hash, size_t bucket_count) {
+    hash ^= hash >> 33;
+    hash *= size_t(0xff51afd7ed558ccdull);
+    hash ^= hash >> 33;
+    return hash & (bucket_count - 1);
+  }
+};
+
+// full hash of the key, stored in hash_table nodes when CacheHash is set
+// rehash and iteration then never call Hash, and KeyEqual is skipped when the
+// hashes differ
+template <bool CacheHash>
+struct hash_node_code {
+  void set(size_t) {}
+  bool match(size_t) const { return true; }
+};
+template <>
+struct hash_node_code<true> {
+  void set(size_t c) { code = c; }
+  bool match(size_t c) const { return code == c; }
+
+  size_t code;
+};
+
+// whether hash_table nodes cache the hash unless told otherwise. a chain is
+// walked until a node hashes to another bucket, which without the cache means
+// hashing the key of every node probed. that is cheap for numbers only, any
+// other key(strings, C strings, aggregates) pays 8 bytes a node instead, much
+// like libstdc++'s __cache_default
+template <class Key>
+struct hash_cache_default
+    : std::integral_constant<bool,
+                             !std::is_arithmetic<Key>::value &&
+                                 !std::is_enum<Key>::value> {};
+
+// snapshot of how well a hash_table spreads its keys
+struct hash_table_stats {
+  size_t size;
+  // buckets of both arrays during an incremental rehash
+  size_t bucket_count;
+  size_t empty_buckets;
+  float empty_ratio;
+  size_t max_chain;
+  // [i] is the number of buckets holding i nodes
+  vector<size_t> chain_histogram;
+  // comparisons a lookup needs on average given the chain lengths, for a
+  // present key and for an absent one
+  double expected_hit_comparisons;
+  double expected_miss_comparisons;
+
+  // measured, all zero unless MRSUYI_HASH_TABLE_STATS is defined
+  size_t hits;
+  size_t misses;
+  double avg_hit_comparisons;
+  double avg_miss_comparisons;
+  size_t rehash_count;
+  double rehash_seconds;
+};
+
+// lookup & rehash counters of a hash_table, compiled in by defining
+// MRSUYI_HASH_TABLE_STATS and empty otherwise
+// lookups count through const members, so the counters are relaxed atomics:
+// concurrent readers of one table(as under concurrent_hash_map's shared
+// locks) may bump them together
+#ifdef MRSUYI_HASH_TABLE_STATS
+static const bool hash_table_counting = true;
+#else
+static const bool hash_table_counting = false;
+#endif
+template <bool Enabled>
+struct hash_table_counters {
+  // times a rehash for as long as it lives
+  struct timer {
+    explicit timer(hash_table_counters&) {}
+  };
+
+  void probe(size_t, bool) {}
+  void rehashed() {}
+  void fill(hash_table_stats&) const {}
+};
+template <>
+struct hash_table_counters<true> {
+  struct timer {
+    explicit timer(hash_table_counters& c)
+        : counters(c), start(std::chrono::steady_clock::now()) {}
+    ~timer() {
+      counters.rehash_nanoseconds.fetch_add(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start)
+              .count(),
+          std::memory_order_relaxed);
+    }
+
+    hash_table_counters& counters;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  void probe(size_t comparisons, bool hit) {
+    if (hit) {
+      hits.fetch_add(1, std::memory_order_relaxed);
+      hit_comparisons.fetch_add(comparisons, std::memory_order_relaxed);
+    } else {
+      misses.fetch_add(1, std::memory_order_relaxed);
+      miss_comparisons.fetch_add(comparisons, std::memory_order_relaxed);
+    }
+  }
+  void rehashed() { rehash_count.fetch_add(1, std::memory_order_relaxed); }
+  void fill(hash_table_stats& st) const {
+    st.hits = hits.load(std::memory_order_relaxed);
+    st.misses = misses.load(std::memory_order_relaxed);
+    st.avg_hit_comparisons =
+        st.hits ? double(hit_comparisons.load(std::memory_order_relaxed)) /
+                      st.hits
+                : 0;
+    st.avg_miss_comparisons =
+        st.misses ? double(miss_comparisons.load(std::memory_order_relaxed)) /
+                        st.misses
+                  : 0;
+    st.rehash_count = rehash_count.load(std::memory_order_relaxed);
+    st.rehash_seconds =
+        rehash_nanoseconds.load(std::memory_order_relaxed) * 1e-9;
+  }
+
+  std::atomic<size_t> hits{0};
+  std::atomic<size_t> misses{0};
+  std::atomic<size_t> hit_comparisons{0};
+  std::atomic<size_t> miss_comparisons{0};
+  std::atomic<size_t> rehash_count{0};
+  std::atomic<size_t> rehash_nanoseconds{0};
+};
+
 template <class Value,
           class Key = Value,
           class Hash = hash<Key>,
           class ExtractKey = identity<Value>,
           class KeyEqual = equal_to<Key>,
-          class Allocator = allocator<Key>>
+          class Allocator = allocator<Key>,
+          class BucketPolicy = prime_bucket_policy,
+          bool CacheHash = hash_cache_default<Key>::value>
 class hash_table {
-  struct node {
+  // all nodes live in one singly-linked list, nodes of the same bucket are
+  // adjacent. a bucket points at the node before its first node, the first
+  // bucket in the list points at [before_begin_]
+  // during an incremental rehash the buckets of [old_buckets_] from
+  // [migrated_] on still hold their nodes, a node belongs to the old array
+  // if its old bucket is one of them and to [buckets_] otherwise
+  struct node_base {
+    node_base* nxt;
+
+    node_base() : nxt(nullptr) {}
+  };
+  struct node : node_base, hash_node_code<CacheHash> {
     Value val;
-    node* nxt;
 
     template <class... Args>
-    node(Args&&... args) : nxt(nullptr), val(forward<Args>(args)...) {}
+    node(Args&&... args) : val(mrsuyi::forward<Args>(args)...) {}
+    node* next() const { return static_cast<node*>(this->nxt); }
   };
 
-  template <class HashTable, class E>
+  template <class E>
   class iter;
   template <class E>
   class local_iter;
+  class node_handle;
+
+  // enables the heterogeneous overloads of lookup & erase for a [T] other
+  // than Key, which needs both Hash and KeyEqual to be transparent
+  template <class T>
+  using transparent_key = typename std::enable_if<
+      is_transparent<Hash>::value && is_transparent<KeyEqual>::value &&
+      !std::is_same<T, Key>::value>::type;
+  using counters_type = hash_table_counters<hash_table_counting>;
+  using node_allocator = typename Allocator::template other<node>;
+  using bucket_allocator = typename Allocator::template other<node_base*>;
+  using bucket_array = vector<node_base*, bucket_allocator>;
 
  public:
   using key_type = Key;
@@ -106,10 +302,11 @@ class hash_table {
   using pointer = value_type*;
   using const_pointer = const value_type*;
 
-  using iterator = iter<hash_table, Key>;
-  using const_iterator = iter<const hash_table, const Key>;
-  using local_iterator = local_iter<Key>;
-  using const_local_iterator = local_iter<const Key>;
+  using iterator = iter<Value>;
+  using const_iterator = iter<const Value>;
+  using local_iterator = local_iter<Value>;
+  using const_local_iterator = local_iter<const Value>;
+  using node_type = node_handle;
 
  public:
   // ctor & dtor
@@ -149,11 +346,35 @@ class hash_table {
   pair<iterator, bool> emplace_unique(Args... args);
   template <class... Args>
   pair<iterator, bool> emplace_equal(Args... args);
+  // insert every value of [first, last), values are hashed and their buckets
+  // prefetched a batch at a time before any is linked, returns the number of
+  // values inserted
+  template <class InputIt>
+  size_t insert_batch_unique(InputIt first, InputIt last);
+  template <class InputIt>
+  size_t insert_batch_equal(InputIt first, InputIt last);
 
   iterator erase(const_iterator pos);
   iterator erase(const_iterator first, const_iterator last);
   size_t erase_equal(const Key& key);
   size_t erase_unique(const Key& key);
+  template <class T, class = transparent_key<T>>
+  size_t erase_equal(const T& key);
+  template <class T, class = transparent_key<T>>
+  size_t erase_unique(const T& key);
+
+  // node handles, nodes move between tables without being reallocated as
+  // long as the allocators compare equal. otherwise their values move into
+  // nodes of the receiving table, so no node outlives the resource it came
+  // from or is freed through another
+  node_type extract(const_iterator pos);
+  node_type extract(const Key& key);
+  // link the node of [nh], it stays in [nh] if its key is present
+  pair<iterator, bool> insert_unique(node_type&& nh);
+  iterator insert_equal(node_type&& nh);
+  // move the nodes of [src] over, nodes whose key is present stay in [src]
+  void merge_unique(hash_table& src);
+  void merge_equal(hash_table& src);
 
   void swap(hash_table& other);
 
@@ -164,6 +385,27 @@ class hash_table {
   const_iterator find(const Key& key) const;
   pair<iterator, iterator> equal_range(const Key& key);
   pair<const_iterator, const_iterator> equal_range(const Key& key) const;
+  // heterogeneous lookup, [key] only has to be hashable by Hash and
+  // comparable with Key by KeyEqual, no Key is built
+  template <class T, class = transparent_key<T>>
+  size_t count_equal(const T& key) const;
+  template <class T, class = transparent_key<T>>
+  size_t count_unique(const T& key) const;
+  template <class T, class = transparent_key<T>>
+  iterator find(const T& key);
+  template <class T, class = transparent_key<T>>
+  const_iterator find(const T& key) const;
+  template <class T, class = transparent_key<T>>
+  pair<iterator, iterator> equal_range(const T& key);
+  template <class T, class = transparent_key<T>>
+  pair<const_iterator, const_iterator> equal_range(const T& key) const;
+  // find every key of [first, last), writing one iterator per key to [out]
+  // (end() if absent). keys are hashed, then bucket slots and chain heads are
+  // prefetched a batch at a time so that their cache misses overlap
+  template <class ForwardIt, class OutputIt>
+  OutputIt find_batch(ForwardIt first, ForwardIt last, OutputIt out);
+  template <class ForwardIt, class OutputIt>
+  OutputIt find_batch(ForwardIt first, ForwardIt last, OutputIt out) const;
 
   // bucket interface
   local_iterator begin(size_t n) noexcept;
@@ -184,22 +426,112 @@ class hash_table {
   void max_load_factor(float ml);
   void rehash(size_t count);
   void reserve(size_t count);
+  // off by default. when on, growing only allocates the new buckets and each
+  // insertion then migrates a few of the old ones, so no single insertion
+  // relinks the whole table. until the migration ends lookups go to whichever
+  // array holds the key and the bucket interface covers the new array only.
+  // turning it off finishes the migration
+  bool incremental_rehash() const;
+  void incremental_rehash(bool on);
+
+  // counting bloom filter in front of the buckets, off by default. once
+  // attached, a lookup of a hash it rules out skips its bucket chain. it
+  // follows every insertion & erasure and is rebuilt when the table grows
+  void attach_filter(double fp_rate = 0.01);
+  void detach_filter();
+  const counting_bloom_filter* filter() const;
+
+  // introspection, walks the whole table
+  hash_table_stats stats() const;
 
   // observers
   Hash hash_function() const;
   KeyEqual key_eq() const;
 
  protected:
+  // allocate & construct a node from [args]
+  template <class... Args>
+  node* new_node(Args&&... args);
+  // destroy & deallocate [n]
+  void del_node(node* n);
+  static void del_node(node* n, const Allocator& alloc);
+  // [count] empty buckets, none at all for 0
+  bucket_array new_buckets(size_t count = 0) const;
   // get first node
   node* first() const;
-  // get next node
-  node* next(size_t bucket_idx, node* n) const;
-  // clear all nodes in buckets
-  void clear_buckets();
+  // delete all nodes
+  void clear_nodes();
+  // find the node before the first node with [key] of hash [code] in bucket
+  // [slot], nullptr if absent
+  template <class T>
+  node_base* search_before(node_base** slot, const T& key, size_t code) const;
   // find node with key
-  node* search(const Key& key) const;
+  template <class T>
+  node* search(const T& key) const;
   // find range
-  pair<node*, node*> search_range(const Key& key) const;
+  template <class T>
+  pair<node*, node*> search_range(const T& key) const;
+  // number of nodes with [key]
+  template <class T>
+  size_t count_all(const T& key) const;
+  // erase all nodes with [key]
+  template <class T>
+  size_t erase_all(const T& key);
+  // erase the first node with [key]
+  template <class T>
+  size_t erase_first(const T& key);
+  // link [n] of hash [code] unless its key is present, returns the node
+  // holding the key and whether [n] got linked
+  pair<node*, bool> insert_unique_node(node* n, size_t code);
+  // link [n] of hash [code] next to the nodes of the same key
+  void insert_equal_node(node* n, size_t code);
+  // insert [first, last) in batches through [insert_node]
+  template <class InputIt, class F>
+  size_t insert_batch(InputIt first, InputIt last, F insert_node);
+  // look up [first, last) in batches, calling [f] with the node found for
+  // each key (nullptr if absent)
+  template <class ForwardIt, class F>
+  void search_batch(ForwardIt first, ForwardIt last, F f) const;
+  // prefetch the bucket slots [slots, slots + n), then the nodes before their
+  // chains, then the chain heads
+  void prefetch_chains(node_base** const* slots, size_t n) const;
+  // unlink [n] from the table without deleting it
+  void unlink_node(node* n);
+  // link [n] as the first node of bucket [slot]
+  void link_front(node_base** slot, node* n);
+  // unlink [n] following [prev] from bucket [slot]
+  void unlink(node_base** slot, node_base* prev, node* n);
+  // point the bucket of the first node back to [before_begin_]
+  void relink_before_begin();
+  // hash of the key in [n], taken from the node if cached
+  size_t node_code(const node* n) const;
+  size_t node_code(const node* n, std::true_type) const;
+  size_t node_code(const node* n, std::false_type) const;
+  // bucket index of [n]
+  size_t node_bucket(const node* n) const;
+  // bucket holding hash [code], in whichever array the hash belongs to
+  node_base** code_slot(size_t code) const;
+  // bucket holding [n]
+  node_base** node_slot(const node* n) const;
+  // whether an incremental rehash is in progress
+  bool migrating() const;
+  // move the nodes of the next [n] old buckets to the new array
+  void migrate(size_t n);
+  // whether [n] holds [key] of hash [code]
+  template <class T>
+  bool node_equal(const node* n, const T& key, size_t code) const;
+  // record a node of hash [code] joining or leaving the table in the filter
+  void filter_insert(size_t code);
+  void filter_erase(size_t code);
+  // refill the filter from scratch, sized for [capacity] keys
+  void fill_filter(size_t capacity, double fp_rate);
+
+  // keys looked up or inserted per batch
+  static const size_t batch_size = 16;
+  // old buckets migrated per insertion, enough to finish before the next
+  // growth as long as max_load_factor >= 0.25. otherwise what is left is
+  // migrated at once when growing again
+  static const size_t rehash_step = 4;
 
  protected:
   Hash hash_;
@@ -207,16 +539,24 @@ class hash_table {
   KeyEqual key_equal_;
   Allocator alloc_;
 
-  vector<node*> buckets_;
+  node_base before_begin_;
+  bucket_array buckets_;
   size_t node_count_;
   float max_load_factor_;
+  // incremental rehash
+  bucket_array old_buckets_;
+  size_t migrated_;
+  bool incremental_;
+  // nullptr unless attached
+  counting_bloom_filter* filter_;
+  mutable counters_type counters_;
 };
 
 //=================================== iter ===================================//
-template <class V, class K, class H, class Ex, class Kq, class A>
-template <class HashTable, class E>
-class hash_table<V, K, H, Ex, Kq, A>::iter {
-  friend class hash_table<V, K, H, Ex, Kq, A>;
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class E>
+class hash_table<V, K, H, X, Q, A, P, C>::iter {
+  friend class hash_table<V, K, H, X, Q, A, P, C>;
 
  public:
   using value_type = E;
@@ -225,11 +565,10 @@ class hash_table<V, K, H, Ex, Kq, A>::iter {
   using pointer = E*;
   using iterator_category = forward_iterator_tag;
 
-  iter() : ht_(nullptr), node_(nullptr) {}
-  iter(HashTable* ht, node* node) : ht_(ht), node_(node) {}
-  iter(const iter& it) : ht_(it.ht_), node_(it.node_) {}
+  iter() : node_(nullptr) {}
+  iter(node* node) : node_(node) {}
+  iter(const iter& it) : node_(it.node_) {}
   iter& operator=(const iter& it) {
-    ht_ = it.ht_;
     node_ = it.node_;
     return *this;
   }
@@ -238,14 +577,7 @@ class hash_table<V, K, H, Ex, Kq, A>::iter {
   bool operator==(const iter& it) { return node_ == it.node_; }
   bool operator!=(const iter& it) { return node_ != it.node_; }
   iter& operator++() {
-    node* old = node_;
-    node_ = node_->nxt;
-
-    if (!node_) {
-      size_t n = ht_->bucket(ht_->extract_key_(old->val));
-      while (!node_ && ++n < ht_->bucket_count())
-        node_ = ht_->buckets_[n];
-    }
+    node_ = node_->next();
     return *this;
   }
   iter operator++(int) {
@@ -253,475 +585,1120 @@ class hash_table<V, K, H, Ex, Kq, A>::iter {
     ++*this;
     return res;
   }
-  operator iter<const HashTable, const E>() const {
-    return iter<const HashTable, const E>(ht_, node_);
-  }
+  operator iter<const E>() const { return iter<const E>(node_); }
 
  protected:
-  HashTable* ht_;
   node* node_;
 };
 
-template <class V, class K, class H, class Ex, class Kq, class A>
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
 template <class E>
-class hash_table<V, K, H, Ex, Kq, A>::local_iter {
+class hash_table<V, K, H, X, Q, A, P, C>::local_iter {
  public:
   using value_type = E;
   using difference_type = size_t;
   using reference = E&;
   using pointer = E*;
-  using local_iterator_category = forward_iterator_tag;
+  using iterator_category = forward_iterator_tag;
 
-  local_iter() : node_(nullptr) {}
-  local_iter(node* node) : node_(node) {}
-  local_iter(const local_iter& it) : node_(it.node_) {}
-  local_iter& operator=(const local_iter& it) { node_ = it.node_; }
+  local_iter() : ht_(nullptr), node_(nullptr), bucket_(0) {}
+  local_iter(const hash_table* ht, node* node, size_t bucket)
+      : ht_(ht), node_(node), bucket_(bucket) {}
+  local_iter(const local_iter& it)
+      : ht_(it.ht_), node_(it.node_), bucket_(it.bucket_) {}
+  local_iter& operator=(const local_iter& it) {
+    ht_ = it.ht_;
+    node_ = it.node_;
+    bucket_ = it.bucket_;
+    return *this;
+  }
   E& operator*() const { return node_->val; }
   E* operator->() const { return &(node_->val); }
   bool operator==(const local_iter& it) { return node_ == it.node_; }
   bool operator!=(const local_iter& it) { return node_ != it.node_; }
-  local_iter& operator++() { node_ = node_->nxt; }
+  // the bucket ends where the list enters another bucket
+  local_iter& operator++() {
+    node_ = node_->next();
+    if (node_ && ht_->node_slot(node_) != ht_->buckets_.data() + bucket_)
+      node_ = nullptr;
+    return *this;
+  }
   local_iter operator++(int) {
     auto res = *this;
     ++*this;
     return res;
   }
-  operator local_iter<const E>() const { return local_iter<const E>(node_); }
+  operator local_iter<const E>() const {
+    return local_iter<const E>(ht_, node_, bucket_);
+  }
+
+ private:
+  const hash_table* ht_;
+  node* node_;
+  size_t bucket_;
+};
+
+//================================ node handle ===============================//
+// owns a node extracted from a hash_table along with a copy of its allocator,
+// deletes it unless it is inserted into another one
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+class hash_table<V, K, H, X, Q, A, P, C>::node_handle {
+  friend class hash_table<V, K, H, X, Q, A, P, C>;
+
+ public:
+  node_handle() : node_(nullptr) {}
+  node_handle(node_handle&& other) : node_(other.node_), alloc_(other.alloc_) {
+    other.node_ = nullptr;
+  }
+  node_handle(const node_handle&) = delete;
+  ~node_handle() {
+    if (node_)
+      del_node(node_, alloc_);
+  }
+
+  node_handle& operator=(node_handle&& other) {
+    if (this != &other) {
+      if (node_)
+        del_node(node_, alloc_);
+      node_ = other.node_;
+      alloc_ = other.alloc_;
+      other.node_ = nullptr;
+    }
+    return *this;
+  }
+  node_handle& operator=(const node_handle&) = delete;
+
+  bool empty() const noexcept { return !node_; }
+  explicit operator bool() const noexcept { return node_; }
+  V& value() const { return node_->val; }
+  void swap(node_handle& other) {
+    mrsuyi::swap(node_, other.node_);
+    mrsuyi::swap(alloc_, other.alloc_);
+  }
 
  private:
+  node_handle(node* n, const A& alloc) : node_(n), alloc_(alloc) {}
+
   node* node_;
+  A alloc_;
 };
 
 //================================= protected ================================//
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::node*
-hash_table<V, K, H, Ex, Kq, A>::first() const {
-  node* res = buckets_[0];
-  size_t n = 1;
-  for (; !res && n < bucket_count(); ++n)
-    res = buckets_[n];
-  return res;
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class... Args>
+typename hash_table<V, K, H, X, Q, A, P, C>::node*
+hash_table<V, K, H, X, Q, A, P, C>::new_node(Args&&... args) {
+  node_allocator alloc(alloc_);
+  node* n = alloc.allocate(1);
+  new (static_cast<void*>(n)) node(mrsuyi::forward<Args>(args)...);
+  return n;
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-void hash_table<V, K, H, Ex, Kq, A>::clear_buckets() {
-  for (size_t i = 0; i < buckets_.size(); ++i) {
-    node* cur = buckets_[i];
-    while (cur) {
-      node* tmp = cur;
-      cur = cur->nxt;
-      delete tmp;
-    }
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::del_node(node* n) {
+  del_node(n, alloc_);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::del_node(node* n, const A& alloc) {
+  node_allocator node_alloc(alloc);
+  mrsuyi::destroy_at(n);
+  node_alloc.deallocate(n, 1);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::bucket_array
+hash_table<V, K, H, X, Q, A, P, C>::new_buckets(size_t count) const {
+  bucket_allocator alloc(alloc_);
+  return count ? bucket_array(count, alloc) : bucket_array(alloc);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::node*
+hash_table<V, K, H, X, Q, A, P, C>::first() const {
+  return static_cast<node*>(before_begin_.nxt);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::clear_nodes() {
+  node* cur = first();
+  while (cur) {
+    node* tmp = cur;
+    cur = cur->next();
+    del_node(tmp);
   }
+  before_begin_.nxt = nullptr;
   node_count_ = 0;
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::node*
-hash_table<V, K, H, Ex, Kq, A>::search(const K& key) const {
-  node* cur = buckets_[bucket(key)];
-  while (cur && !key_equal_(extract_key_(cur->val), key))
-    cur = cur->nxt;
-  return cur;
-}
-template <class V, class K, class H, class Ex, class Kq, class A>
-pair<typename hash_table<V, K, H, Ex, Kq, A>::node*,
-     typename hash_table<V, K, H, Ex, Kq, A>::node*>
-hash_table<V, K, H, Ex, Kq, A>::search_range(const K& key) const {
-  auto bucket_idx = bucket(key);
-  node* bgn = buckets_[bucket_idx];
-  while (bgn && !key_equal_(extract_key_(bgn->val), key))
-    bgn = bgn->nxt;
-  if (!bgn)
-    return {bgn, nullptr};
-
-  node* end = bgn->nxt;
-  while (end && key_equal_(extract_key_(end->val), key))
-    end = end->nxt;
-  while (!end && ++bucket_idx < bucket_count())
-    end = buckets_[bucket_idx];
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T>
+typename hash_table<V, K, H, X, Q, A, P, C>::node_base*
+hash_table<V, K, H, X, Q, A, P, C>::search_before(node_base** slot,
+                                                  const T& key,
+                                                  size_t code) const {
+  // the filter goes first, its block is likelier cached than the bucket
+  node_base* prev = filter_ && !filter_->may_contain(code) ? nullptr : *slot;
+  if (!prev) {
+    counters_.probe(0, false);
+    return nullptr;
+  }
+  size_t comparisons = 0;
+  for (node* cur = static_cast<node*>(prev->nxt);;
+       prev = cur, cur = cur->next()) {
+    ++comparisons;
+    if (node_equal(cur, key, code)) {
+      counters_.probe(comparisons, true);
+      return prev;
+    }
+    if (!cur->nxt || node_slot(cur->next()) != slot) {
+      counters_.probe(comparisons, false);
+      return nullptr;
+    }
+  }
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T>
+typename hash_table<V, K, H, X, Q, A, P, C>::node*
+hash_table<V, K, H, X, Q, A, P, C>::search(const T& key) const {
+  size_t code = hash_(key);
+  node_base* prev = search_before(code_slot(code), key, code);
+  return prev ? static_cast<node*>(prev->nxt) : nullptr;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T>
+pair<typename hash_table<V, K, H, X, Q, A, P, C>::node*,
+     typename hash_table<V, K, H, X, Q, A, P, C>::node*>
+hash_table<V, K, H, X, Q, A, P, C>::search_range(const T& key) const {
+  size_t code = hash_(key);
+  node_base* prev = search_before(code_slot(code), key, code);
+  if (!prev)
+    return {nullptr, nullptr};
+
+  node* bgn = static_cast<node*>(prev->nxt);
+  node* end = bgn->next();
+  while (end && node_equal(end, key, code))
+    end = end->next();
   return {bgn, end};
 }
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T>
+size_t hash_table<V, K, H, X, Q, A, P, C>::count_all(const T& key) const {
+  auto p = search_range(key);
+  size_t res = 0;
+  for (node* cur = p.first; cur != p.second; cur = cur->next())
+    ++res;
+  return res;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T>
+size_t hash_table<V, K, H, X, Q, A, P, C>::erase_all(const T& key) {
+  size_t code = hash_(key);
+  node_base** slot = code_slot(code);
+  node_base* prev = search_before(slot, key, code);
+  size_t res = 0;
+  while (prev && prev->nxt && node_equal(static_cast<node*>(prev->nxt), key,
+                                         code)) {
+    node* cur = static_cast<node*>(prev->nxt);
+    unlink(slot, prev, cur);
+    filter_erase(code);
+    del_node(cur);
+    ++res;
+  }
+  node_count_ -= res;
+  return res;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T>
+size_t hash_table<V, K, H, X, Q, A, P, C>::erase_first(const T& key) {
+  size_t code = hash_(key);
+  node_base** slot = code_slot(code);
+  node_base* prev = search_before(slot, key, code);
+  if (!prev)
+    return 0;
+  node* cur = static_cast<node*>(prev->nxt);
+  unlink(slot, prev, cur);
+  filter_erase(code);
+  del_node(cur);
+  --node_count_;
+  return 1;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+pair<typename hash_table<V, K, H, X, Q, A, P, C>::node*, bool>
+hash_table<V, K, H, X, Q, A, P, C>::insert_unique_node(node* n, size_t code) {
+  n->set(code);
+  node_base** slot = code_slot(code);
+  if (node_base* prev = search_before(slot, extract_key_(n->val), code))
+    return {static_cast<node*>(prev->nxt), false};
+  link_front(slot, n);
+  filter_insert(code);
+  ++node_count_;
+  return {n, true};
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::insert_equal_node(node* n,
+                                                           size_t code) {
+  n->set(code);
+  node_base** slot = code_slot(code);
+  if (node_base* prev = search_before(slot, extract_key_(n->val), code)) {
+    // join the group of equal keys, the bucket stays where it is
+    n->nxt = prev->nxt;
+    prev->nxt = n;
+  } else {
+    link_front(slot, n);
+  }
+  filter_insert(code);
+  ++node_count_;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class InputIt, class F>
+size_t hash_table<V, K, H, X, Q, A, P, C>::insert_batch(InputIt first,
+                                                        InputIt last,
+                                                        F insert_node) {
+  node* nodes[batch_size];
+  size_t codes[batch_size];
+  node_base** slots[batch_size];
+  size_t res = 0;
+  while (first != last) {
+    size_t n = 0;
+    for (; n < batch_size && first != last; ++n, ++first) {
+      nodes[n] = new_node(*first);
+      codes[n] = hash_(extract_key_(nodes[n]->val));
+    }
+    // grow & migrate before picking the buckets, nothing moves in the middle
+    reserve(size() + n);
+    migrate(rehash_step);
+    for (size_t i = 0; i < n; ++i)
+      slots[i] = code_slot(codes[i]);
+    prefetch_chains(slots, n);
+    for (size_t i = 0; i < n; ++i) {
+      if (insert_node(nodes[i], codes[i]))
+        ++res;
+      else
+        del_node(nodes[i]);
+    }
+  }
+  return res;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class ForwardIt, class F>
+void hash_table<V, K, H, X, Q, A, P, C>::search_batch(ForwardIt first,
+                                                      ForwardIt last,
+                                                      F f) const {
+  ForwardIt keys[batch_size];
+  size_t codes[batch_size];
+  node_base** slots[batch_size];
+  while (first != last) {
+    size_t n = 0;
+    for (; n < batch_size && first != last; ++n, ++first) {
+      keys[n] = first;
+      codes[n] = hash_(*first);
+      slots[n] = code_slot(codes[n]);
+    }
+    prefetch_chains(slots, n);
+    for (size_t i = 0; i < n; ++i) {
+      node_base* prev = search_before(slots[i], *keys[i], codes[i]);
+      f(prev ? static_cast<node*>(prev->nxt) : nullptr);
+    }
+  }
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::prefetch_chains(
+    node_base** const* slots, size_t n) const {
+  // each pass only touches what the previous one prefetched, so the misses of
+  // a pass are all in flight at once
+  for (size_t i = 0; i < n; ++i)
+    __builtin_prefetch(slots[i]);
+  for (size_t i = 0; i < n; ++i)
+    if (*slots[i])
+      __builtin_prefetch(*slots[i]);
+  for (size_t i = 0; i < n; ++i)
+    if (*slots[i])
+      __builtin_prefetch((*slots[i])->nxt);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::unlink_node(node* n) {
+  node_base** slot = node_slot(n);
+  node_base* prev = *slot;
+  while (prev->nxt != n)
+    prev = prev->nxt;
+  unlink(slot, prev, n);
+  filter_erase(node_code(n));
+  n->nxt = nullptr;
+  --node_count_;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::link_front(node_base** slot,
+                                                    node* n) {
+  if (*slot) {
+    n->nxt = (*slot)->nxt;
+    (*slot)->nxt = n;
+  } else {
+    // empty bucket, its nodes go to the front of the list
+    n->nxt = before_begin_.nxt;
+    before_begin_.nxt = n;
+    if (n->nxt)
+      *node_slot(n->next()) = n;
+    *slot = &before_begin_;
+  }
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::unlink(node_base** slot,
+                                                node_base* prev,
+                                                node* n) {
+  node* nxt = n->next();
+  node_base** nxt_slot = nxt ? node_slot(nxt) : nullptr;
+  if (nxt_slot != slot) {
+    // [n] ends its bucket, the following bucket is now preceded by [prev]
+    if (nxt_slot)
+      *nxt_slot = prev;
+    // and the bucket is empty if [n] also headed it
+    if (*slot == prev)
+      *slot = nullptr;
+  }
+  prev->nxt = nxt;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::relink_before_begin() {
+  if (before_begin_.nxt)
+    *node_slot(first()) = &before_begin_;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::node_code(const node* n) const {
+  return node_code(n, std::integral_constant<bool, C>());
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::node_code(const node* n,
+                                                     std::true_type) const {
+  return n->code;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::node_code(const node* n,
+                                                     std::false_type) const {
+  return hash_(extract_key_(n->val));
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::node_bucket(const node* n) const {
+  return P::index(node_code(n), bucket_count());
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::node_base**
+hash_table<V, K, H, X, Q, A, P, C>::code_slot(size_t code) const {
+  // only written through by the non-const callers
+  if (migrating()) {
+    size_t old_idx = P::index(code, old_buckets_.size());
+    if (old_idx >= migrated_)
+      return const_cast<node_base**>(old_buckets_.data()) + old_idx;
+  }
+  return const_cast<node_base**>(buckets_.data()) +
+         P::index(code, bucket_count());
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::node_base**
+hash_table<V, K, H, X, Q, A, P, C>::node_slot(const node* n) const {
+  return code_slot(node_code(n));
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+bool hash_table<V, K, H, X, Q, A, P, C>::migrating() const {
+  return !old_buckets_.empty();
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::migrate(size_t n) {
+  if (!n || !migrating())
+    return;
+  typename counters_type::timer timer(counters_);
+  for (; n && migrating(); --n) {
+    node_base** slot = old_buckets_.data() + migrated_;
+    node_base* prev = *slot;
+    if (!prev) {
+      ++migrated_;
+    } else {
+      // cut the bucket out of the list while its nodes still count as old,
+      // the following bucket was preceded by its last node
+      node* bgn = static_cast<node*>(prev->nxt);
+      node* last = bgn;
+      while (last->nxt && node_slot(last->next()) == slot)
+        last = last->next();
+      node* nxt = last->next();
+      prev->nxt = nxt;
+      if (nxt)
+        *node_slot(nxt) = prev;
+      *slot = nullptr;
+      last->nxt = nullptr;
+      ++migrated_;
+      // from now on they belong to the new array
+      while (bgn) {
+        node* cur = bgn;
+        bgn = bgn->next();
+        link_front(code_slot(node_code(cur)), cur);
+      }
+    }
+    if (migrated_ == old_buckets_.size()) {
+      old_buckets_ = new_buckets();
+      migrated_ = 0;
+    }
+  }
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T>
+bool hash_table<V, K, H, X, Q, A, P, C>::node_equal(const node* n,
+                                                    const T& key,
+                                                    size_t code) const {
+  return n->match(code) && key_equal_(extract_key_(n->val), key);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::filter_insert(size_t code) {
+  if (filter_)
+    filter_->insert(code);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::filter_erase(size_t code) {
+  if (filter_)
+    filter_->erase(code);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::fill_filter(size_t capacity,
+                                                     double fp_rate) {
+  *filter_ = counting_bloom_filter(capacity, fp_rate);
+  for (node* cur = first(); cur; cur = cur->next())
+    filter_->insert(node_code(cur));
+}
 
 //=================================== basic ==================================//
 // ctor & dtor
 // default
-template <class V, class K, class H, class Ex, class Kq, class A>
-hash_table<V, K, H, Ex, Kq, A>::hash_table() : hash_table(prime_nums[0]) {}
-template <class V, class K, class H, class Ex, class Kq, class A>
-hash_table<V, K, H, Ex, Kq, A>::hash_table(size_t bucket_suggest,
-                                           const H& hash,
-                                           const Kq& key_equal,
-                                           const A& alloc)
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+hash_table<V, K, H, X, Q, A, P, C>::hash_table() : hash_table(prime_nums[0]) {}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+hash_table<V, K, H, X, Q, A, P, C>::hash_table(size_t bucket_suggest,
+                                               const H& hash,
+                                               const Q& key_equal,
+                                               const A& alloc)
     : hash_(hash),
-      extract_key_(Ex()),
+      extract_key_(X()),
       key_equal_(key_equal),
       alloc_(alloc),
-      buckets_(bucket_suggest),
+      buckets_(new_buckets(P::bucket_count(bucket_suggest))),
       node_count_(0),
-      max_load_factor_(1) {}
+      max_load_factor_(1),
+      migrated_(0),
+      incremental_(false),
+      filter_(nullptr) {}
 // copy
-template <class V, class K, class H, class Ex, class Kq, class A>
-hash_table<V, K, H, Ex, Kq, A>::hash_table(const hash_table& other)
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+hash_table<V, K, H, X, Q, A, P, C>::hash_table(const hash_table& other)
     : hash_(other.hash_),
-      extract_key_(Ex()),
+      extract_key_(X()),
       key_equal_(other.key_equal_),
-      alloc_(other.alloc_),
-      buckets_(other.bucket_count()),
+      alloc_(A()),
+      buckets_(new_buckets(other.bucket_count())),
       node_count_(other.node_count_),
-      max_load_factor_(other.max_load_factor_) {
-  for (size_t i = 0; i < bucket_count(); ++i) {
-    node** mount = buckets_.data() + i;
-    node* cur = other.buckets_[i];
-    while (cur) {
-      *mount = new node(cur->val);
-      cur = cur->nxt;
-      mount = &((*mount)->nxt);
-    }
+      max_load_factor_(other.max_load_factor_),
+      old_buckets_(new_buckets(other.old_buckets_.size())),
+      migrated_(other.migrated_),
+      incremental_(other.incremental_),
+      filter_(other.filter_ ? new counting_bloom_filter(*other.filter_)
+                            : nullptr) {
+  // same order & same arrays, so every bucket stays in one piece even in the
+  // middle of a migration
+  node_base* prev = &before_begin_;
+  for (node* cur = other.first(); cur; cur = cur->next()) {
+    node* n = new_node(cur->val);
+    n->set(other.node_code(cur));
+    prev->nxt = n;
+    node_base** slot = node_slot(n);
+    if (!*slot)
+      *slot = prev;
+    prev = n;
   }
 }
 // move
-template <class V, class K, class H, class Ex, class Kq, class A>
-hash_table<V, K, H, Ex, Kq, A>::hash_table(hash_table&& other)
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+hash_table<V, K, H, X, Q, A, P, C>::hash_table(hash_table&& other)
     : hash_(other.hash_),
-      extract_key_(Ex()),
+      extract_key_(X()),
       key_equal_(other.key_equal_),
       alloc_(other.alloc_),
       buckets_(move(other.buckets_)),
       node_count_(other.node_count_),
-      max_load_factor_(other.max_load_factor_) {
+      max_load_factor_(other.max_load_factor_),
+      old_buckets_(move(other.old_buckets_)),
+      migrated_(other.migrated_),
+      incremental_(other.incremental_),
+      filter_(other.filter_) {
+  before_begin_.nxt = other.before_begin_.nxt;
+  relink_before_begin();
+  other.before_begin_.nxt = nullptr;
+  other.filter_ = nullptr;
+  other.buckets_ = other.new_buckets(P::bucket_count(prime_nums[0]));
+  other.old_buckets_ = other.new_buckets();
+  other.migrated_ = 0;
   other.node_count_ = 0;
 }
 // dtor
-template <class V, class K, class H, class Ex, class Kq, class A>
-hash_table<V, K, H, Ex, Kq, A>::~hash_table() {
-  clear_buckets();
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+hash_table<V, K, H, X, Q, A, P, C>::~hash_table() {
+  clear_nodes();
+  delete filter_;
 }
 // = copy
-template <class V, class K, class H, class Ex, class Kq, class A>
-hash_table<V, K, H, Ex, Kq, A>& hash_table<V, K, H, Ex, Kq, A>::operator=(
-    const hash_table& other) {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+hash_table<V, K, H, X, Q, A, P, C>& hash_table<V, K, H, X, Q, A, P, C>::
+operator=(const hash_table& other) {
   hash_table(other).swap(*this);
   return *this;
 }
 // = move
-template <class V, class K, class H, class Ex, class Kq, class A>
-hash_table<V, K, H, Ex, Kq, A>& hash_table<V, K, H, Ex, Kq, A>::operator=(
-    hash_table&& other) {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+hash_table<V, K, H, X, Q, A, P, C>& hash_table<V, K, H, X, Q, A, P, C>::
+operator=(hash_table&& other) {
   hash_table(move(other)).swap(*this);
   return *this;
 }
+// allocator
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+A hash_table<V, K, H, X, Q, A, P, C>::get_allocator() const {
+  return alloc_;
+}
 
 //================================= iterators ================================//
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::iterator
-hash_table<V, K, H, Ex, Kq, A>::begin() noexcept {
-  return iterator(this, first());
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::iterator
+hash_table<V, K, H, X, Q, A, P, C>::begin() noexcept {
+  return iterator(first());
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::iterator
-hash_table<V, K, H, Ex, Kq, A>::end() noexcept {
-  return iterator(this, nullptr);
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::iterator
+hash_table<V, K, H, X, Q, A, P, C>::end() noexcept {
+  return iterator(nullptr);
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::const_iterator
-hash_table<V, K, H, Ex, Kq, A>::begin() const noexcept {
-  return const_iterator(this, first());
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::const_iterator
+hash_table<V, K, H, X, Q, A, P, C>::begin() const noexcept {
+  return const_iterator(first());
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::const_iterator
-hash_table<V, K, H, Ex, Kq, A>::end() const noexcept {
-  return const_iterator(this, nullptr);
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::const_iterator
+hash_table<V, K, H, X, Q, A, P, C>::end() const noexcept {
+  return const_iterator(nullptr);
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::const_iterator
-hash_table<V, K, H, Ex, Kq, A>::cbegin() const noexcept {
-  return const_iterator(this, first());
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::const_iterator
+hash_table<V, K, H, X, Q, A, P, C>::cbegin() const noexcept {
+  return const_iterator(first());
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::const_iterator
-hash_table<V, K, H, Ex, Kq, A>::cend() const noexcept {
-  return const_iterator(this, nullptr);
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::const_iterator
+hash_table<V, K, H, X, Q, A, P, C>::cend() const noexcept {
+  return const_iterator(nullptr);
 }
 
 //================================= capacity =================================//
-template <class V, class K, class H, class Ex, class Kq, class A>
-bool hash_table<V, K, H, Ex, Kq, A>::empty() const noexcept {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+bool hash_table<V, K, H, X, Q, A, P, C>::empty() const noexcept {
   return size() == 0;
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-size_t hash_table<V, K, H, Ex, Kq, A>::size() const noexcept {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::size() const noexcept {
   return node_count_;
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-size_t hash_table<V, K, H, Ex, Kq, A>::max_size() const noexcept {
-  return prime_nums[61];
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::max_size() const noexcept {
+  return P::max_bucket_count();
 }
 
 //================================= modifiers ================================//
 // clear
-template <class V, class K, class H, class Ex, class Kq, class A>
-void hash_table<V, K, H, Ex, Kq, A>::clear() {
-  clear_buckets();
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::clear() {
+  clear_nodes();
   buckets_.assign(buckets_.size(), nullptr);
+  old_buckets_ = new_buckets();
+  migrated_ = 0;
+  if (filter_)
+    filter_->clear();
 }
 // emplace
-template <class V, class K, class H, class Ex, class Kq, class A>
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
 template <class... Args>
-pair<typename hash_table<V, K, H, Ex, Kq, A>::iterator, bool>
-hash_table<V, K, H, Ex, Kq, A>::emplace_unique(Args... args) {
+pair<typename hash_table<V, K, H, X, Q, A, P, C>::iterator, bool>
+hash_table<V, K, H, X, Q, A, P, C>::emplace_unique(Args... args) {
   reserve(size() + 1);
-  node* res = new node(forward<Args>(args)...);
-  size_t n = bucket(extract_key_(res->val));
-  for (node* cur = buckets_[n]; cur; ++cur)
-    if (key_equal_(extract_key_(res->val), extract_key_(cur->val))) {
-      delete res;
-      return {iterator(this, cur), false};
-    }
-  res->nxt = buckets_[n];
-  buckets_[n] = res;
-  ++node_count_;
-  return {iterator(this, res), true};
+  migrate(rehash_step);
+  node* res = new_node(mrsuyi::forward<Args>(args)...);
+  size_t code = hash_(extract_key_(res->val));
+  auto p = insert_unique_node(res, code);
+  if (!p.second)
+    del_node(res);
+  return {iterator(p.first), p.second};
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
 template <class... Args>
-pair<typename hash_table<V, K, H, Ex, Kq, A>::iterator, bool>
-hash_table<V, K, H, Ex, Kq, A>::emplace_equal(Args... args) {
+pair<typename hash_table<V, K, H, X, Q, A, P, C>::iterator, bool>
+hash_table<V, K, H, X, Q, A, P, C>::emplace_equal(Args... args) {
   reserve(size() + 1);
-  node* res = new node(forward<Args>(args)...);
-  size_t n = bucket(extract_key_(res->val));
-  for (node* cur = buckets_[n]; cur; ++cur) {
-    if (key_equal_(extract_key_(res->val), extract_key_(cur->val))) {
-      node* tmp = cur->nxt;
-      cur->nxt = res;
-      res->nxt = tmp;
-      ++node_count_;
-      return {iterator(this, cur), true};
-    }
-  }
-  res->nxt = buckets_[n];
-  buckets_[n] = res;
-  ++node_count_;
-  return {iterator(this, res), true};
+  migrate(rehash_step);
+  node* res = new_node(mrsuyi::forward<Args>(args)...);
+  size_t code = hash_(extract_key_(res->val));
+  insert_equal_node(res, code);
+  return {iterator(res), true};
+}
+// insert batch
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class InputIt>
+size_t hash_table<V, K, H, X, Q, A, P, C>::insert_batch_unique(InputIt first,
+                                                               InputIt last) {
+  return insert_batch(first, last, [this](node* n, size_t code) {
+    return insert_unique_node(n, code).second;
+  });
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class InputIt>
+size_t hash_table<V, K, H, X, Q, A, P, C>::insert_batch_equal(InputIt first,
+                                                              InputIt last) {
+  return insert_batch(first, last, [this](node* n, size_t code) {
+    insert_equal_node(n, code);
+    return true;
+  });
 }
 // erase
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::iterator
-hash_table<V, K, H, Ex, Kq, A>::erase(const_iterator pos) {
-  auto res = pos;
-  ++res;
-  auto bucket_idx = bucket(extract_key_(pos.node_->val));
-  node** mount = buckets_.data() + bucket_idx;
-  node* cur = buckets_[bucket_idx];
-  while (cur != pos.node_) {
-    mount = &(cur->nxt);
-    cur = cur->nxt;
-  }
-  *mount = pos.node_->nxt;
-  delete pos.node_;
-  --node_count_;
-  return iterator(this, res.node_);
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::iterator
+hash_table<V, K, H, X, Q, A, P, C>::erase(const_iterator pos) {
+  node* n = pos.node_;
+  node* res = n->next();
+  unlink_node(n);
+  del_node(n);
+  return iterator(res);
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::iterator
-hash_table<V, K, H, Ex, Kq, A>::erase(const_iterator first,
-                                      const_iterator last) {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::iterator
+hash_table<V, K, H, X, Q, A, P, C>::erase(const_iterator first,
+                                          const_iterator last) {
   for (; first != last; first = erase(first)) {
   }
-  return iterator(this, last.node_);
+  return iterator(last.node_);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::erase_equal(const K& key) {
+  return erase_all(key);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::erase_unique(const K& key) {
+  return erase_first(key);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T, class>
+size_t hash_table<V, K, H, X, Q, A, P, C>::erase_equal(const T& key) {
+  return erase_all(key);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T, class>
+size_t hash_table<V, K, H, X, Q, A, P, C>::erase_unique(const T& key) {
+  return erase_first(key);
+}
+// node handle
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::node_type
+hash_table<V, K, H, X, Q, A, P, C>::extract(const_iterator pos) {
+  unlink_node(pos.node_);
+  return node_type(pos.node_, alloc_);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::node_type
+hash_table<V, K, H, X, Q, A, P, C>::extract(const K& key) {
+  node* n = search(key);
+  return n ? extract(const_iterator(n)) : node_type();
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+pair<typename hash_table<V, K, H, X, Q, A, P, C>::iterator, bool>
+hash_table<V, K, H, X, Q, A, P, C>::insert_unique(node_type&& nh) {
+  if (nh.empty())
+    return {end(), false};
+  reserve(size() + 1);
+  migrate(rehash_step);
+  size_t code = hash_(extract_key_(nh.value()));
+  if (!(alloc_ == nh.alloc_)) {
+    // the node was allocated elsewhere, its value moves into one of ours
+    // unless the key is taken, in which case [nh] keeps it
+    if (node_base* prev =
+            search_before(code_slot(code), extract_key_(nh.value()), code))
+      return {iterator(static_cast<node*>(prev->nxt)), false};
+    node* n = new_node(mrsuyi::move(nh.value()));
+    nh = node_type();
+    return {iterator(insert_unique_node(n, code).first), true};
+  }
+  auto p = insert_unique_node(nh.node_, code);
+  if (p.second)
+    nh.node_ = nullptr;
+  return {iterator(p.first), p.second};
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-size_t hash_table<V, K, H, Ex, Kq, A>::erase_equal(const K& key) {
-  auto bucket_idx = bucket(key);
-  node** mount = buckets_.data() + bucket_idx;
-  node* cur = buckets_[bucket_idx];
-  while (cur && !key_equal_(extract_key_(cur->val), key)) {
-    mount = &(cur->nxt);
-    cur = cur->nxt;
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::iterator
+hash_table<V, K, H, X, Q, A, P, C>::insert_equal(node_type&& nh) {
+  if (nh.empty())
+    return end();
+  reserve(size() + 1);
+  migrate(rehash_step);
+  node* n = nh.node_;
+  if (!(alloc_ == nh.alloc_)) {
+    n = new_node(mrsuyi::move(n->val));
+    nh = node_type();
+  } else {
+    nh.node_ = nullptr;
   }
-  size_t res = 0;
-  while (cur && key_equal_(extract_key_(cur->val), key)) {
-    auto nxt = cur->nxt;
-    delete cur;
-    cur = nxt;
-    ++res;
+  insert_equal_node(n, hash_(extract_key_(n->val)));
+  return iterator(n);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::merge_unique(hash_table& src) {
+  if (&src == this)
+    return;
+  node_base* prev = &src.before_begin_;
+  while (node* n = static_cast<node*>(prev->nxt)) {
+    size_t code = hash_(extract_key_(n->val));
+    reserve(size() + 1);
+    migrate(rehash_step);
+    node_base** slot = code_slot(code);
+    if (search_before(slot, extract_key_(n->val), code)) {
+      prev = n;
+      continue;
+    }
+    // nodes only change hands between equal allocators. the source bucket
+    // is found first, once the value is moved out its key can't be hashed
+    node_base** src_slot = src.code_slot(code);
+    node* m = alloc_ == src.alloc_ ? n : new_node(mrsuyi::move(n->val));
+    src.unlink(src_slot, prev, n);
+    src.filter_erase(code);
+    --src.node_count_;
+    if (m != n)
+      src.del_node(n);
+    m->set(code);
+    link_front(slot, m);
+    filter_insert(code);
+    ++node_count_;
   }
-  *mount = cur;
-  node_count_ -= res;
-  return res;
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-size_t hash_table<V, K, H, Ex, Kq, A>::erase_unique(const K& key) {
-  auto bucket_idx = bucket(key);
-  node** mount = buckets_.data() + bucket_idx;
-  node* cur = buckets_[bucket_idx];
-  while (cur && !key_equal_(extract_key_(cur->val), key)) {
-    mount = &(cur->nxt);
-    cur = cur->nxt;
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::merge_equal(hash_table& src) {
+  if (&src == this)
+    return;
+  reserve(size() + src.size());
+  if (!(alloc_ == src.alloc_)) {
+    // nodes can't change hands, their values move into new ones
+    for (node* n = src.first(); n; n = n->next()) {
+      migrate(rehash_step);
+      node* m = new_node(mrsuyi::move(n->val));
+      insert_equal_node(m, hash_(extract_key_(m->val)));
+    }
+    src.clear();
+    return;
   }
-  if (cur) {
-    *mount = cur->nxt;
-    delete cur;
-    --node_count_;
+  node* n = src.first();
+  while (n) {
+    node* nxt = n->next();
+    migrate(rehash_step);
+    insert_equal_node(n, hash_(extract_key_(n->val)));
+    n = nxt;
   }
-  return 1;
+  // every node has moved, [src] only has to forget them
+  src.before_begin_.nxt = nullptr;
+  src.buckets_.assign(src.buckets_.size(), nullptr);
+  src.old_buckets_ = src.new_buckets();
+  src.migrated_ = 0;
+  src.node_count_ = 0;
+  if (src.filter_)
+    src.filter_->clear();
 }
 // swap
-template <class V, class K, class H, class Ex, class Kq, class A>
-void hash_table<V, K, H, Ex, Kq, A>::swap(hash_table& other) {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::swap(hash_table& other) {
   mrsuyi::swap(hash_, other.hash_);
   mrsuyi::swap(extract_key_, other.extract_key_);
   mrsuyi::swap(key_equal_, other.key_equal_);
   mrsuyi::swap(alloc_, other.alloc_);
+  mrsuyi::swap(before_begin_.nxt, other.before_begin_.nxt);
   mrsuyi::swap(buckets_, other.buckets_);
   mrsuyi::swap(node_count_, other.node_count_);
   mrsuyi::swap(max_load_factor_, other.max_load_factor_);
+  mrsuyi::swap(old_buckets_, other.old_buckets_);
+  mrsuyi::swap(migrated_, other.migrated_);
+  mrsuyi::swap(incremental_, other.incremental_);
+  mrsuyi::swap(filter_, other.filter_);
+  relink_before_begin();
+  other.relink_before_begin();
 }
 
 //================================== lookup ==================================//
 // count
-template <class V, class K, class H, class Ex, class Kq, class A>
-size_t hash_table<V, K, H, Ex, Kq, A>::count_equal(const K& key) const {
-  size_t res = 0;
-  node* cur = buckets_[bucket(key)];
-  while (cur && key_equal_(extract_key_(cur->val), key)) {
-    ++res;
-    cur = cur->nxt;
-  }
-  return res;
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::count_equal(const K& key) const {
+  return count_all(key);
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-size_t hash_table<V, K, H, Ex, Kq, A>::count_unique(const K& key) const {
-  node* cur = buckets_[bucket(key)];
-  while (cur) {
-    if (key_equal_(extract_key_(cur->val), key))
-      return 1;
-    else
-      cur = cur->nxt;
-  }
-  return 0;
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::count_unique(const K& key) const {
+  return search(key) != nullptr;
 }
 // find
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::iterator
-hash_table<V, K, H, Ex, Kq, A>::find(const K& key) {
-  return iterator(this, search(key));
-}
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::const_iterator
-hash_table<V, K, H, Ex, Kq, A>::find(const K& key) const {
-  return const_iterator(this, search(key));
-}
-template <class V, class K, class H, class Ex, class Kq, class A>
-pair<typename hash_table<V, K, H, Ex, Kq, A>::iterator,
-     typename hash_table<V, K, H, Ex, Kq, A>::iterator>
-hash_table<V, K, H, Ex, Kq, A>::equal_range(const K& key) {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::iterator
+hash_table<V, K, H, X, Q, A, P, C>::find(const K& key) {
+  return iterator(search(key));
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::const_iterator
+hash_table<V, K, H, X, Q, A, P, C>::find(const K& key) const {
+  return const_iterator(search(key));
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+pair<typename hash_table<V, K, H, X, Q, A, P, C>::iterator,
+     typename hash_table<V, K, H, X, Q, A, P, C>::iterator>
+hash_table<V, K, H, X, Q, A, P, C>::equal_range(const K& key) {
+  auto p = search_range(key);
+  return {iterator(p.first), iterator(p.second)};
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+pair<typename hash_table<V, K, H, X, Q, A, P, C>::const_iterator,
+     typename hash_table<V, K, H, X, Q, A, P, C>::const_iterator>
+hash_table<V, K, H, X, Q, A, P, C>::equal_range(const K& key) const {
   auto p = search_range(key);
-  return {iterator(this, p.first), iterator(this, p.second)};
+  return {const_iterator(p.first), const_iterator(p.second)};
+}
+// heterogeneous lookup
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T, class>
+size_t hash_table<V, K, H, X, Q, A, P, C>::count_equal(const T& key) const {
+  return count_all(key);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T, class>
+size_t hash_table<V, K, H, X, Q, A, P, C>::count_unique(const T& key) const {
+  return search(key) != nullptr;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T, class>
+typename hash_table<V, K, H, X, Q, A, P, C>::iterator
+hash_table<V, K, H, X, Q, A, P, C>::find(const T& key) {
+  return iterator(search(key));
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T, class>
+typename hash_table<V, K, H, X, Q, A, P, C>::const_iterator
+hash_table<V, K, H, X, Q, A, P, C>::find(const T& key) const {
+  return const_iterator(search(key));
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-pair<typename hash_table<V, K, H, Ex, Kq, A>::const_iterator,
-     typename hash_table<V, K, H, Ex, Kq, A>::const_iterator>
-hash_table<V, K, H, Ex, Kq, A>::equal_range(const K& key) const {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T, class>
+pair<typename hash_table<V, K, H, X, Q, A, P, C>::iterator,
+     typename hash_table<V, K, H, X, Q, A, P, C>::iterator>
+hash_table<V, K, H, X, Q, A, P, C>::equal_range(const T& key) {
   auto p = search_range(key);
-  return {const_iterator(this, p.first), const_iterator(this, p.second)};
+  return {iterator(p.first), iterator(p.second)};
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class T, class>
+pair<typename hash_table<V, K, H, X, Q, A, P, C>::const_iterator,
+     typename hash_table<V, K, H, X, Q, A, P, C>::const_iterator>
+hash_table<V, K, H, X, Q, A, P, C>::equal_range(const T& key) const {
+  auto p = search_range(key);
+  return {const_iterator(p.first), const_iterator(p.second)};
 }
 
+// find batch
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class ForwardIt, class OutputIt>
+OutputIt hash_table<V, K, H, X, Q, A, P, C>::find_batch(ForwardIt first,
+                                                        ForwardIt last,
+                                                        OutputIt out) {
+  search_batch(first, last, [&out](node* n) { *out++ = iterator(n); });
+  return out;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+template <class ForwardIt, class OutputIt>
+OutputIt hash_table<V, K, H, X, Q, A, P, C>::find_batch(ForwardIt first,
+                                                        ForwardIt last,
+                                                        OutputIt out) const {
+  search_batch(first, last, [&out](node* n) { *out++ = const_iterator(n); });
+  return out;
+}
 //============================== bucket interface ============================//
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::local_iterator
-hash_table<V, K, H, Ex, Kq, A>::begin(size_t n) noexcept {
-  return local_iterator(buckets_[n]);
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::local_iterator
+hash_table<V, K, H, X, Q, A, P, C>::begin(size_t n) noexcept {
+  return local_iterator(
+      this, buckets_[n] ? static_cast<node*>(buckets_[n]->nxt) : nullptr, n);
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::local_iterator
-hash_table<V, K, H, Ex, Kq, A>::end(size_t) noexcept {
-  return local_iterator(nullptr);
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::local_iterator
+hash_table<V, K, H, X, Q, A, P, C>::end(size_t n) noexcept {
+  return local_iterator(this, nullptr, n);
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::const_local_iterator
-hash_table<V, K, H, Ex, Kq, A>::begin(size_t n) const noexcept {
-  return const_local_iterator(buckets_[n]);
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::const_local_iterator
+hash_table<V, K, H, X, Q, A, P, C>::begin(size_t n) const noexcept {
+  return const_local_iterator(
+      this, buckets_[n] ? static_cast<node*>(buckets_[n]->nxt) : nullptr, n);
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::const_local_iterator
-hash_table<V, K, H, Ex, Kq, A>::end(size_t) const noexcept {
-  return local_iterator(nullptr);
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::const_local_iterator
+hash_table<V, K, H, X, Q, A, P, C>::end(size_t n) const noexcept {
+  return const_local_iterator(this, nullptr, n);
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::const_local_iterator
-hash_table<V, K, H, Ex, Kq, A>::cbegin(size_t n) const noexcept {
-  return const_local_iterator(buckets_[n]);
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::const_local_iterator
+hash_table<V, K, H, X, Q, A, P, C>::cbegin(size_t n) const noexcept {
+  return begin(n);
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-typename hash_table<V, K, H, Ex, Kq, A>::const_local_iterator
-hash_table<V, K, H, Ex, Kq, A>::cend(size_t) const noexcept {
-  return local_iterator(nullptr);
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+typename hash_table<V, K, H, X, Q, A, P, C>::const_local_iterator
+hash_table<V, K, H, X, Q, A, P, C>::cend(size_t n) const noexcept {
+  return end(n);
 }
 
 // bucket-count
-template <class V, class K, class H, class Ex, class Kq, class A>
-size_t hash_table<V, K, H, Ex, Kq, A>::bucket_count() const {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::bucket_count() const {
   return buckets_.size();
 }
 // max-bucket-count
-template <class V, class K, class H, class Ex, class Kq, class A>
-size_t hash_table<V, K, H, Ex, Kq, A>::max_bucket_count() const {
-  return prime_nums[61];
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::max_bucket_count() const {
+  return P::max_bucket_count();
 }
 // bucket-size
-template <class V, class K, class H, class Ex, class Kq, class A>
-size_t hash_table<V, K, H, Ex, Kq, A>::bucket_size(size_t n) const {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::bucket_size(size_t n) const {
   return distance(begin(n), end(n));
 }
 // bucket
-template <class V, class K, class H, class Ex, class Kq, class A>
-size_t hash_table<V, K, H, Ex, Kq, A>::bucket(const K& key) const {
-  return hash_(key) % buckets_.size();
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+size_t hash_table<V, K, H, X, Q, A, P, C>::bucket(const K& key) const {
+  return P::index(hash_(key), buckets_.size());
 }
 
 //=============================== hash policy ================================//
-template <class V, class K, class H, class Ex, class Kq, class A>
-float hash_table<V, K, H, Ex, Kq, A>::load_factor() const {
-  return size() / bucket_count();
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+float hash_table<V, K, H, X, Q, A, P, C>::load_factor() const {
+  return float(size()) / bucket_count();
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-float hash_table<V, K, H, Ex, Kq, A>::max_load_factor() const {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+float hash_table<V, K, H, X, Q, A, P, C>::max_load_factor() const {
   return max_load_factor_;
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-void hash_table<V, K, H, Ex, Kq, A>::max_load_factor(float ml) {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::max_load_factor(float ml) {
   max_load_factor_ = ml;
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-void hash_table<V, K, H, Ex, Kq, A>::rehash(size_t count) {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::rehash(size_t count) {
   count = max(count, size_t(size() / max_load_factor()));
   if (count <= buckets_.size())
     return;
-  count = *lower_bound(prime_nums, prime_nums + 61, count);
-
-  auto tmp = move(buckets_);
-  buckets_ = vector<node*>(count);
-  for (size_t i = 0; i < tmp.size(); ++i) {
-    node* cur = tmp[i];
-    while (cur) {
-      auto new_idx = bucket(extract_key_(cur->val));
-      node* nxt = cur->nxt;
-      cur->nxt = buckets_[new_idx];
-      buckets_[new_idx] = cur;
-      cur = nxt;
+  count = P::bucket_count(count);
+  // a pending migration is finished first, there are never three arrays
+  migrate(old_buckets_.size());
+  counters_.rehashed();
+  typename counters_type::timer timer(counters_);
+  // the filter is sized for what the table holds before growing again
+  if (filter_ && count * max_load_factor() > filter_->capacity())
+    fill_filter(count * max_load_factor(), filter_->fp_rate());
+  if (incremental_ && size()) {
+    // every node now counts as old, insertions move them over
+    old_buckets_ = move(buckets_);
+    buckets_ = new_buckets(count);
+    migrated_ = 0;
+    return;
+  }
+
+  // relink the whole list, a bucket met for the first time goes to the front
+  // and takes over [before_begin_] from the previous front bucket
+  node* cur = first();
+  before_begin_.nxt = nullptr;
+  buckets_ = new_buckets(count);
+  size_t front_idx = 0;
+  while (cur) {
+    node* nxt = cur->next();
+    auto new_idx = node_bucket(cur);
+    if (buckets_[new_idx]) {
+      cur->nxt = buckets_[new_idx]->nxt;
+      buckets_[new_idx]->nxt = cur;
+    } else {
+      cur->nxt = before_begin_.nxt;
+      before_begin_.nxt = cur;
+      buckets_[new_idx] = &before_begin_;
+      if (cur->nxt)
+        buckets_[front_idx] = cur;
+      front_idx = new_idx;
     }
+    cur = nxt;
   }
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-void hash_table<V, K, H, Ex, Kq, A>::reserve(size_t count) {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::reserve(size_t count) {
   rehash(std::ceil(count / max_load_factor()));
 }
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+bool hash_table<V, K, H, X, Q, A, P, C>::incremental_rehash() const {
+  return incremental_;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::incremental_rehash(bool on) {
+  incremental_ = on;
+  if (!on)
+    migrate(old_buckets_.size());
+}
+
+// filter
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::attach_filter(double fp_rate) {
+  if (!filter_)
+    filter_ = new counting_bloom_filter();
+  fill_filter(max(size(), size_t(bucket_count() * max_load_factor())),
+              fp_rate);
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+void hash_table<V, K, H, X, Q, A, P, C>::detach_filter() {
+  delete filter_;
+  filter_ = nullptr;
+}
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+const counting_bloom_filter* hash_table<V, K, H, X, Q, A, P, C>::filter()
+    const {
+  return filter_;
+}
+
+//=============================== introspection ==============================//
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+hash_table_stats hash_table<V, K, H, X, Q, A, P, C>::stats() const {
+  hash_table_stats st = hash_table_stats();
+  st.size = size();
+  st.bucket_count = bucket_count() + old_buckets_.size() - migrated_;
+  st.chain_histogram.push_back(0);
+  // buckets are runs of nodes sharing a slot, in either array
+  size_t used = 0, hit_sum = 0;
+  for (node* cur = first(); cur;) {
+    node_base** slot = node_slot(cur);
+    size_t len = 0;
+    for (; cur && node_slot(cur) == slot; cur = cur->next())
+      ++len;
+    ++used;
+    if (len >= st.chain_histogram.size())
+      st.chain_histogram.resize(len + 1, 0);
+    ++st.chain_histogram[len];
+    st.max_chain = max(st.max_chain, len);
+    // the i-th node of a chain is found after i comparisons
+    hit_sum += len * (len + 1) / 2;
+  }
+  st.empty_buckets = st.bucket_count - used;
+  st.chain_histogram[0] = st.empty_buckets;
+  st.empty_ratio = float(st.empty_buckets) / st.bucket_count;
+  st.expected_hit_comparisons = st.size ? double(hit_sum) / st.size : 0;
+  // an absent key walks a whole chain, picked at random among all buckets
+  st.expected_miss_comparisons = double(st.size) / st.bucket_count;
+  counters_.fill(st);
+  return st;
+}
 //=============================== hash policy ================================//
-template <class V, class K, class H, class Ex, class Kq, class A>
-H hash_table<V, K, H, Ex, Kq, A>::hash_function() const {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+H hash_table<V, K, H, X, Q, A, P, C>::hash_function() const {
   return hash_;
 }
-template <class V, class K, class H, class Ex, class Kq, class A>
-Kq hash_table<V, K, H, Ex, Kq, A>::key_eq() const {
+template <class V, class K, class H, class X, class Q, class A, class P, bool C>
+Q hash_table<V, K, H, X, Q, A, P, C>::key_eq() const {
   return key_equal_;
 }
 }  // namespace mrsuyi
@@ -1,7 +1,11 @@
+#include <iterator>
+#include <string>
+#include <vector>
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
 #include "hash_table.hpp"
+#include "memory/memory_resource.hpp"
 
 using namespace mrsuyi;
 using namespace testing;
@@ -85,11 +89,13 @@ TEST(HashTableTest, Erase) {
   // single
   hash_table<int> ht;
   insert_equal(ht, {1, 1, 2, 2, 3, 3, 4});
-  *ht.erase(ht.begin());
+  *ht.erase(ht.find(1));
   EXPECT_THAT(ht, UnorderedElementsAre(1, 2, 2, 3, 3, 4));
 
   // range
-  ht.erase(ht.begin(), ++++++ht.begin());
+  auto p = ht.equal_range(2);
+  ht.erase(p.first, p.second);
+  ht.erase(ht.find(1));
   EXPECT_THAT(ht, UnorderedElementsAre(3, 3, 4));
 
   // key-equal
@@ -128,3 +134,462 @@ TEST(HashTableTest, Find) {
   assert(*it++ == 3);
   assert(it == p.second);
 }
+
+TEST(HashTableTest, Batch) {
+  // spans several batches and a few rehashes
+  std::vector<int> vals;
+  for (int i = 0; i < 100; ++i)
+    vals.push_back(i % 70);
+  hash_table<int> ht;
+  EXPECT_EQ(70, ht.insert_batch_unique(vals.begin(), vals.end()));
+  EXPECT_EQ(70, ht.size());
+  EXPECT_EQ(100, ht.insert_batch_equal(vals.begin(), vals.end()));
+  EXPECT_EQ(170, ht.size());
+  for (int i = 0; i < 70; ++i)
+    EXPECT_EQ(i < 30 ? 3 : 2, ht.count_equal(i));
+
+  std::vector<int> keys;
+  for (int i = -20; i < 90; ++i)
+    keys.push_back(i);
+  std::vector<hash_table<int>::iterator> res;
+  ht.find_batch(keys.begin(), keys.end(), std::back_inserter(res));
+  assert(res.size() == keys.size());
+  for (size_t i = 0; i < keys.size(); ++i)
+    assert(res[i] == ht.find(keys[i]));
+
+  const auto& cht = ht;
+  hash_table<int>::const_iterator cres[3];
+  int ckeys[] = {1, 100, 69};
+  assert(cht.find_batch(ckeys, ckeys + 3, cres) == cres + 3);
+  assert(*cres[0] == 1);
+  assert(cres[1] == cht.end());
+  assert(*cres[2] == 69);
+}
+
+TEST(HashTableTest, NodeHandle) {
+  hash_table<int> a, b;
+  insert_unique(a, {1, 2, 3});
+  insert_unique(b, {3, 4});
+
+  // extract & insert keep the very same node
+  const int* addr = &*a.find(2);
+  auto nh = a.extract(2);
+  assert(!nh.empty());
+  assert(nh.value() == 2);
+  EXPECT_THAT(a, UnorderedElementsAre(1, 3));
+  assert(a.extract(2).empty());
+  auto p = b.insert_unique(mrsuyi::move(nh));
+  assert(p.second);
+  assert(&*p.first == addr);
+  assert(nh.empty());
+  EXPECT_THAT(b, UnorderedElementsAre(2, 3, 4));
+
+  // a present key leaves the node in the handle
+  nh = b.extract(b.find(3));
+  assert(!a.insert_unique(mrsuyi::move(nh)).second);
+  assert(nh.value() == 3);
+  assert(*a.insert_equal(mrsuyi::move(nh)) == 3);
+  EXPECT_THAT(a, UnorderedElementsAre(1, 3, 3));
+  EXPECT_THAT(b, UnorderedElementsAre(2, 4));
+
+  // merge
+  insert_unique(b, {1, 5});
+  a.merge_unique(b);
+  EXPECT_THAT(a, UnorderedElementsAre(1, 2, 3, 3, 4, 5));
+  EXPECT_THAT(b, UnorderedElementsAre(1));
+  a.merge_equal(b);
+  EXPECT_THAT(a, UnorderedElementsAre(1, 1, 2, 3, 3, 4, 5));
+  assert(b.empty());
+  assert(b.begin() == b.end());
+  insert_unique(b, {7});
+  EXPECT_THAT(b, UnorderedElementsAre(7));
+
+  // through rehashes
+  hash_table<int> c;
+  for (int i = 0; i < 1000; ++i)
+    c.emplace_unique(i);
+  a.merge_unique(c);
+  EXPECT_EQ(1002, a.size());
+  EXPECT_EQ(5, c.size());
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(i == 1 || i == 3 ? 2 : 1, a.count_equal(i));
+}
+
+TEST(HashTableTest, NodeHandleAcrossAllocators) {
+  // every node of a table comes from its own arena
+  using alloc = polymorphic_allocator<int>;
+  using table = hash_table<int, int, hash<int>, identity<int>, equal_to<int>,
+                           alloc>;
+  static char buf_a[1 << 14], buf_b[1 << 14];
+  monotonic_buffer arena_a(buf_a, sizeof(buf_a));
+  monotonic_buffer arena_b(buf_b, sizeof(buf_b));
+  table a(16, hash<int>(), equal_to<int>(), alloc(&arena_a));
+  table b(16, hash<int>(), equal_to<int>(), alloc(&arena_b));
+  auto in_b = [](const int& val) {
+    const char* p = reinterpret_cast<const char*>(&val);
+    return p >= buf_b && p < buf_b + sizeof(buf_b);
+  };
+  for (int i = 0; i < 6; ++i)
+    a.emplace_unique(i);
+  b.emplace_unique(0);
+
+  auto p = b.insert_unique(a.extract(1));
+  assert(p.second && in_b(*p.first));
+  auto nh = a.extract(0);
+  p = b.insert_unique(mrsuyi::move(nh));
+  assert(!p.second && !nh.empty());
+  EXPECT_EQ(0, nh.value());
+  assert(in_b(*b.insert_equal(mrsuyi::move(nh))));
+  assert(nh.empty());
+
+  a.emplace_unique(1);
+  b.merge_unique(a);
+  EXPECT_EQ(1, a.size());
+  EXPECT_EQ(7, b.size());
+  b.merge_equal(a);
+  assert(a.empty());
+  EXPECT_EQ(8, b.size());
+  for (auto& val : b)
+    assert(in_b(val));
+
+  // keys hashed again on every step, moved values must not be among them
+  using str_alloc = polymorphic_allocator<std::string>;
+  using str_table =
+      hash_table<std::string, std::string, string_hash,
+                 identity<std::string>, equal_to<std::string>, str_alloc,
+                 prime_bucket_policy, false>;
+  monotonic_buffer arena_c, arena_d;
+  str_table c(16, string_hash(), equal_to<std::string>(), &arena_c);
+  str_table d(16, string_hash(), equal_to<std::string>(), &arena_d);
+  for (int i = 0; i < 50; ++i)
+    c.emplace_unique(std::to_string(i));
+  for (int i = 0; i < 50; i += 7)
+    d.emplace_unique(std::to_string(i));
+  d.merge_unique(c);
+  EXPECT_EQ(8, c.size());
+  EXPECT_EQ(50, d.size());
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_EQ(i % 7 == 0, c.count_unique(std::to_string(i)));
+    EXPECT_EQ(1, d.count_unique(std::to_string(i)));
+  }
+  for (int i = 0; i < 50; i += 7)
+    EXPECT_EQ(1, c.erase_unique(std::to_string(i)));
+  assert(c.empty());
+}
+
+TEST(HashTableTest, IncrementalRehash) {
+  hash_table<int> ht;
+  assert(!ht.incremental_rehash());
+  ht.incremental_rehash(true);
+  for (int i = 0; i < 1000; ++i)
+    ht.emplace_equal(i);
+
+  // growing leaves the nodes in the old buckets, which the new bucket
+  // interface does not see yet
+  auto buckets = ht.bucket_count();
+  int i = 1000;
+  for (; ht.bucket_count() == buckets; ++i)
+    ht.emplace_equal(i);
+  size_t seen = 0;
+  for (size_t n = 0; n < ht.bucket_count(); ++n)
+    seen += ht.bucket_size(n);
+  EXPECT_LT(seen, ht.size());
+
+  // everything stays reachable while the migration goes on
+  for (int j = 0; j < i; j += 3)
+    EXPECT_EQ(1, ht.erase_unique(j));
+  for (int j = 0; j < i; ++j)
+    ht.emplace_equal(j);
+  for (int j = 0; j < i; ++j)
+    EXPECT_EQ(j % 3 ? 2 : 1, ht.count_equal(j));
+  EXPECT_EQ(ht.size(), distance(ht.begin(), ht.end()));
+  auto cp(ht);
+  EXPECT_EQ(ht.size(), cp.size());
+  EXPECT_EQ(2, cp.count_equal(1));
+
+  // turning it off finishes the migration
+  ht.incremental_rehash(false);
+  seen = 0;
+  for (size_t n = 0; n < ht.bucket_count(); ++n)
+    seen += ht.bucket_size(n);
+  EXPECT_EQ(ht.size(), seen);
+}
+
+struct constant_hash {
+  size_t operator()(int) const { return 42; }
+};
+
+TEST(HashTableTest, Stats) {
+  hash_table<int> ht;
+  for (int i = 0; i < 1000; ++i)
+    ht.emplace_equal(i % 500);
+  auto st = ht.stats();
+  EXPECT_EQ(1000, st.size);
+  EXPECT_EQ(ht.bucket_count(), st.bucket_count);
+  size_t buckets = 0, nodes = 0;
+  for (size_t len = 0; len < st.chain_histogram.size(); ++len) {
+    buckets += st.chain_histogram[len];
+    nodes += len * st.chain_histogram[len];
+  }
+  EXPECT_EQ(st.bucket_count, buckets);
+  EXPECT_EQ(st.size, nodes);
+  EXPECT_EQ(st.chain_histogram.size() - 1, st.max_chain);
+  EXPECT_EQ(st.chain_histogram[0], st.empty_buckets);
+  EXPECT_FLOAT_EQ(float(st.empty_buckets) / st.bucket_count, st.empty_ratio);
+  EXPECT_FLOAT_EQ(ht.load_factor(), st.expected_miss_comparisons);
+
+  // the old array stops counting once a migration is over
+  hash_table<int> inc;
+  inc.incremental_rehash(true);
+  for (int i = 0; i < 2000; ++i)
+    inc.emplace_unique(i);
+  inc.incremental_rehash(false);
+  st = inc.stats();
+  EXPECT_EQ(inc.bucket_count(), st.bucket_count);
+  EXPECT_LE(st.empty_buckets, st.bucket_count);
+  inc.clear();
+  st = inc.stats();
+  EXPECT_EQ(inc.bucket_count(), st.bucket_count);
+  EXPECT_EQ(st.bucket_count, st.empty_buckets);
+
+  // a degenerate hash shows up as one long chain
+  hash_table<int, int, constant_hash> weak;
+  for (int i = 0; i < 100; ++i)
+    weak.emplace_unique(i);
+  st = weak.stats();
+  EXPECT_EQ(100, st.max_chain);
+  EXPECT_EQ(st.bucket_count - 1, st.empty_buckets);
+  EXPECT_DOUBLE_EQ(50.5, st.expected_hit_comparisons);
+
+  // measured counters only exist with MRSUYI_HASH_TABLE_STATS
+  weak.count_unique(0);
+  weak.count_unique(-1);
+  st = weak.stats();
+  if (hash_table_counting) {
+    EXPECT_EQ(1, st.hits);
+    EXPECT_EQ(101, st.misses);
+    EXPECT_GT(st.rehash_count, 0);
+  } else {
+    EXPECT_EQ(0, st.hits + st.misses + st.rehash_count);
+  }
+}
+
+TEST(HashTableTest, Filter) {
+  hash_table<int> ht;
+  assert(!ht.filter());
+  ht.emplace_unique(-1);
+  ht.attach_filter(0.01);
+  assert(ht.filter());
+  // grows along with the table
+  for (int i = 0; i < 10000; ++i)
+    ht.emplace_unique(i);
+  EXPECT_GE(ht.filter()->capacity(), ht.size());
+  for (int i = -1; i < 10000; ++i)
+    EXPECT_EQ(1, ht.count_unique(i));
+  size_t passed = 0;
+  for (int i = 10000; i < 20000; ++i) {
+    assert(ht.find(i) == ht.end());
+    passed += ht.filter()->may_contain(hash<int>()(i));
+  }
+  EXPECT_LT(passed, 200);
+
+  // erased keys leave the filter
+  for (int i = 0; i < 10000; i += 2)
+    ht.erase_unique(i);
+  ht.erase(ht.find(1));
+  auto nh = ht.extract(3);
+  passed = 0;
+  for (int i = 0; i < 10000; i += 2)
+    passed += ht.filter()->may_contain(hash<int>()(i));
+  EXPECT_LT(passed, 100);
+  EXPECT_EQ(0, ht.count_unique(3));
+  ht.insert_unique(mrsuyi::move(nh));
+  EXPECT_EQ(1, ht.count_unique(3));
+
+  // copies carry their own filter
+  hash_table<int> copy(ht);
+  copy.emplace_unique(20000);
+  EXPECT_EQ(1, copy.count_unique(20000));
+  EXPECT_EQ(0, ht.count_unique(20000));
+  hash_table<int> other;
+  other.attach_filter();
+  other.emplace_unique(30000);
+  other.emplace_unique(3);
+  ht.merge_unique(other);
+  EXPECT_EQ(1, ht.count_unique(30000));
+  EXPECT_EQ(0, other.count_unique(30000));
+  EXPECT_EQ(1, other.count_unique(3));
+
+  ht.clear();
+  EXPECT_EQ(0, ht.count_unique(5));
+  ht.emplace_unique(5);
+  EXPECT_EQ(1, ht.count_unique(5));
+  ht.detach_filter();
+  assert(!ht.filter());
+  EXPECT_EQ(1, ht.count_unique(5));
+}
+
+template <class Policy>
+void check_bucket_policy() {
+  hash_table<int, int, hash<int>, identity<int>, equal_to<int>, allocator<int>,
+             Policy>
+      ht;
+  EXPECT_EQ(8, ht.bucket_count());
+  // strided keys would all land in one bucket with a plain mask
+  for (int i = 0; i < 1000; ++i)
+    ht.emplace_unique(i * 1024);
+  EXPECT_EQ(1000, ht.size());
+  EXPECT_EQ(1024, ht.bucket_count());
+  size_t longest = 0;
+  for (size_t n = 0; n < ht.bucket_count(); ++n)
+    longest = max(longest, ht.bucket_size(n));
+  EXPECT_LE(longest, 8);
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(1, ht.count_unique(i * 1024));
+  EXPECT_EQ(0, ht.count_unique(1));
+}
+
+TEST(HashTableTest, BucketPolicy) {
+  check_bucket_policy<fibonacci_bucket_policy>();
+  check_bucket_policy<xorshift_bucket_policy>();
+}
+
+struct counting_hash {
+  static size_t calls;
+  size_t operator()(int n) const {
+    ++calls;
+    return n;
+  }
+};
+size_t counting_hash::calls = 0;
+
+TEST(HashTableTest, CacheHash) {
+  hash_table<int, int, counting_hash, identity<int>, equal_to<int>,
+             allocator<int>, prime_bucket_policy, true>
+      ht;
+  counting_hash::calls = 0;
+  for (int i = 0; i < 1000; ++i)
+    ht.emplace_unique(i);
+  // one call per insertion, none from the rehashes in between
+  EXPECT_EQ(1000, counting_hash::calls);
+
+  counting_hash::calls = 0;
+  size_t n = 0;
+  for (auto it = ht.begin(); it != ht.end(); ++it)
+    ++n;
+  EXPECT_EQ(1000, n);
+  ht.rehash(ht.bucket_count() * 4);
+  EXPECT_EQ(0, counting_hash::calls);
+
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(1, ht.count_unique(i));
+  auto cp(ht);
+  EXPECT_EQ(1000, cp.size());
+  EXPECT_EQ(1, cp.erase_unique(10));
+  EXPECT_EQ(0, cp.count_unique(10));
+
+  // without the cache every rehash goes through the hasher again
+  hash_table<int, int, counting_hash> plain;
+  counting_hash::calls = 0;
+  for (int i = 0; i < 1000; ++i)
+    plain.emplace_unique(i);
+  EXPECT_GT(counting_hash::calls, 1000);
+}
+
+struct counting_string_hash {
+  static size_t calls;
+  size_t operator()(const std::string& s) const {
+    ++calls;
+    return string_hash()(s);
+  }
+};
+size_t counting_string_hash::calls = 0;
+
+TEST(HashTableTest, CacheHashDefault) {
+  static_assert(!hash_cache_default<int>::value, "");
+  static_assert(hash_cache_default<std::string>::value, "");
+  static_assert(hash_cache_default<const char*>::value, "");
+  // walking a chain of strings hashes nothing but the key looked up
+  hash_table<std::string, std::string, counting_string_hash> ht;
+  for (int i = 0; i < 1000; ++i)
+    ht.emplace_unique(std::to_string(i));
+  counting_string_hash::calls = 0;
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(1, ht.count_unique(std::to_string(i)));
+    EXPECT_EQ(0, ht.count_unique(std::to_string(-i - 1)));
+  }
+  EXPECT_EQ(2000, counting_string_hash::calls);
+}
+
+TEST(HashTableTest, Iterate) {
+  // a sparse table still iterates its elements only
+  hash_table<int> ht;
+  ht.reserve(10000);
+  insert_equal(ht, {5, 1, 5, 9});
+  EXPECT_THAT(ht, UnorderedElementsAre(1, 5, 5, 9));
+  auto it = ht.begin();
+  ++++++++it;
+  assert(it == ht.end());
+
+  // buckets keep pointing at the right nodes through erase and rehash
+  ht.clear();
+  for (int i = 0; i < 1000; ++i) {
+    ht.emplace_equal(i);
+    ht.emplace_equal(i);
+  }
+  for (int i = 0; i < 1000; i += 2)
+    EXPECT_EQ(2, ht.erase_equal(i));
+  for (auto it = ht.begin(); it != ht.end();)
+    it = *it % 3 ? ++it : ht.erase(it);
+  ht.rehash(ht.bucket_count() * 2);
+
+  size_t total = 0;
+  for (size_t n = 0; n < ht.bucket_count(); ++n)
+    total += ht.bucket_size(n);
+  EXPECT_EQ(ht.size(), total);
+  EXPECT_EQ(ht.size(), distance(ht.begin(), ht.end()));
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(i % 2 && i % 3 ? 2 : 0, ht.count_equal(i));
+}
+
+// only buildable explicitly, so lookups by int must go the transparent way
+struct id_key {
+  explicit id_key(int id) : id(id) {}
+  bool operator==(const id_key& other) const { return id == other.id; }
+  bool operator==(int other) const { return id == other; }
+  int id;
+};
+struct id_hash {
+  using is_transparent = void;
+  size_t operator()(const id_key& key) const { return key.id; }
+  size_t operator()(int id) const { return id; }
+};
+
+TEST(HashTableTest, TransparentLookup) {
+  hash_table<id_key, id_key, id_hash, identity<id_key>, equal_to<>> ht;
+  for (int i = 0; i < 10; ++i)
+    ht.emplace_equal(id_key(i));
+  ht.emplace_equal(id_key(3));
+
+  EXPECT_EQ(3, ht.find(3)->id);
+  assert(ht.find(10) == ht.end());
+  EXPECT_EQ(1, ht.count_unique(5));
+  EXPECT_EQ(2, ht.count_equal(3));
+  auto p = ht.equal_range(3);
+  EXPECT_EQ(2, distance(p.first, p.second));
+  EXPECT_EQ(2, ht.erase_equal(3));
+  EXPECT_EQ(1, ht.erase_unique(4));
+  EXPECT_EQ(0, ht.erase_unique(4));
+  EXPECT_EQ(8, ht.size());
+
+  // strings found by C string
+  hash_table<std::string, std::string, string_hash, identity<std::string>,
+             equal_to<>>
+      names;
+  names.emplace_unique(std::string("alice"));
+  names.emplace_unique(std::string("bob"));
+  const char* bob = "bob";
+  EXPECT_EQ("bob", *names.find(bob));
+  EXPECT_EQ(1, names.count_unique("alice"));
+  EXPECT_EQ(0, names.count_unique("carol"));
+}
@@ -330,11 +330,11 @@ list<T, Alloc>::list(const list& x, const allocator_type& alloc)
     : list(x.begin(), x.end(), alloc) {}
 // move
 template <class T, class Alloc>
-list<T, Alloc>::list(list&& x) : list(move(x), allocator_type()) {}
+list<T, Alloc>::list(list&& x) : list(move(x), x.alloc_) {}
 template <class T, class Alloc>
 list<T, Alloc>::list(list&& x, const allocator_type& alloc)
     : joint_(x.joint_), alloc_(alloc), size_(x.size_) {
-  x.joint_ = new_node();
+  x.joint_ = x.new_node();
   x.size_ = 0;
 }
 // list
@@ -0,0 +1,502 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include "functional.hpp"
+#include "utility.hpp"
+#include "vector.hpp"
+
+namespace mrsuyi {
+// element of a mapped_hash_table, laid out in the file as in memory
+template <class Key, class T>
+struct mapped_entry {
+  Key first;
+  T second;
+};
+
+// first bytes of a mapped_hash_table file. all positions are offsets from the
+// start of the file so that it can be mapped anywhere
+struct mapped_hash_table_header {
+  char magic[8];
+  uint32_t version;
+  // 0x01020304 as written, tells apart files of the other endianness
+  uint32_t byte_order;
+  uint32_t key_size;
+  uint32_t value_size;
+  uint32_t entry_size;
+  uint32_t entry_align;
+  uint64_t size;
+  // power of two
+  uint64_t bucket_count;
+  // bucket_count + 1 uint64_t, entries of bucket b are [offsets[b],
+  // offsets[b + 1])
+  uint64_t offsets_offset;
+  uint64_t entries_offset;
+  uint64_t file_size;
+};
+
+// read-only hash map over a file written by dump(), which mmap() attaches
+// without parsing: lookups work at once and the OS pages the data in as they
+// touch it. keys & values must be trivially copyable and [Hash] has to give
+// the same results in the process that dumps & the one that loads
+template <class Key,
+          class T,
+          class Hash = hash<Key>,
+          class KeyEqual = equal_to<Key>>
+class mapped_hash_table {
+  static_assert(std::is_trivially_copyable<Key>::value &&
+                    std::is_trivially_copyable<T>::value,
+                "mapped_hash_table needs trivially copyable types");
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = mapped_entry<Key, T>;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using reference = const value_type&;
+  using const_reference = const value_type&;
+  using pointer = const value_type*;
+  using const_pointer = const value_type*;
+  using iterator = const value_type*;
+  using const_iterator = const value_type*;
+
+  // bumped whenever the layout changes, older files are refused
+  static const uint32_t format_version = 1;
+
+ public:
+  // ctor & dtor
+  mapped_hash_table();
+  // open([path], [populate])
+  explicit mapped_hash_table(const char* path,
+                             bool populate = false,
+                             const Hash& = Hash(),
+                             const KeyEqual& = KeyEqual());
+  mapped_hash_table(const mapped_hash_table&) = delete;
+  mapped_hash_table(mapped_hash_table&& other) noexcept;
+  ~mapped_hash_table();
+
+  mapped_hash_table& operator=(const mapped_hash_table&) = delete;
+  mapped_hash_table& operator=(mapped_hash_table&& other) noexcept;
+
+  // write [first, last) to [path], the first of equal keys wins. the file is
+  // replaced whole, tables already open on it keep the old contents. elements
+  // only need .first & .second, so this takes map-like hash_table, frozen_map
+  // or pair ranges alike
+  template <class InputIt>
+  static void dump(InputIt first,
+                   InputIt last,
+                   const char* path,
+                   const Hash& = Hash(),
+                   const KeyEqual& = KeyEqual());
+  template <class Table>
+  static void dump(const Table& table, const char* path);
+
+  // map the file at [path], throws std::runtime_error if it can't be read,
+  // was written with another format or its header & bucket offsets don't add
+  // up. [populate] faults every page in now instead of on first touch
+  void open(const char* path, bool populate = false);
+  void close() noexcept;
+  bool is_open() const noexcept;
+
+  // iterators, in bucket order
+  const_iterator begin() const noexcept;
+  const_iterator end() const noexcept;
+  const_iterator cbegin() const noexcept;
+  const_iterator cend() const noexcept;
+
+  // capacity
+  bool empty() const noexcept;
+  size_t size() const noexcept;
+  size_t bucket_count() const noexcept;
+
+  // lookup
+  const_iterator find(const Key& key) const;
+  size_t count(const Key& key) const;
+  const T& at(const Key& key) const;
+
+  // observers
+  Hash hash_function() const;
+  KeyEqual key_eq() const;
+
+ protected:
+  static size_t bucket_of(size_t code, size_t bucket_count);
+  // [n] rounded up to [align]
+  static size_t align_up(size_t n, size_t align);
+  static void write_all(int fd, const void* data, size_t n);
+  static void fail(const char* what, int fd = -1);
+
+ protected:
+  Hash hash_;
+  KeyEqual key_equal_;
+
+  void* map_;
+  size_t map_size_;
+  const mapped_hash_table_header* header_;
+  const uint64_t* offsets_;
+  const value_type* entries_;
+};
+
+//=================================== basic ==================================//
+template <class K, class T, class H, class Q>
+mapped_hash_table<K, T, H, Q>::mapped_hash_table()
+    : map_(nullptr),
+      map_size_(0),
+      header_(nullptr),
+      offsets_(nullptr),
+      entries_(nullptr) {}
+template <class K, class T, class H, class Q>
+mapped_hash_table<K, T, H, Q>::mapped_hash_table(const char* path,
+                                                 bool populate,
+                                                 const H& hash,
+                                                 const Q& key_equal)
+    : hash_(hash),
+      key_equal_(key_equal),
+      map_(nullptr),
+      map_size_(0),
+      header_(nullptr),
+      offsets_(nullptr),
+      entries_(nullptr) {
+  open(path, populate);
+}
+template <class K, class T, class H, class Q>
+mapped_hash_table<K, T, H, Q>::mapped_hash_table(
+    mapped_hash_table&& other) noexcept
+    : hash_(mrsuyi::move(other.hash_)),
+      key_equal_(mrsuyi::move(other.key_equal_)),
+      map_(other.map_),
+      map_size_(other.map_size_),
+      header_(other.header_),
+      offsets_(other.offsets_),
+      entries_(other.entries_) {
+  other.map_ = nullptr;
+  other.map_size_ = 0;
+  other.header_ = nullptr;
+  other.offsets_ = nullptr;
+  other.entries_ = nullptr;
+}
+template <class K, class T, class H, class Q>
+mapped_hash_table<K, T, H, Q>::~mapped_hash_table() {
+  close();
+}
+// =
+template <class K, class T, class H, class Q>
+mapped_hash_table<K, T, H, Q>& mapped_hash_table<K, T, H, Q>::operator=(
+    mapped_hash_table&& other) noexcept {
+  if (this != &other) {
+    close();
+    hash_ = mrsuyi::move(other.hash_);
+    key_equal_ = mrsuyi::move(other.key_equal_);
+    mrsuyi::swap(map_, other.map_);
+    mrsuyi::swap(map_size_, other.map_size_);
+    mrsuyi::swap(header_, other.header_);
+    mrsuyi::swap(offsets_, other.offsets_);
+    mrsuyi::swap(entries_, other.entries_);
+  }
+  return *this;
+}
+
+//================================== dump ====================================//
+template <class K, class T, class H, class Q>
+template <class InputIt>
+void mapped_hash_table<K, T, H, Q>::dump(InputIt first,
+                                         InputIt last,
+                                         const char* path,
+                                         const H& hash,
+                                         const Q& key_equal) {
+  vector<value_type> items;
+  vector<size_t> codes;
+  for (; first != last; ++first) {
+    items.push_back({first->first, first->second});
+    codes.push_back(hash(first->first));
+  }
+  size_t buckets = 1;
+  while (buckets < items.size())
+    buckets *= 2;
+
+  // group the items by bucket, keeping their order
+  vector<uint64_t> offsets(buckets + 1, 0);
+  for (size_t i = 0; i < items.size(); ++i)
+    ++offsets[bucket_of(codes[i], buckets) + 1];
+  for (size_t b = 0; b < buckets; ++b)
+    offsets[b + 1] += offsets[b];
+  vector<uint64_t> fill(offsets);
+  vector<size_t> order(items.size());
+  for (size_t i = 0; i < items.size(); ++i)
+    order[fill[bucket_of(codes[i], buckets)]++] = i;
+
+  // drop repeated keys, moving every bucket down over the gaps
+  vector<value_type> entries;
+  entries.reserve(items.size());
+  for (size_t b = 0; b < buckets; ++b) {
+    size_t begin = entries.size();
+    for (size_t i = offsets[b]; i < offsets[b + 1]; ++i) {
+      const value_type& item = items[order[i]];
+      bool repeated = false;
+      for (size_t j = begin; j < entries.size() && !repeated; ++j)
+        repeated = key_equal(entries[j].first, item.first);
+      if (!repeated) {
+        // written byte for byte, padding included, so it starts out zero
+        value_type* entry = entries.append_uninitialized(1);
+        memset(entry, 0, sizeof(value_type));
+        memcpy(&entry->first, &item.first, sizeof(K));
+        memcpy(&entry->second, &item.second, sizeof(T));
+      }
+    }
+    offsets[b] = begin;
+  }
+  offsets[buckets] = entries.size();
+
+  mapped_hash_table_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "mrsuyiht", 8);
+  header.version = format_version;
+  header.byte_order = 0x01020304;
+  header.key_size = sizeof(K);
+  header.value_size = sizeof(T);
+  header.entry_size = sizeof(value_type);
+  header.entry_align = alignof(value_type);
+  header.size = entries.size();
+  header.bucket_count = buckets;
+  header.offsets_offset = align_up(sizeof(header), alignof(uint64_t));
+  // entries start on a cache line
+  header.entries_offset = align_up(
+      header.offsets_offset + offsets.size() * sizeof(uint64_t), 64);
+  header.file_size =
+      header.entries_offset + entries.size() * sizeof(value_type);
+
+  // written aside & renamed over [path], processes that still map the old
+  // file keep its pages instead of faulting on a truncated one
+  size_t len = std::strlen(path);
+  vector<char> tmp(path, path + len);
+  const char suffix[] = ".tmp";
+  tmp.insert(tmp.end(), suffix, suffix + sizeof(suffix));
+  int fd = ::open(tmp.data(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    fail("can't create file");
+  try {
+    static const char zeros[64] = {};
+    write_all(fd, &header, sizeof(header));
+    write_all(fd, zeros, header.offsets_offset - sizeof(header));
+    write_all(fd, offsets.data(), offsets.size() * sizeof(uint64_t));
+    write_all(fd, zeros, header.entries_offset - header.offsets_offset -
+                             offsets.size() * sizeof(uint64_t));
+    write_all(fd, entries.data(), entries.size() * sizeof(value_type));
+    // on disk before it gets the name, or a crash may leave [path] empty
+    if (::fsync(fd) != 0)
+      fail("can't write file", fd);
+    int closed = ::close(fd);
+    if (closed != 0 || ::rename(tmp.data(), path) != 0)
+      fail("can't write file");
+  } catch (...) {
+    ::unlink(tmp.data());
+    throw;
+  }
+}
+template <class K, class T, class H, class Q>
+template <class Table>
+void mapped_hash_table<K, T, H, Q>::dump(const Table& table,
+                                         const char* path) {
+  dump(table.begin(), table.end(), path, table.hash_function(),
+       table.key_eq());
+}
+
+//================================ open/close ================================//
+template <class K, class T, class H, class Q>
+void mapped_hash_table<K, T, H, Q>::open(const char* path, bool populate) {
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0)
+    fail("can't open file");
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+    fail("can't stat file", fd);
+  size_t file_size = st.st_size;
+  if (file_size < sizeof(mapped_hash_table_header))
+    fail("not a mapped_hash_table file", fd);
+
+  int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+  if (populate)
+    flags |= MAP_POPULATE;
+#endif
+  void* map = mmap(nullptr, file_size, PROT_READ, flags, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED)
+    fail("can't map file");
+
+  const mapped_hash_table_header* h =
+      static_cast<const mapped_hash_table_header*>(map);
+  const char* error = nullptr;
+  if (memcmp(h->magic, "mrsuyiht", 8) != 0)
+    error = "not a mapped_hash_table file";
+  else if (h->version != format_version)
+    error = "unsupported mapped_hash_table version";
+  else if (h->byte_order != 0x01020304)
+    error = "mapped_hash_table of another byte order";
+  else if (h->key_size != sizeof(K) || h->value_size != sizeof(T) ||
+           h->entry_size != sizeof(value_type) ||
+           h->entry_align != alignof(value_type))
+    error = "mapped_hash_table of other types";
+  // sizes are compared by division, the fields may be anything
+  else if (h->file_size != file_size || !h->bucket_count ||
+           (h->bucket_count & (h->bucket_count - 1)) ||
+           h->offsets_offset % alignof(uint64_t) ||
+           h->entries_offset % alignof(value_type) ||
+           h->offsets_offset > h->entries_offset ||
+           h->entries_offset > file_size ||
+           h->bucket_count >=
+               (h->entries_offset - h->offsets_offset) / sizeof(uint64_t) ||
+           h->size > (file_size - h->entries_offset) / sizeof(value_type))
+    error = "corrupt mapped_hash_table file";
+  if (!error) {
+    // lookups trust the offsets to stay within the entries, one pass over
+    // them(8 bytes a bucket) leaves the entries untouched
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(
+        static_cast<const char*>(map) + h->offsets_offset);
+    bool sorted = offsets[0] == 0 && offsets[h->bucket_count] == h->size;
+    for (uint64_t b = 0; sorted && b < h->bucket_count; ++b)
+      sorted = offsets[b] <= offsets[b + 1];
+    if (!sorted)
+      error = "corrupt mapped_hash_table file";
+  }
+  if (error) {
+    munmap(map, file_size);
+    throw std::runtime_error(error);
+  }
+
+  map_ = map;
+  map_size_ = file_size;
+  header_ = h;
+  offsets_ = reinterpret_cast<const uint64_t*>(static_cast<const char*>(map) +
+                                               h->offsets_offset);
+  entries_ = reinterpret_cast<const value_type*>(
+      static_cast<const char*>(map) + h->entries_offset);
+}
+template <class K, class T, class H, class Q>
+void mapped_hash_table<K, T, H, Q>::close() noexcept {
+  if (map_)
+    munmap(map_, map_size_);
+  map_ = nullptr;
+  map_size_ = 0;
+  header_ = nullptr;
+  offsets_ = nullptr;
+  entries_ = nullptr;
+}
+template <class K, class T, class H, class Q>
+bool mapped_hash_table<K, T, H, Q>::is_open() const noexcept {
+  return map_ != nullptr;
+}
+
+//================================= iterators ================================//
+template <class K, class T, class H, class Q>
+typename mapped_hash_table<K, T, H, Q>::const_iterator
+mapped_hash_table<K, T, H, Q>::begin() const noexcept {
+  return entries_;
+}
+template <class K, class T, class H, class Q>
+typename mapped_hash_table<K, T, H, Q>::const_iterator
+mapped_hash_table<K, T, H, Q>::end() const noexcept {
+  return entries_ + size();
+}
+template <class K, class T, class H, class Q>
+typename mapped_hash_table<K, T, H, Q>::const_iterator
+mapped_hash_table<K, T, H, Q>::cbegin() const noexcept {
+  return begin();
+}
+template <class K, class T, class H, class Q>
+typename mapped_hash_table<K, T, H, Q>::const_iterator
+mapped_hash_table<K, T, H, Q>::cend() const noexcept {
+  return end();
+}
+
+//================================= capacity =================================//
+template <class K, class T, class H, class Q>
+bool mapped_hash_table<K, T, H, Q>::empty() const noexcept {
+  return size() == 0;
+}
+template <class K, class T, class H, class Q>
+size_t mapped_hash_table<K, T, H, Q>::size() const noexcept {
+  return header_ ? header_->size : 0;
+}
+template <class K, class T, class H, class Q>
+size_t mapped_hash_table<K, T, H, Q>::bucket_count() const noexcept {
+  return header_ ? header_->bucket_count : 0;
+}
+
+//================================== lookup ==================================//
+template <class K, class T, class H, class Q>
+typename mapped_hash_table<K, T, H, Q>::const_iterator
+mapped_hash_table<K, T, H, Q>::find(const K& key) const {
+  if (!header_)
+    return end();
+  size_t b = bucket_of(hash_(key), header_->bucket_count);
+  for (uint64_t i = offsets_[b]; i < offsets_[b + 1]; ++i)
+    if (key_equal_(entries_[i].first, key))
+      return entries_ + i;
+  return end();
+}
+template <class K, class T, class H, class Q>
+size_t mapped_hash_table<K, T, H, Q>::count(const K& key) const {
+  return find(key) != end();
+}
+template <class K, class T, class H, class Q>
+const T& mapped_hash_table<K, T, H, Q>::at(const K& key) const {
+  auto it = find(key);
+  if (it == end())
+    throw std::out_of_range("out of range");
+  return it->second;
+}
+
+//================================= observers ================================//
+template <class K, class T, class H, class Q>
+H mapped_hash_table<K, T, H, Q>::hash_function() const {
+  return hash_;
+}
+template <class K, class T, class H, class Q>
+Q mapped_hash_table<K, T, H, Q>::key_eq() const {
+  return key_equal_;
+}
+
+//================================= protected ================================//
+template <class K, class T, class H, class Q>
+size_t mapped_hash_table<K, T, H, Q>::bucket_of(size_t code,
+                                                size_t bucket_count) {
+  // the mask keeps low bits only, mix them with the rest first
+  return hash_int(code) & (bucket_count - 1);
+}
+template <class K, class T, class H, class Q>
+size_t mapped_hash_table<K, T, H, Q>::align_up(size_t n, size_t align) {
+  return (n + align - 1) / align * align;
+}
+template <class K, class T, class H, class Q>
+void mapped_hash_table<K, T, H, Q>::write_all(int fd,
+                                              const void* data,
+                                              size_t n) {
+  const char* p = static_cast<const char*>(data);
+  while (n) {
+    ssize_t written = ::write(fd, p, n);
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written < 0)
+      fail("can't write file", fd);
+    p += written;
+    n -= written;
+  }
+}
+template <class K, class T, class H, class Q>
+void mapped_hash_table<K, T, H, Q>::fail(const char* what, int fd) {
+  if (fd >= 0)
+    ::close(fd);
+  throw std::runtime_error(what);
+}
+}  // namespace mrsuyi
@@ -0,0 +1,169 @@
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "frozen_map.hpp"
+#include "hash_table.hpp"
+#include "mapped_hash_table.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+namespace {
+std::string temp_path(const char* name) {
+  return std::string("/tmp/") + name + "." + std::to_string(getpid());
+}
+}  // namespace
+
+TEST(MappedHashTableTest, Basic) {
+  std::string path = temp_path("mapped_hash_table_basic");
+  mapped_hash_table<int, double> closed;
+  assert(!closed.is_open());
+  assert(closed.empty());
+  EXPECT_EQ(closed.end(), closed.find(1));
+
+  std::vector<pair<int, double>> items = {{1, 1.5}, {2, 2.5}, {1, 3.5}};
+  mapped_hash_table<int, double>::dump(items.begin(), items.end(),
+                                       path.c_str());
+  mapped_hash_table<int, double> m(path.c_str());
+  assert(m.is_open());
+  EXPECT_EQ(2, m.size());
+  EXPECT_LE(m.size(), m.bucket_count());
+  // the first of equal keys wins
+  EXPECT_EQ(1.5, m.at(1));
+  EXPECT_EQ(2.5, m.find(2)->second);
+  EXPECT_EQ(0, m.count(3));
+  EXPECT_THROW(m.at(3), std::out_of_range);
+
+  mapped_hash_table<int, double> moved(mrsuyi::move(m));
+  assert(!m.is_open());
+  EXPECT_EQ(1.5, moved.at(1));
+  m = mrsuyi::move(moved);
+  EXPECT_EQ(2.5, m.at(2));
+  m.close();
+  assert(m.empty());
+  remove(path.c_str());
+}
+
+TEST(MappedHashTableTest, Tables) {
+  std::string path = temp_path("mapped_hash_table_tables");
+  hash_table<pair<const long, int>, long, hash<long>,
+             select1st<pair<const long, int>>>
+      ht;
+  for (int i = 0; i < 10000; ++i)
+    ht.emplace_unique(long(i) * 3, i);
+  mapped_hash_table<long, int>::dump(ht, path.c_str());
+  mapped_hash_table<long, int> m(path.c_str(), true);
+  EXPECT_EQ(10000, m.size());
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_EQ(i, m.at(long(i) * 3));
+    EXPECT_EQ(0, m.count(long(i) * 3 + 1));
+  }
+  int sum = 0;
+  for (auto& e : m)
+    sum += e.second;
+  EXPECT_EQ(10000 * 9999 / 2, sum);
+
+  frozen_map<long, int> fm(ht);
+  mapped_hash_table<long, int>::dump(fm, path.c_str());
+  m.open(path.c_str());
+  EXPECT_EQ(10000, m.size());
+  EXPECT_EQ(42, m.at(126));
+  remove(path.c_str());
+}
+
+TEST(MappedHashTableTest, DumpOverOpen) {
+  // a smaller file dumped over a mapped one must not cut the mapping short
+  using table = mapped_hash_table<int, int>;
+  std::string path = temp_path("mapped_hash_table_replace");
+  std::vector<pair<int, int>> items;
+  for (int i = 0; i < 100000; ++i)
+    items.push_back(pair<int, int>(i, i * 2));
+  table::dump(items.begin(), items.end(), path.c_str());
+  table old(path.c_str());
+
+  items.erase(items.begin() + 10, items.end());
+  for (auto& item : items)
+    item.second = -1;
+  table::dump(items.begin(), items.end(), path.c_str());
+  EXPECT_EQ(100000, old.size());
+  for (int i = 0; i < 100000; ++i)
+    EXPECT_EQ(i * 2, old.at(i));
+  table cur(path.c_str());
+  EXPECT_EQ(10, cur.size());
+  EXPECT_EQ(-1, cur.at(9));
+  EXPECT_EQ(-1, access((path + ".tmp").c_str(), F_OK));
+
+  // nothing is left behind when the file can't be written
+  std::string dir = temp_path("mapped_hash_table_dir");
+  mkdir(dir.c_str(), 0755);
+  EXPECT_THROW(table::dump(items.begin(), items.end(), dir.c_str()),
+               std::runtime_error);
+  EXPECT_EQ(-1, access((dir + ".tmp").c_str(), F_OK));
+  rmdir(dir.c_str());
+  remove(path.c_str());
+}
+
+TEST(MappedHashTableTest, Format) {
+  std::string path = temp_path("mapped_hash_table_format");
+  std::vector<pair<int, int>> items = {{1, 1}};
+  mapped_hash_table<int, int>::dump(items.begin(), items.end(), path.c_str());
+
+  // other types
+  using long_table = mapped_hash_table<long, int>;
+  using int_table = mapped_hash_table<int, int>;
+  EXPECT_THROW(long_table(path.c_str()), std::runtime_error);
+  // other version
+  FILE* f = fopen(path.c_str(), "r+b");
+  mapped_hash_table_header header;
+  EXPECT_EQ(1, fread(&header, sizeof(header), 1, f));
+  header.version += 1;
+  fseek(f, 0, SEEK_SET);
+  fwrite(&header, sizeof(header), 1, f);
+  fclose(f);
+  EXPECT_THROW(int_table(path.c_str()), std::runtime_error);
+
+  // bucket offsets leading out of the entries
+  std::vector<pair<char, int>> chars = {{'a', 1}, {'b', 2}, {'c', 3}};
+  using char_table = mapped_hash_table<char, int>;
+  char_table::dump(chars.begin(), chars.end(), path.c_str());
+  f = fopen(path.c_str(), "r+b");
+  EXPECT_EQ(1, fread(&header, sizeof(header), 1, f));
+  std::vector<uint64_t> offsets(header.bucket_count + 1);
+  fseek(f, header.offsets_offset, SEEK_SET);
+  EXPECT_EQ(offsets.size(),
+            fread(offsets.data(), sizeof(uint64_t), offsets.size(), f));
+  EXPECT_EQ(0, offsets[0]);
+  EXPECT_EQ(3, offsets.back());
+  // padding between key & value is written as zeros
+  using entry = mapped_entry<char, int>;
+  std::vector<entry> entries(3);
+  fseek(f, header.entries_offset, SEEK_SET);
+  EXPECT_EQ(3, fread(entries.data(), sizeof(entries[0]), 3, f));
+  for (auto& e : entries) {
+    const char* bytes = reinterpret_cast<const char*>(&e);
+    for (size_t i = sizeof(char); i < offsetof(entry, second); ++i)
+      EXPECT_EQ(0, bytes[i]);
+  }
+  uint64_t bad = 1000;
+  fseek(f, header.offsets_offset + sizeof(uint64_t), SEEK_SET);
+  fwrite(&bad, sizeof(bad), 1, f);
+  fclose(f);
+  EXPECT_THROW(char_table(path.c_str()), std::runtime_error);
+  // a bucket count that overflows the size of the offsets
+  char_table::dump(chars.begin(), chars.end(), path.c_str());
+  f = fopen(path.c_str(), "r+b");
+  header.bucket_count = uint64_t(1) << 63;
+  fwrite(&header, sizeof(header), 1, f);
+  fclose(f);
+  EXPECT_THROW(char_table(path.c_str()), std::runtime_error);
+
+  remove(path.c_str());
+  EXPECT_THROW(int_table(path.c_str()), std::runtime_error);
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "memory.hpp"
+#include "utility.hpp"
+
+namespace mrsuyi {
+// bounded multi-producer multi-consumer queue over a power-of-two ring, after
+// Vyukov. every cell carries a sequence number naming the position it is
+// ready for: the position itself while free to push to, one past it once
+// filled. a thread claims positions with a CAS on tail_(producers) or
+// head_(consumers) and then works on its cells alone, releasing each through
+// its sequence number. nobody ever waits for a lock, though a thread stalled
+// between claim & release holds up the consumers(or producers) of its cells
+template <class T, class Alloc = allocator<T>>
+class mpmc_ring {
+ public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using size_type = size_t;
+
+  // ctor & dtor
+  // [capacity] is rounded up to a power of two, 2 at least
+  explicit mpmc_ring(size_t capacity, const Alloc& alloc = Alloc());
+  mpmc_ring(const mpmc_ring&) = delete;
+  ~mpmc_ring();
+
+  mpmc_ring& operator=(const mpmc_ring&) = delete;
+
+  // producers, false or 0 when the ring is full
+  bool push(const T& val);
+  bool push(T&& val);
+  template <class... Args>
+  bool emplace(Args&&... args);
+  // copy up to [n] elements from [first] to consecutive positions claimed
+  // with a single CAS, returns how many
+  template <class InputIt>
+  size_t push_n(InputIt first, size_t n);
+
+  // consumers, false or 0 when the ring is empty
+  bool pop(T& val);
+  // move up to [n] consecutive elements to [out], returns how many
+  template <class OutputIt>
+  size_t pop_n(OutputIt out, size_t n);
+
+  // capacity, only a snapshot while others run
+  bool empty() const;
+  size_t size() const;
+  size_t capacity() const;
+
+ private:
+  struct cell {
+    std::atomic<size_t> seq;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type val;
+  };
+  using cell_allocator = typename Alloc::template other<cell>;
+
+  T* value_of(size_t pos);
+  // claim up to [n] positions from [counter] whose cells have a sequence
+  // number of position + [lag], 0 for pushing and 1 for popping. the first
+  // goes to [pos], returns how many, 0 when even the first one is not ready
+  size_t claim(std::atomic<size_t>& counter,
+               size_t n,
+               size_t lag,
+               size_t& pos);
+
+ private:
+  // read-only once built
+  cell* cells_;
+  size_t mask_;
+  cell_allocator alloc_;
+  char pad0_[64];
+  // next position to push
+  std::atomic<size_t> tail_;
+  char pad1_[64];
+  // next position to pop
+  std::atomic<size_t> head_;
+  char pad2_[64];
+};
+
+//================================== private =================================//
+template <class T, class Alloc>
+T* mpmc_ring<T, Alloc>::value_of(size_t pos) {
+  return reinterpret_cast<T*>(&cells_[pos & mask_].val);
+}
+template <class T, class Alloc>
+size_t mpmc_ring<T, Alloc>::claim(std::atomic<size_t>& counter,
+                                  size_t n,
+                                  size_t lag,
+                                  size_t& pos) {
+  pos = counter.load(std::memory_order_relaxed);
+  if (!n)
+    return 0;
+  for (;;) {
+    size_t ready = 0;
+    intptr_t diff = 0;
+    for (; ready < n; ++ready) {
+      size_t seq =
+          cells_[(pos + ready) & mask_].seq.load(std::memory_order_acquire);
+      diff = intptr_t(seq - (pos + ready + lag));
+      if (diff)
+        break;
+    }
+    if (ready) {
+      // a failed CAS reloads [pos]
+      if (counter.compare_exchange_weak(pos, pos + ready,
+                                        std::memory_order_relaxed))
+        return ready;
+    } else if (diff < 0) {
+      // the cell is a lap behind: full for producers, empty for consumers
+      return 0;
+    } else {
+      // somebody else took [pos]
+      pos = counter.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+//=================================== basic ==================================//
+template <class T, class Alloc>
+mpmc_ring<T, Alloc>::mpmc_ring(size_t capacity, const Alloc& alloc)
+    : alloc_(alloc), tail_(0), head_(0) {
+  size_t count = 2;
+  for (; count < capacity; count *= 2)
+    ;
+  cells_ = alloc_.allocate(count);
+  mask_ = count - 1;
+  for (size_t i = 0; i < count; ++i)
+    construct(&cells_[i].seq, i);
+}
+template <class T, class Alloc>
+mpmc_ring<T, Alloc>::~mpmc_ring() {
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  for (size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i)
+    destroy_at(value_of(i));
+  alloc_.deallocate(cells_, mask_ + 1);
+}
+
+//================================= producers ================================//
+template <class T, class Alloc>
+bool mpmc_ring<T, Alloc>::push(const T& val) {
+  return emplace(val);
+}
+template <class T, class Alloc>
+bool mpmc_ring<T, Alloc>::push(T&& val) {
+  return emplace(mrsuyi::move(val));
+}
+template <class T, class Alloc>
+template <class... Args>
+bool mpmc_ring<T, Alloc>::emplace(Args&&... args) {
+  size_t pos;
+  if (!claim(tail_, 1, 0, pos))
+    return false;
+  construct(value_of(pos), mrsuyi::forward<Args>(args)...);
+  cells_[pos & mask_].seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+template <class T, class Alloc>
+template <class InputIt>
+size_t mpmc_ring<T, Alloc>::push_n(InputIt first, size_t n) {
+  size_t pos;
+  n = claim(tail_, n, 0, pos);
+  for (size_t i = 0; i < n; ++i, ++first) {
+    construct(value_of(pos + i), *first);
+    cells_[(pos + i) & mask_].seq.store(pos + i + 1,
+                                        std::memory_order_release);
+  }
+  return n;
+}
+
+//================================= consumers ================================//
+template <class T, class Alloc>
+bool mpmc_ring<T, Alloc>::pop(T& val) {
+  return pop_n(&val, 1);
+}
+template <class T, class Alloc>
+template <class OutputIt>
+size_t mpmc_ring<T, Alloc>::pop_n(OutputIt out, size_t n) {
+  size_t pos;
+  n = claim(head_, n, 1, pos);
+  for (size_t i = 0; i < n; ++i, ++out) {
+    T* p = value_of(pos + i);
+    *out = mrsuyi::move(*p);
+    destroy_at(p);
+    // free for the push a lap later
+    cells_[(pos + i) & mask_].seq.store(pos + i + mask_ + 1,
+                                        std::memory_order_release);
+  }
+  return n;
+}
+
+//================================= capacity =================================//
+template <class T, class Alloc>
+bool mpmc_ring<T, Alloc>::empty() const {
+  return size() == 0;
+}
+template <class T, class Alloc>
+size_t mpmc_ring<T, Alloc>::size() const {
+  size_t head = head_.load(std::memory_order_acquire);
+  size_t tail = tail_.load(std::memory_order_acquire);
+  // claimed positions count, and so may a pop claimed after tail_ was read
+  return tail > head ? tail - head : 0;
+}
+template <class T, class Alloc>
+size_t mpmc_ring<T, Alloc>::capacity() const {
+  return mask_ + 1;
+}
+}  // namespace mrsuyi
@@ -0,0 +1,99 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "memory/unique_ptr.hpp"
+#include "mpmc_ring.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(MpmcRingTest, PushPop) {
+  mpmc_ring<int> ring(1);
+  EXPECT_EQ(2, ring.capacity());
+  mpmc_ring<int> big(6);
+  EXPECT_EQ(8, big.capacity());
+
+  int val = 0;
+  assert(!ring.pop(val));
+  assert(ring.push(1));
+  assert(ring.emplace(2));
+  assert(!ring.push(3));
+  EXPECT_EQ(2, ring.size());
+  assert(ring.pop(val));
+  EXPECT_EQ(1, val);
+
+  // batches take what is there, across the end of the ring
+  int in[] = {3, 4, 5};
+  EXPECT_EQ(1, ring.push_n(in, 3));
+  int out[4];
+  EXPECT_EQ(2, ring.pop_n(out, 4));
+  EXPECT_THAT(std::vector<int>(out, out + 2), ElementsAre(2, 3));
+  EXPECT_EQ(2, ring.push_n(in + 1, 2));
+  EXPECT_EQ(0, ring.push_n(in, 0));
+  EXPECT_EQ(2, ring.pop_n(out, 4));
+  EXPECT_THAT(std::vector<int>(out, out + 2), ElementsAre(4, 5));
+  assert(ring.empty());
+
+  mpmc_ring<unique_ptr<int>> ptrs(4);
+  assert(ptrs.push(unique_ptr<int>(new int(1))));
+  assert(ptrs.emplace(new int(2)));
+  unique_ptr<int> p;
+  assert(ptrs.pop(p));
+  EXPECT_EQ(1, *p);
+}
+
+// every value pushed by [threads] producers is popped exactly once by
+// [threads] consumers, in order per producer
+void exchange(int threads) {
+  mpmc_ring<int> ring(256);
+  const int per_thread = 20000;
+  std::vector<std::atomic<int>> seen(threads * per_thread);
+  std::vector<std::thread> pool;
+  for (int t = 0; t < threads; ++t) {
+    pool.emplace_back([&ring, t] {
+      int batch[4];
+      for (int i = 0; i < per_thread;) {
+        int n = 0;
+        for (; n < 4 && i + n < per_thread; ++n)
+          batch[n] = t * per_thread + i + n;
+        size_t pushed = t % 2 ? ring.push_n(batch, n) : ring.push(batch[0]);
+        if (!pushed)
+          std::this_thread::yield();
+        i += pushed;
+      }
+    });
+  }
+  std::atomic<int> popped(0);
+  for (int t = 0; t < threads; ++t) {
+    pool.emplace_back([&, t] {
+      std::vector<int> last(threads, -1);
+      int out[3];
+      while (popped.load() < threads * per_thread) {
+        size_t n = t % 2 ? ring.pop_n(out, 3) : ring.pop(out[0]);
+        if (!n)
+          std::this_thread::yield();
+        for (size_t i = 0; i < n; ++i) {
+          ++seen[out[i]];
+          int producer = out[i] / per_thread;
+          EXPECT_LT(last[producer], out[i]);
+          last[producer] = out[i];
+        }
+        popped += n;
+      }
+    });
+  }
+  for (auto& th : pool)
+    th.join();
+  for (auto& s : seen)
+    ASSERT_EQ(1, s.load());
+  assert(ring.empty());
+}
+
+TEST(MpmcRingTest, Threads) {
+  exchange(1);
+  exchange(4);
+  exchange(16);
+}
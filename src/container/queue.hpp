@@ -0,0 +1,204 @@
+#pragma once
+
+#include "deque.hpp"
+
+namespace mrsuyi {
+// FIFO over any [Container] with front/back, push_back & pop_front
+template <class T, class Container = mrsuyi::deque<T>>
+class queue {
+  template <class U, class C>
+  friend bool operator==(const queue<U, C>& lhs, const queue<U, C>& rhs);
+  template <class U, class C>
+  friend bool operator!=(const queue<U, C>& lhs, const queue<U, C>& rhs);
+  template <class U, class C>
+  friend bool operator<(const queue<U, C>& lhs, const queue<U, C>& rhs);
+  template <class U, class C>
+  friend bool operator<=(const queue<U, C>& lhs, const queue<U, C>& rhs);
+  template <class U, class C>
+  friend bool operator>(const queue<U, C>& lhs, const queue<U, C>& rhs);
+  template <class U, class C>
+  friend bool operator>=(const queue<U, C>& lhs, const queue<U, C>& rhs);
+
+ public:
+  using value_type = T;
+  using container_type = Container;
+  using reference = T&;
+  using const_reference = const T&;
+  using size_type = std::size_t;
+
+  // ctor & dtor
+  // default
+  explicit queue(const Container&);
+  explicit queue(Container&& = Container());
+  // copy
+  queue(const queue&);
+  // move
+  queue(queue&&);
+  // from allocator
+  template <class Alloc>
+  explicit queue(
+      const Alloc&,
+      typename std::enable_if<uses_allocator<Container, Alloc>::value>::type* =
+          0);
+  template <class Alloc>
+  queue(
+      const Container&,
+      const Alloc&,
+      typename std::enable_if<uses_allocator<Container, Alloc>::value>::type* =
+          0);
+  // dtor
+  ~queue();
+  // assginment
+  queue& operator=(const queue&);
+  queue& operator=(queue&&);
+
+  // element access
+  T& front();
+  const T& front() const;
+  T& back();
+  const T& back() const;
+
+  // capacity
+  bool empty() const;
+  size_t size() const;
+
+  // modifiers
+  void push(const T& val);
+  void push(T&& val);
+
+  template <class... Args>
+  void emplace(Args&&... args);
+
+  void pop();
+
+  void swap(queue& other);
+
+ protected:
+  Container cont_;
+};
+
+// ctor & dtor
+// default
+template <class T, class Container>
+queue<T, Container>::queue(const Container& cont) : cont_(cont) {}
+template <class T, class Container>
+queue<T, Container>::queue(Container&& cont) : cont_(move(cont)) {}
+// copy
+template <class T, class Container>
+queue<T, Container>::queue(const queue& other) : cont_(other.cont_) {}
+// move
+template <class T, class Container>
+queue<T, Container>::queue(queue&& other) : cont_(move(other.cont_)) {}
+// from allocator
+template <class T, class Container>
+template <class Alloc>
+queue<T, Container>::queue(
+    const Alloc& alloc,
+    typename std::enable_if<uses_allocator<Container, Alloc>::value>::type*)
+    : cont_(alloc) {}
+template <class T, class Container>
+template <class Alloc>
+queue<T, Container>::queue(
+    const Container& cont,
+    const Alloc& alloc,
+    typename std::enable_if<uses_allocator<Container, Alloc>::value>::type*)
+    : cont_(cont, alloc) {}
+template <class T, class Container>
+queue<T, Container>::~queue() {}
+// assignment
+template <class T, class Container>
+queue<T, Container>& queue<T, Container>::operator=(const queue& other) {
+  queue(other).swap(*this);
+  return *this;
+}
+template <class T, class Container>
+queue<T, Container>& queue<T, Container>::operator=(queue&& other) {
+  queue(move(other)).swap(*this);
+  return *this;
+}
+
+// element access
+template <class T, class Container>
+T& queue<T, Container>::front() {
+  return cont_.front();
+}
+template <class T, class Container>
+const T& queue<T, Container>::front() const {
+  return cont_.front();
+}
+template <class T, class Container>
+T& queue<T, Container>::back() {
+  return cont_.back();
+}
+template <class T, class Container>
+const T& queue<T, Container>::back() const {
+  return cont_.back();
+}
+
+// capacity
+template <class T, class Container>
+bool queue<T, Container>::empty() const {
+  return cont_.empty();
+}
+template <class T, class Container>
+size_t queue<T, Container>::size() const {
+  return cont_.size();
+}
+
+// modifiers
+template <class T, class Container>
+void queue<T, Container>::push(const T& val) {
+  cont_.push_back(val);
+}
+template <class T, class Container>
+void queue<T, Container>::push(T&& val) {
+  cont_.push_back(move(val));
+}
+template <class T, class Container>
+template <class... Args>
+void queue<T, Container>::emplace(Args&&... args) {
+  cont_.emplace_back(forward<Args>(args)...);
+}
+template <class T, class Container>
+void queue<T, Container>::pop() {
+  cont_.pop_front();
+}
+template <class T, class Container>
+void queue<T, Container>::swap(queue& other) {
+  mrsuyi::swap(cont_, other.cont_);
+}
+
+//=========================== non-member functions ===========================//
+template <class T, class Container>
+void swap(queue<T, Container>& x, queue<T, Container>& y) {
+  x.swap(y);
+}
+template <class T, class Container>
+bool operator==(const queue<T, Container>& lhs,
+                const queue<T, Container>& rhs) {
+  return lhs.cont_ == rhs.cont_;
+}
+template <class T, class Container>
+bool operator!=(const queue<T, Container>& lhs,
+                const queue<T, Container>& rhs) {
+  return lhs.cont_ != rhs.cont_;
+}
+template <class T, class Container>
+bool operator<(const queue<T, Container>& lhs, const queue<T, Container>& rhs) {
+  return lhs.cont_ < rhs.cont_;
+}
+template <class T, class Container>
+bool operator<=(const queue<T, Container>& lhs,
+                const queue<T, Container>& rhs) {
+  return lhs.cont_ <= rhs.cont_;
+}
+template <class T, class Container>
+bool operator>(const queue<T, Container>& lhs, const queue<T, Container>& rhs) {
+  return lhs.cont_ > rhs.cont_;
+}
+template <class T, class Container>
+bool operator>=(const queue<T, Container>& lhs,
+                const queue<T, Container>& rhs) {
+  return lhs.cont_ >= rhs.cont_;
+}
+}  // namespace mrsuyi
@@ -0,0 +1,38 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "list.hpp"
+#include "queue.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(QueueTest, PushPop) {
+  queue<int> que;
+  que.push(1);
+  EXPECT_EQ(1, que.front());
+  EXPECT_EQ(1, que.back());
+  que.push(2);
+  que.emplace(3);
+  EXPECT_EQ(1, que.front());
+  EXPECT_EQ(3, que.back());
+  EXPECT_EQ(3, que.size());
+  que.pop();
+  EXPECT_EQ(2, que.front());
+  que.pop();
+  que.pop();
+  EXPECT_TRUE(que.empty());
+
+  queue<int, list<int>> lst;
+  lst.push(1);
+  lst.push(2);
+  lst.pop();
+  EXPECT_EQ(2, lst.front());
+
+  queue<int> other;
+  other.push(5);
+  que.swap(other);
+  EXPECT_EQ(5, que.front());
+  EXPECT_TRUE(other.empty());
+  assert(que != other);
+}
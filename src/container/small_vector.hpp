@@ -0,0 +1,14 @@
+#pragma once
+
+#include "vector.hpp"
+
+namespace mrsuyi {
+// vector keeping up to [N] elements inline, it only allocates once it grows
+// past them. moving one moves its inline elements one by one instead of
+// stealing a pointer, so N should stay small
+template <class T,
+          size_t N,
+          class Alloc = allocator<T>,
+          class GrowthPolicy = pow2_growth_policy>
+using small_vector = vector<T, Alloc, GrowthPolicy, N>;
+}  // namespace mrsuyi
@@ -0,0 +1,115 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "memory/unique_ptr.hpp"
+#include "small_vector.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+// allocator<T> that counts its allocations
+template <class T>
+struct small_counting_allocator : allocator<T> {
+  template <class U>
+  using other = small_counting_allocator<U>;
+
+  small_counting_allocator() {}
+  template <class U>
+  small_counting_allocator(const small_counting_allocator<U>&) {}
+
+  T* allocate(size_t n) {
+    ++allocations;
+    return allocator<T>::allocate(n);
+  }
+  T* reallocate(T* p, size_t n, size_t new_n) {
+    if (!p)
+      ++allocations;
+    return allocator<T>::reallocate(p, n, new_n);
+  }
+
+  static int allocations;
+};
+template <class T>
+int small_counting_allocator<T>::allocations = 0;
+
+TEST(SmallVectorTest, Inline) {
+  using alloc = small_counting_allocator<int>;
+  small_vector<int, 4, alloc> a;
+  EXPECT_EQ(4, a.capacity());
+  for (int i = 0; i < 3; ++i)
+    a.push_back(i);
+  a.insert(a.begin(), 1, 9);
+  a.erase(a.begin());
+  a.push_back(3);
+  EXPECT_THAT(a, ElementsAre(0, 1, 2, 3));
+  EXPECT_EQ(0, alloc::allocations);
+  // spills to the heap
+  a.push_back(4);
+  EXPECT_EQ(1, alloc::allocations);
+  EXPECT_EQ(8, a.capacity());
+  EXPECT_THAT(a, ElementsAre(0, 1, 2, 3, 4));
+  // and comes back
+  a.pop_back();
+  a.pop_back();
+  a.shrink_to_fit();
+  EXPECT_EQ(4, a.capacity());
+  EXPECT_THAT(a, ElementsAre(0, 1, 2));
+
+  small_vector<int, 4, alloc> b(3, 7), c = {1, 2, 3, 4, 5};
+  EXPECT_THAT(b, ElementsAre(7, 7, 7));
+  EXPECT_EQ(2, alloc::allocations);
+  b.reserve(4);
+  b.resize(2);
+  EXPECT_EQ(2, alloc::allocations);
+}
+
+// not trivially relocatable, moved element by element
+struct tag {
+  tag(char c) : c(c) {}
+  tag(const tag& other) : c(other.c) {}
+  bool operator==(const tag& other) const { return c == other.c; }
+  char c;
+};
+
+TEST(SmallVectorTest, MoveAndSwap) {
+  small_vector<tag, 2> a = {'a', 'b'}, big = {'x', 'y', 'z'};
+  // inline elements are moved over
+  auto b = mrsuyi::move(a);
+  EXPECT_THAT(b, ElementsAre('a', 'b'));
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(2, a.capacity());
+  // heap ones are stolen
+  const tag* data = big.data();
+  auto c = mrsuyi::move(big);
+  EXPECT_EQ(data, c.data());
+  EXPECT_THAT(c, ElementsAre('x', 'y', 'z'));
+  EXPECT_TRUE(big.empty());
+
+  b.swap(c);
+  EXPECT_THAT(b, ElementsAre('x', 'y', 'z'));
+  EXPECT_THAT(c, ElementsAre('a', 'b'));
+  EXPECT_EQ(data, b.data());
+  c.swap(a);
+  EXPECT_THAT(a, ElementsAre('a', 'b'));
+  EXPECT_TRUE(c.empty());
+
+  a = b;
+  EXPECT_THAT(a, ElementsAre('x', 'y', 'z'));
+  assert(a == b);
+  c = mrsuyi::move(b);
+  EXPECT_THAT(c, ElementsAre('x', 'y', 'z'));
+  assert(c == a && c != b);
+
+  small_vector<int, 4> x = {1, 2}, y = {1, 2, 3};
+  assert(x != y && x < y && x <= y && y > x && y >= x);
+  y.pop_back();
+  assert(x == y);
+
+  // relocatable elements through reallocate
+  small_vector<unique_ptr<int>, 2> ptrs;
+  for (int i = 0; i < 10; ++i)
+    ptrs.emplace_back(new int(i));
+  EXPECT_EQ(9, *ptrs.back());
+  auto moved = mrsuyi::move(ptrs);
+  EXPECT_EQ(0, *moved.front());
+}
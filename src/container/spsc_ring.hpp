@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include "algorithm.hpp"
+#include "memory.hpp"
+#include "utility.hpp"
+
+namespace mrsuyi {
+// bounded single-producer single-consumer queue over a power-of-two ring, as
+// Lamport's: the consumer owns head_ and the producer tail_. each side also
+// keeps a private copy of the other's index and reloads it only when the ring
+// looks full or empty, so in the steady state the two threads share nothing
+// but the slots(the point of FastForward). at most one thread may push and
+// one pop at any time, and none of them ever waits
+template <class T, class Alloc = allocator<T>>
+class spsc_ring {
+ public:
+  using value_type = T;
+  using allocator_type = Alloc;
+  using size_type = size_t;
+
+  // ctor & dtor
+  // [capacity] is rounded up to a power of two
+  explicit spsc_ring(size_t capacity, const Alloc& alloc = Alloc());
+  spsc_ring(const spsc_ring&) = delete;
+  ~spsc_ring();
+
+  spsc_ring& operator=(const spsc_ring&) = delete;
+
+  // producer, false or 0 when the ring is full
+  bool push(const T& val);
+  bool push(T&& val);
+  template <class... Args>
+  bool emplace(Args&&... args);
+  // copy up to [n] elements from [first], published at once, returns how many
+  template <class InputIt>
+  size_t push_n(InputIt first, size_t n);
+
+  // consumer, false or 0 when the ring is empty
+  bool pop(T& val);
+  // move up to [n] elements to [out], freed at once, returns how many
+  template <class OutputIt>
+  size_t pop_n(OutputIt out, size_t n);
+
+  // capacity, only a snapshot while the other side runs
+  bool empty() const;
+  size_t size() const;
+  size_t capacity() const;
+
+ private:
+  // slots free to the producer, looking at head_ again if fewer than [n]
+  size_t writable(size_t tail, size_t n);
+  // slots filled for the consumer, looking at tail_ again if fewer than [n]
+  size_t readable(size_t head, size_t n);
+
+ private:
+  // read-only once built
+  T* slots_;
+  size_t mask_;
+  Alloc alloc_;
+  char pad0_[64];
+  // consumer: next slot to pop & what it last saw of tail_
+  std::atomic<size_t> head_;
+  size_t tail_seen_;
+  char pad1_[64];
+  // producer: next slot to push & what it last saw of head_
+  std::atomic<size_t> tail_;
+  size_t head_seen_;
+  char pad2_[64];
+};
+
+//================================== private =================================//
+template <class T, class Alloc>
+size_t spsc_ring<T, Alloc>::writable(size_t tail, size_t n) {
+  size_t free = mask_ + 1 - (tail - head_seen_);
+  if (free < n) {
+    head_seen_ = head_.load(std::memory_order_acquire);
+    free = mask_ + 1 - (tail - head_seen_);
+  }
+  return free;
+}
+template <class T, class Alloc>
+size_t spsc_ring<T, Alloc>::readable(size_t head, size_t n) {
+  size_t filled = tail_seen_ - head;
+  if (filled < n) {
+    tail_seen_ = tail_.load(std::memory_order_acquire);
+    filled = tail_seen_ - head;
+  }
+  return filled;
+}
+
+//=================================== basic ==================================//
+template <class T, class Alloc>
+spsc_ring<T, Alloc>::spsc_ring(size_t capacity, const Alloc& alloc)
+    : alloc_(alloc), head_(0), tail_seen_(0), tail_(0), head_seen_(0) {
+  size_t count = 1;
+  for (; count < capacity; count *= 2)
+    ;
+  slots_ = alloc_.allocate(count);
+  mask_ = count - 1;
+}
+template <class T, class Alloc>
+spsc_ring<T, Alloc>::~spsc_ring() {
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  for (size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i)
+    destroy_at(&slots_[i & mask_]);
+  alloc_.deallocate(slots_, mask_ + 1);
+}
+
+//================================= producer =================================//
+template <class T, class Alloc>
+bool spsc_ring<T, Alloc>::push(const T& val) {
+  return emplace(val);
+}
+template <class T, class Alloc>
+bool spsc_ring<T, Alloc>::push(T&& val) {
+  return emplace(mrsuyi::move(val));
+}
+template <class T, class Alloc>
+template <class... Args>
+bool spsc_ring<T, Alloc>::emplace(Args&&... args) {
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  if (!writable(tail, 1))
+    return false;
+  construct(&slots_[tail & mask_], mrsuyi::forward<Args>(args)...);
+  tail_.store(tail + 1, std::memory_order_release);
+  return true;
+}
+template <class T, class Alloc>
+template <class InputIt>
+size_t spsc_ring<T, Alloc>::push_n(InputIt first, size_t n) {
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  n = min(n, writable(tail, n));
+  for (size_t i = 0; i < n; ++i, ++first)
+    construct(&slots_[(tail + i) & mask_], *first);
+  tail_.store(tail + n, std::memory_order_release);
+  return n;
+}
+
+//================================= consumer =================================//
+template <class T, class Alloc>
+bool spsc_ring<T, Alloc>::pop(T& val) {
+  size_t head = head_.load(std::memory_order_relaxed);
+  if (!readable(head, 1))
+    return false;
+  T& slot = slots_[head & mask_];
+  val = mrsuyi::move(slot);
+  destroy_at(&slot);
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+template <class T, class Alloc>
+template <class OutputIt>
+size_t spsc_ring<T, Alloc>::pop_n(OutputIt out, size_t n) {
+  size_t head = head_.load(std::memory_order_relaxed);
+  n = min(n, readable(head, n));
+  for (size_t i = 0; i < n; ++i, ++out) {
+    T& slot = slots_[(head + i) & mask_];
+    *out = mrsuyi::move(slot);
+    destroy_at(&slot);
+  }
+  head_.store(head + n, std::memory_order_release);
+  return n;
+}
+
+//================================= capacity =================================//
+template <class T, class Alloc>
+bool spsc_ring<T, Alloc>::empty() const {
+  return size() == 0;
+}
+template <class T, class Alloc>
+size_t spsc_ring<T, Alloc>::size() const {
+  // head_ first, tail_ can only have moved further since
+  size_t head = head_.load(std::memory_order_acquire);
+  return tail_.load(std::memory_order_acquire) - head;
+}
+template <class T, class Alloc>
+size_t spsc_ring<T, Alloc>::capacity() const {
+  return mask_ + 1;
+}
+}  // namespace mrsuyi
@@ -0,0 +1,72 @@
+#include <thread>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "memory/unique_ptr.hpp"
+#include "spsc_ring.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(SpscRingTest, PushPop) {
+  spsc_ring<int> ring(5);
+  EXPECT_EQ(8, ring.capacity());
+  assert(ring.empty());
+  int val = 0;
+  assert(!ring.pop(val));
+
+  for (int i = 0; i < 8; ++i)
+    assert(ring.push(i));
+  assert(!ring.push(8));
+  EXPECT_EQ(8, ring.size());
+  assert(ring.pop(val));
+  EXPECT_EQ(0, val);
+  assert(ring.emplace(8));
+
+  // batches wrap around the end of the ring
+  int out[16];
+  EXPECT_EQ(4, ring.pop_n(out, 4));
+  EXPECT_THAT(std::vector<int>(out, out + 4), ElementsAre(1, 2, 3, 4));
+  int in[] = {9, 10, 11, 12, 13, 14};
+  EXPECT_EQ(4, ring.push_n(in, 6));
+  EXPECT_EQ(0, ring.push_n(in, 1));
+  EXPECT_EQ(8, ring.pop_n(out, 16));
+  EXPECT_THAT(std::vector<int>(out, out + 8),
+              ElementsAre(5, 6, 7, 8, 9, 10, 11, 12));
+  EXPECT_EQ(0, ring.pop_n(out, 16));
+
+  // elements left are destroyed with the ring
+  spsc_ring<unique_ptr<int>> ptrs(2);
+  assert(ptrs.push(unique_ptr<int>(new int(1))));
+  assert(ptrs.emplace(new int(2)));
+  unique_ptr<int> p;
+  assert(ptrs.pop(p));
+  EXPECT_EQ(1, *p);
+}
+
+TEST(SpscRingTest, Threads) {
+  spsc_ring<int> ring(64);
+  const int count = 200000;
+  std::thread producer([&ring] {
+    int batch[7];
+    for (int i = 0; i < count;) {
+      int n = 0;
+      for (; n < 7 && i + n < count; ++n)
+        batch[n] = i + n;
+      size_t pushed = i % 2 ? ring.push_n(batch, n) : ring.push(i);
+      if (!pushed)
+        std::this_thread::yield();
+      i += pushed;
+    }
+  });
+  int expected = 0, out[5];
+  while (expected < count) {
+    size_t n = ring.pop_n(out, 5);
+    if (!n)
+      std::this_thread::yield();
+    for (size_t i = 0; i < n; ++i)
+      ASSERT_EQ(expected++, out[i]);
+  }
+  producer.join();
+  assert(ring.empty());
+}
@@ -147,10 +147,12 @@ stack<T, Container>::~stack() {}
 template <class T, class Container>
 stack<T, Container>& stack<T, Container>::operator=(const stack& other) {
   stack(other).swap(*this);
+  return *this;
 }
 template <class T, class Container>
 stack<T, Container>& stack<T, Container>::operator=(stack&& other) {
   stack(move(other)).swap(*this);
+  return *this;
 }
 
 // element access
@@ -163,6 +165,10 @@ const T& stack<T, Container>::top() const {
   return cont_.back();
 }
 template <class T, class Container>
+bool stack<T, Container>::empty() const {
+  return cont_.empty();
+}
+template <class T, class Container>
 size_t stack<T, Container>::size() const {
   return cont_.size();
 }
@@ -187,7 +193,7 @@ void stack<T, Container>::pop() {
 }
 template <class T, class Container>
 void stack<T, Container>::swap(stack& other) {
-  swap(cont_, other.cont_);
+  mrsuyi::swap(cont_, other.cont_);
 }
 
 //=========================== non-member functions ===========================//
@@ -1,6 +1,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#include "deque.hpp"
 #include "stack.hpp"
 
 using namespace mrsuyi;
@@ -22,3 +23,17 @@ TEST(StackTest, PushPop) {
   stk.pop();
   EXPECT_EQ(0, stk.size());
 }
+
+TEST(StackTest, Deque) {
+  stack<int, deque<int>> stk;
+  for (int i = 0; i < 10000; ++i)
+    stk.push(i);
+  EXPECT_EQ(9999, stk.top());
+  stk.pop();
+  EXPECT_EQ(9998, stk.top());
+  EXPECT_EQ(9999, stk.size());
+  stack<int, deque<int>> other;
+  other.swap(stk);
+  EXPECT_TRUE(stk.empty());
+  EXPECT_EQ(9998, other.top());
+}
@@ -27,12 +27,13 @@ struct avl_node
     }
 };
 
-template <class T, class Compare = mrsuyi::less<T>>
-class avl : public bst<T, avl_node<T>, Compare>
+template <class T, class Compare = mrsuyi::less<T>,
+          class Alloc = allocator<T>>
+class avl : public bst<T, avl_node<T>, Compare, Alloc>
 {
 protected:
     using node = avl_node<T>;
-    using bst_t = bst<T, avl_node<T>, Compare>;
+    using bst_t = bst<T, avl_node<T>, Compare, Alloc>;
 
     // reset height
     void reset_height(node* n);
@@ -52,12 +53,14 @@ public:
 
     // ctor & dtor
     // default
-    avl(const Compare& = Compare());
+    avl(const Compare& = Compare(), const Alloc& = Alloc());
     // range
     template <class InputIter>
-    avl(InputIter first, InputIter last, const Compare& cmp = Compare());
+    avl(InputIter first, InputIter last, const Compare& cmp = Compare(),
+        const Alloc& alloc = Alloc());
     // initializer_list
-    avl(std::initializer_list<T>, const Compare& = Compare());
+    avl(std::initializer_list<T>, const Compare& = Compare(),
+        const Alloc& = Alloc());
     // dtor
     ~avl();
 
@@ -75,18 +78,18 @@ public:
 
 //=============================== protected ==================================//
 // reset height
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 void
-avl<T, Compare>::reset_height(node* n)
+avl<T, Compare, Alloc>::reset_height(node* n)
 {
     int hl = n->l ? n->l->height : -1;
     int hr = n->r ? n->r->height : -1;
     n->height = max(hl, hr) + 1;
 }
 // check, if balance, return
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 int
-avl<T, Compare>::check(node* n) const
+avl<T, Compare, Alloc>::check(node* n) const
 {
     int hl = n->l ? n->l->height : -1;
     int hr = n->r ? n->r->height : -1;
@@ -94,9 +97,9 @@ avl<T, Compare>::check(node* n) const
     return max(hl, hr) + 1;
 }
 // balance
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 void
-avl<T, Compare>::balance(node* n)
+avl<T, Compare, Alloc>::balance(node* n)
 {
     node* nl = n->l;
     node* nr = n->r;
@@ -132,9 +135,9 @@ avl<T, Compare>::balance(node* n)
 }
 
 // spin-left (parent & right-child)
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 void
-avl<T, Compare>::spinl(node* old_root)
+avl<T, Compare, Alloc>::spinl(node* old_root)
 {
     node* new_root = old_root->l;
     //
@@ -151,9 +154,9 @@ avl<T, Compare>::spinl(node* old_root)
     reset_height(new_root);
 }
 // spin-right (parent & left-child)
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 void
-avl<T, Compare>::spinr(node* old_root)
+avl<T, Compare, Alloc>::spinr(node* old_root)
 {
     node* new_root = old_root->r;
     //
@@ -172,47 +175,50 @@ avl<T, Compare>::spinr(node* old_root)
 
 //============================== ctor & dtor =================================//
 // default
-template <class T, class Compare>
-avl<T, Compare>::avl(const Compare& cmp) : bst_t(cmp)
+template <class T, class Compare, class Alloc>
+avl<T, Compare, Alloc>::avl(const Compare& cmp, const Alloc& alloc)
+    : bst_t(cmp, alloc)
 {
 }
 // range
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 template <class InputIt>
-avl<T, Compare>::avl(InputIt first, InputIt last, const Compare& cmp)
-    : bst_t(cmp)
+avl<T, Compare, Alloc>::avl(InputIt first, InputIt last, const Compare& cmp,
+                                const Alloc& alloc)
+    : bst_t(cmp, alloc)
 {
     for (; first != last; ++first) insert(*first);
 }
 // range
-template <class T, class Compare>
-avl<T, Compare>::avl(std::initializer_list<T> il, const Compare& cmp)
-    : avl(il.begin(), il.end(), cmp)
+template <class T, class Compare, class Alloc>
+avl<T, Compare, Alloc>::avl(std::initializer_list<T> il, const Compare& cmp,
+                                const Alloc& alloc)
+    : avl(il.begin(), il.end(), cmp, alloc)
 {
 }
 // dtor
-template <class T, class Compare>
-avl<T, Compare>::~avl()
+template <class T, class Compare, class Alloc>
+avl<T, Compare, Alloc>::~avl()
 {
 }
 
 //================================ modifiers =================================//
 // insert
-template <class T, class Compare>
-pair<typename avl<T, Compare>::iterator, bool>
-avl<T, Compare>::insert(const T& t)
+template <class T, class Compare, class Alloc>
+pair<typename avl<T, Compare, Alloc>::iterator, bool>
+avl<T, Compare, Alloc>::insert(const T& t)
 {
     insert(move(T(t)));
 }
-template <class T, class Compare>
-pair<typename avl<T, Compare>::iterator, bool>
-avl<T, Compare>::insert(T&& t)
+template <class T, class Compare, class Alloc>
+pair<typename avl<T, Compare, Alloc>::iterator, bool>
+avl<T, Compare, Alloc>::insert(T&& t)
 {
     node** mount = &(bst_t::root_);
     node* parent = nullptr;
     if (bst_t::insert_pos(t, mount, parent))
     {
-        *mount = new node(mrsuyi::move(t));
+        *mount = bst_t::new_node(mrsuyi::move(t));
         (*mount)->parent = parent;
         ++bst_t::size_;
 
@@ -235,9 +241,9 @@ avl<T, Compare>::insert(T&& t)
         return {*mount, false};
 }
 // erase
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 size_t
-avl<T, Compare>::erase(const T& t)
+avl<T, Compare, Alloc>::erase(const T& t)
 {
     auto it = bst_t::find(t);
     if (it != bst_t::end())
@@ -247,9 +253,9 @@ avl<T, Compare>::erase(const T& t)
     }
     return 0;
 }
-template <class T, class Compare>
-typename avl<T, Compare>::iterator
-avl<T, Compare>::erase(iterator it)
+template <class T, class Compare, class Alloc>
+typename avl<T, Compare, Alloc>::iterator
+avl<T, Compare, Alloc>::erase(iterator it)
 {
     node* balance_pos;
     if (it.node_->l)
@@ -308,14 +314,14 @@ avl<T, Compare>::erase(iterator it)
             balance_pos = parent;
         }
     }
-    delete it.node_;
+    bst_t::del_node(it.node_);
     --bst_t::size_;
 }
 
 //======================== mrsuyi-special-functions :D =======================//
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 bool
-avl<T, Compare>::valid() const
+avl<T, Compare, Alloc>::valid() const
 {
     std::function<int(node*)> check = [&check](node* n) {
         if (!n) return -1;
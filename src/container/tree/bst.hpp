@@ -22,10 +22,13 @@ struct bst_node
     }
 };
 
-template <class T, class Node = bst_node<T>, class Compare = mrsuyi::less<T>>
+template <class T, class Node = bst_node<T>, class Compare = mrsuyi::less<T>,
+          class Alloc = allocator<T>>
 class bst
 {
 protected:
+    using node_allocator = typename Alloc::template other<Node>;
+
     template <class E>
     class iter;
     template <class E>
@@ -43,6 +46,11 @@ protected:
     Node* search(const T& t) const;
     // replace
     void replace(Node* cur, Node* tar);
+    // allocate & construct a node from [args]
+    template <class... Args>
+    Node* new_node(Args&&... args);
+    // destroy & deallocate [n]
+    void del_node(Node* n);
 
 public:
     using iterator = iter<T>;
@@ -52,12 +60,14 @@ public:
 
     // ctor & dtor
     // default
-    bst(const Compare& cmp = Compare());
+    bst(const Compare& cmp = Compare(), const Alloc& alloc = Alloc());
     // range
     template <class InputIt>
-    bst(InputIt first, InputIt last, const Compare& cmp = Compare());
+    bst(InputIt first, InputIt last, const Compare& cmp = Compare(),
+        const Alloc& alloc = Alloc());
     // initializer_list
-    bst(std::initializer_list<T>, const Compare& = Compare());
+    bst(std::initializer_list<T>, const Compare& = Compare(),
+        const Alloc& = Alloc());
     // dtor
     ~bst();
 
@@ -98,14 +108,15 @@ public:
     Node* root_;
     Compare cmp_;
     size_t size_;
+    node_allocator alloc_;
 };
 
 //============================== iter & riter ================================//
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 template <class E>
-class bst<T, Node, Compare>::iter
+class bst<T, Node, Compare, Alloc>::iter
 {
-    friend class bst<T, Node, Compare>;
+    friend class bst<T, Node, Compare, Alloc>;
 
 public:
     using value_type = E;
@@ -173,11 +184,11 @@ public:
     Node* node_;
 };
 
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 template <class E>
-class bst<T, Node, Compare>::riter : public iter<E>
+class bst<T, Node, Compare, Alloc>::riter : public iter<E>
 {
-    friend class bst<T, Node, Compare>;
+    friend class bst<T, Node, Compare, Alloc>;
 
 public:
     riter() : iter<E>() {}
@@ -189,9 +200,9 @@ public:
 };
 
 //=============================== protected ==================================//
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 bool
-bst<T, Node, Compare>::insert_pos(const T& t, Node**& _mount,
+bst<T, Node, Compare, Alloc>::insert_pos(const T& t, Node**& _mount,
                                   Node*& _parent) const
 {
     while (*_mount)
@@ -206,34 +217,34 @@ bst<T, Node, Compare>::insert_pos(const T& t, Node**& _mount,
     }
     return true;
 }
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 Node**
-bst<T, Node, Compare>::mount_pos(Node* n)
+bst<T, Node, Compare, Alloc>::mount_pos(Node* n)
 {
     Node** res = &root_;
     if (n->parent)
         res = (n->parent->l == n) ? &(n->parent->l) : &(n->parent->r);
     return res;
 }
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 Node*
-bst<T, Node, Compare>::min(Node* root) const
+bst<T, Node, Compare, Alloc>::min(Node* root) const
 {
     if (!root) return nullptr;
     while (root->l) root = root->l;
     return root;
 }
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 Node*
-bst<T, Node, Compare>::max(Node* root) const
+bst<T, Node, Compare, Alloc>::max(Node* root) const
 {
     if (!root) return nullptr;
     while (root->r) root = root->r;
     return root;
 }
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 void
-bst<T, Node, Compare>::replace(Node* cur, Node* tar)
+bst<T, Node, Compare, Alloc>::replace(Node* cur, Node* tar)
 {
     *mount_pos(cur) = tar;
     tar->parent = cur->parent;
@@ -242,9 +253,9 @@ bst<T, Node, Compare>::replace(Node* cur, Node* tar)
     tar->r = cur->r;
     if (tar->r) tar->r->parent = tar;
 }
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 Node*
-bst<T, Node, Compare>::search(const T& t) const
+bst<T, Node, Compare, Alloc>::search(const T& t) const
 {
     for (Node* n = root_; n;)
     {
@@ -258,30 +269,49 @@ bst<T, Node, Compare>::search(const T& t) const
     return nullptr;
 }
 
+template <class T, class Node, class Compare, class Alloc>
+template <class... Args>
+Node*
+bst<T, Node, Compare, Alloc>::new_node(Args&&... args)
+{
+    Node* n = alloc_.allocate(1);
+    new (static_cast<void*>(n)) Node(mrsuyi::forward<Args>(args)...);
+    return n;
+}
+template <class T, class Node, class Compare, class Alloc>
+void
+bst<T, Node, Compare, Alloc>::del_node(Node* n)
+{
+    n->~Node();
+    alloc_.deallocate(n, 1);
+}
+
 //============================== ctor & dtor =================================//
 // default
-template <class T, class Node, class Compare>
-bst<T, Node, Compare>::bst(const Compare& cmp)
-    : root_(nullptr), cmp_(cmp), size_(0)
+template <class T, class Node, class Compare, class Alloc>
+bst<T, Node, Compare, Alloc>::bst(const Compare& cmp, const Alloc& alloc)
+    : root_(nullptr), cmp_(cmp), size_(0), alloc_(alloc)
 {
 }
 // range
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 template <class InputIt>
-bst<T, Node, Compare>::bst(InputIt first, InputIt last, const Compare& cmp)
-    : root_(nullptr), size_(0), cmp_(cmp)
+bst<T, Node, Compare, Alloc>::bst(InputIt first, InputIt last,
+                                  const Compare& cmp, const Alloc& alloc)
+    : root_(nullptr), cmp_(cmp), size_(0), alloc_(alloc)
 {
     for (; first != last; ++first) insert(*first);
 }
 // initializer_list
-template <class T, class Node, class Compare>
-bst<T, Node, Compare>::bst(std::initializer_list<T> il, const Compare& cmp)
-    : bst(il.begin(), il.end(), cmp)
+template <class T, class Node, class Compare, class Alloc>
+bst<T, Node, Compare, Alloc>::bst(std::initializer_list<T> il,
+                                  const Compare& cmp, const Alloc& alloc)
+    : bst(il.begin(), il.end(), cmp, alloc)
 {
 }
 // dtor
-template <class T, class Node, class Compare>
-bst<T, Node, Compare>::~bst()
+template <class T, class Node, class Compare, class Alloc>
+bst<T, Node, Compare, Alloc>::~bst()
 {
     vector<Node*> dels;
     dels.reserve(size_ / 2);
@@ -295,129 +325,129 @@ bst<T, Node, Compare>::~bst()
         if (n->l) dels.push_back(n->l);
         if (n->r) dels.push_back(n->r);
 
-        delete n;
+        del_node(n);
     }
 }
 
 //================================ capacity ==================================//
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 size_t
-bst<T, Node, Compare>::size() const
+bst<T, Node, Compare, Alloc>::size() const
 {
     return size_;
 }
 
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 bool
-bst<T, Node, Compare>::empty() const
+bst<T, Node, Compare, Alloc>::empty() const
 {
     return size() == 0;
 }
 
 //================================= iterators ================================//
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::iterator
-bst<T, Node, Compare>::begin() noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::iterator
+bst<T, Node, Compare, Alloc>::begin() noexcept
 {
     return iterator(min(root_));
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::iterator
-bst<T, Node, Compare>::end() noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::iterator
+bst<T, Node, Compare, Alloc>::end() noexcept
 {
     return iterator(nullptr);
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::const_iterator
-bst<T, Node, Compare>::begin() const noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::const_iterator
+bst<T, Node, Compare, Alloc>::begin() const noexcept
 {
     return const_iterator(min(root_));
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::const_iterator
-bst<T, Node, Compare>::end() const noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::const_iterator
+bst<T, Node, Compare, Alloc>::end() const noexcept
 {
     return const_iterator(nullptr);
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::const_iterator
-bst<T, Node, Compare>::cbegin() const noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::const_iterator
+bst<T, Node, Compare, Alloc>::cbegin() const noexcept
 {
     return const_iterator(min(root_));
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::const_iterator
-bst<T, Node, Compare>::cend() const noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::const_iterator
+bst<T, Node, Compare, Alloc>::cend() const noexcept
 {
     return const_iterator(nullptr);
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::reverse_iterator
-bst<T, Node, Compare>::rbegin() noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::reverse_iterator
+bst<T, Node, Compare, Alloc>::rbegin() noexcept
 {
     return reverse_iterator(max(root_));
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::reverse_iterator
-bst<T, Node, Compare>::rend() noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::reverse_iterator
+bst<T, Node, Compare, Alloc>::rend() noexcept
 {
     return reverse_iterator(nullptr);
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::const_reverse_iterator
-bst<T, Node, Compare>::rbegin() const noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::const_reverse_iterator
+bst<T, Node, Compare, Alloc>::rbegin() const noexcept
 {
     return const_reverse_iterator(max(root_));
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::const_reverse_iterator
-bst<T, Node, Compare>::rend() const noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::const_reverse_iterator
+bst<T, Node, Compare, Alloc>::rend() const noexcept
 {
     return const_reverse_iterator(nullptr);
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::const_reverse_iterator
-bst<T, Node, Compare>::crbegin() const noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::const_reverse_iterator
+bst<T, Node, Compare, Alloc>::crbegin() const noexcept
 {
     return const_reverse_iterator(max(root_));
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::const_reverse_iterator
-bst<T, Node, Compare>::crend() const noexcept
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::const_reverse_iterator
+bst<T, Node, Compare, Alloc>::crend() const noexcept
 {
     return const_reverse_iterator(nullptr);
 }
 
 //================================== lookup ==================================//
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::iterator
-bst<T, Node, Compare>::find(const T& t)
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::iterator
+bst<T, Node, Compare, Alloc>::find(const T& t)
 {
     return iterator(search(t));
 }
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::const_iterator
-bst<T, Node, Compare>::find(const T& t) const
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::const_iterator
+bst<T, Node, Compare, Alloc>::find(const T& t) const
 {
     return const_iterator(search(t));
 }
 
 //=============================== modifiers ==================================//
-template <class T, class Node, class Compare>
-pair<typename bst<T, Node, Compare>::iterator, bool>
-bst<T, Node, Compare>::insert(const T& t)
+template <class T, class Node, class Compare, class Alloc>
+pair<typename bst<T, Node, Compare, Alloc>::iterator, bool>
+bst<T, Node, Compare, Alloc>::insert(const T& t)
 {
     insert(mrsuyi::move(T(t)));
 }
-template <class T, class Node, class Compare>
-pair<typename bst<T, Node, Compare>::iterator, bool>
-bst<T, Node, Compare>::insert(T&& t)
+template <class T, class Node, class Compare, class Alloc>
+pair<typename bst<T, Node, Compare, Alloc>::iterator, bool>
+bst<T, Node, Compare, Alloc>::insert(T&& t)
 {
     Node** mount = &root_;
     Node* parent = nullptr;
     if (insert_pos(t, mount, parent))
     {
-        *mount = new Node(mrsuyi::move(t));
+        *mount = new_node(mrsuyi::move(t));
         (*mount)->parent = parent;
         ++size_;
         return {*mount, true};
@@ -427,9 +457,9 @@ bst<T, Node, Compare>::insert(T&& t)
 }
 
 // erase
-template <class T, class Node, class Compare>
-typename bst<T, Node, Compare>::iterator
-bst<T, Node, Compare>::erase(iterator it)
+template <class T, class Node, class Compare, class Alloc>
+typename bst<T, Node, Compare, Alloc>::iterator
+bst<T, Node, Compare, Alloc>::erase(iterator it)
 {
     if (it.node_->l)
     {
@@ -449,12 +479,12 @@ bst<T, Node, Compare>::erase(iterator it)
     {
         *mount_pos(it.node_) = nullptr;
     }
-    delete it.node_;
+    del_node(it.node_);
     --size_;
 }
-template <class T, class Node, class Compare>
+template <class T, class Node, class Compare, class Alloc>
 size_t
-bst<T, Node, Compare>::erase(const T& t)
+bst<T, Node, Compare, Alloc>::erase(const T& t)
 {
     auto it = find(t);
     if (it != end())
@@ -466,8 +496,8 @@ bst<T, Node, Compare>::erase(const T& t)
 }
 
 //======================== mrsuyi-special-functions :D =======================//
-template <class T, class Node, class Compare>
-string bst<T, Node, Compare>::graph(string (*to_string)(T)) const
+template <class T, class Node, class Compare, class Alloc>
+string bst<T, Node, Compare, Alloc>::graph(string (*to_string)(T)) const
 {
     vector<Node*> nodes;
     vector<vector<string>> vals;
@@ -23,15 +23,16 @@ struct rb_node
     }
 };
 
-template <class T, class Compare = mrsuyi::less<T>>
-class rb : public bst<T, rb_node<T>, Compare>
+template <class T, class Compare = mrsuyi::less<T>,
+          class Alloc = allocator<T>>
+class rb : public bst<T, rb_node<T>, Compare, Alloc>
 {
 protected:
     constexpr static bool RED = true;
     constexpr static bool BLACK = false;
 
     using node = rb_node<T>;
-    using bst_t = bst<T, rb_node<T>, Compare>;
+    using bst_t = bst<T, rb_node<T>, Compare, Alloc>;
 
     // spin
     void spinl(node* old_root);
@@ -45,12 +46,14 @@ public:
 
     // ctor & dtor
     // default
-    rb(const Compare& = Compare());
+    rb(const Compare& = Compare(), const Alloc& = Alloc());
     // range
     template <class InputIter>
-    rb(InputIter first, InputIter last, const Compare& cmp = Compare());
+    rb(InputIter first, InputIter last, const Compare& cmp = Compare(),
+       const Alloc& alloc = Alloc());
     // initializer_list
-    rb(std::initializer_list<T>, const Compare& = Compare());
+    rb(std::initializer_list<T>, const Compare& = Compare(),
+       const Alloc& = Alloc());
     // dtor
     ~rb();
 
@@ -68,46 +71,50 @@ public:
 
 //=============================== protected ==================================//
 // default
-template <class T, class Compare>
-rb<T, Compare>::rb(const Compare& cmp) : bst_t(cmp)
+template <class T, class Compare, class Alloc>
+rb<T, Compare, Alloc>::rb(const Compare& cmp, const Alloc& alloc)
+    : bst_t(cmp, alloc)
 {
 }
 // range
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 template <class InputIt>
-rb<T, Compare>::rb(InputIt first, InputIt last, const Compare& cmp) : bst_t(cmp)
+rb<T, Compare, Alloc>::rb(InputIt first, InputIt last, const Compare& cmp,
+                              const Alloc& alloc)
+    : bst_t(cmp, alloc)
 {
     for (; first != last; ++first) insert(*first);
 }
 // range
-template <class T, class Compare>
-rb<T, Compare>::rb(std::initializer_list<T> il, const Compare& cmp)
-    : rb(il.begin(), il.end(), cmp)
+template <class T, class Compare, class Alloc>
+rb<T, Compare, Alloc>::rb(std::initializer_list<T> il, const Compare& cmp,
+                              const Alloc& alloc)
+    : rb(il.begin(), il.end(), cmp, alloc)
 {
 }
 // dtor
-template <class T, class Compare>
-rb<T, Compare>::~rb()
+template <class T, class Compare, class Alloc>
+rb<T, Compare, Alloc>::~rb()
 {
 }
 
 //================================ modifiers =================================//
 // insert
-template <class T, class Compare>
-pair<typename rb<T, Compare>::iterator, bool>
-rb<T, Compare>::insert(const T& t)
+template <class T, class Compare, class Alloc>
+pair<typename rb<T, Compare, Alloc>::iterator, bool>
+rb<T, Compare, Alloc>::insert(const T& t)
 {
     insert(move(T(t)));
 }
-template <class T, class Compare>
-pair<typename rb<T, Compare>::iterator, bool>
-rb<T, Compare>::insert(T&& t)
+template <class T, class Compare, class Alloc>
+pair<typename rb<T, Compare, Alloc>::iterator, bool>
+rb<T, Compare, Alloc>::insert(T&& t)
 {
     node** mount = &(bst_t::root_);
     node* parent = nullptr;
     if (bst_t::insert_pos(t, mount, parent))
     {
-        *mount = new node(mrsuyi::move(t));
+        *mount = bst_t::new_node(mrsuyi::move(t));
         (*mount)->parent = parent;
         ++bst_t::size_;
         return {*mount, true};
@@ -116,9 +123,9 @@ rb<T, Compare>::insert(T&& t)
         return {*mount, false};
 }
 // erase
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 size_t
-rb<T, Compare>::erase(const T& t)
+rb<T, Compare, Alloc>::erase(const T& t)
 {
     auto it = bst_t::find(t);
     if (it != bst_t::end())
@@ -128,9 +135,9 @@ rb<T, Compare>::erase(const T& t)
     }
     return 0;
 }
-template <class T, class Compare>
-typename rb<T, Compare>::iterator
-rb<T, Compare>::erase(iterator it)
+template <class T, class Compare, class Alloc>
+typename rb<T, Compare, Alloc>::iterator
+rb<T, Compare, Alloc>::erase(iterator it)
 {
     node* balance_pos;
     if (it.node_->l)
@@ -156,14 +163,14 @@ rb<T, Compare>::erase(iterator it)
         balance_pos = it.node_->parent;
         *(bst_t::mount_pos(it.node_)) = nullptr;
     }
-    delete it.node_;
+    bst_t::del_node(it.node_);
     --bst_t::size_;
 }
 
 //======================== mrsuyi-special-functions :D =======================//
-template <class T, class Compare>
+template <class T, class Compare, class Alloc>
 bool
-rb<T, Compare>::valid() const
+rb<T, Compare, Alloc>::valid() const
 {
     return true;
 }
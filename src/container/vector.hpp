@@ -11,8 +11,60 @@
 #include "utility.hpp"
 
 namespace mrsuyi {
-template <class T, class Alloc = allocator<T>>
-class vector {
+//============================== growth policies =============================//
+// growth policies pick the capacity to grow to when [need] elements of [size]
+// bytes don't fit the current capacity [cap]
+// the next power of two >= [need]
+struct pow2_growth_policy {
+  static size_t capacity(size_t, size_t need, size_t) {
+    size_t cap = 1U;
+    for (; cap < need; cap *= 2)
+      ;
+    return cap;
+  }
+};
+// [Num] / [Den] times the current capacity, e.g. <3, 2> lets a freed block be
+// reused by later growth while <2, 1> copies less often
+template <size_t Num, size_t Den>
+struct factor_growth_policy {
+  static size_t capacity(size_t cap, size_t need, size_t) {
+    return max(need, cap / Den * Num + cap % Den * Num / Den);
+  }
+};
+// geometric up to [Step] bytes, then in multiples of [Step] bytes, so that a
+// huge vector never asks for twice what it holds
+template <size_t Step>
+struct step_growth_policy {
+  static size_t capacity(size_t cap, size_t need, size_t size) {
+    size_t step = max(size_t(1), Step / size);
+    if (need <= step)
+      return pow2_growth_policy::capacity(cap, need, size);
+    return (need + step - 1) / step * step;
+  }
+};
+
+// raw room for [N] elements inside the vector itself
+template <class T, size_t N>
+class __vector_inline {
+ protected:
+  T* inline_data() { return reinterpret_cast<T*>(&buf_); }
+
+ private:
+  typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type buf_;
+};
+template <class T>
+class __vector_inline<T, 0> {
+ protected:
+  T* inline_data() { return nullptr; }
+};
+
+// the first [N] elements(none by default) are kept inline, a vector only
+// takes memory from [Alloc] once it outgrows them. see small_vector
+template <class T,
+          class Alloc = allocator<T>,
+          class GrowthPolicy = pow2_growth_policy,
+          size_t N = 0>
+class vector : protected __vector_inline<T, N> {
   // typedefs
  public:
   using value_type = T;
@@ -131,9 +183,21 @@ class vector {
   void push_back(T&& val);
   template <class... Args>
   void emplace_back(Args&&... args);
+  // the same without the capacity check, size() < capacity() must hold, e.g.
+  // after a reserve
+  void push_back_unchecked(const T& val);
+  void push_back_unchecked(T&& val);
+  template <class... Args>
+  void unchecked_emplace_back(Args&&... args);
   void pop_back();
 
   void resize(size_t size, T val = T());
+  // new elements are default-initialized, i.e. left as they are for trivial
+  // types, for buffers about to be overwritten anyway
+  void resize_default_init(size_t size);
+  // grow by [n] default-initialized elements and return the first of them,
+  // e.g. read(fd, v.append_uninitialized(n), n)
+  T* append_uninitialized(size_t n);
 
   void swap(vector& x);
 
@@ -142,83 +206,136 @@ class vector {
   size_t overmeasure(size_t);
   // migrate to a new block of mem
   void migrate(size_t);
+  // relocatable elements over an allocator that can resize a block in place
+  // skip the move loop, and large blocks may not be copied at all
+  using in_place = std::integral_constant<
+      bool,
+      is_trivially_relocatable<T>::value && has_reallocate<Alloc>::value>;
+  void migrate(size_t, std::true_type);
+  void migrate(size_t, std::false_type);
+  // whether [p] is the inline buffer
+  bool is_inline(const T* p);
+  // give [p] of capacity [cap] back to the allocator, unless it is inline
+  void release(T* p, size_t cap);
+  // take over the elements of [x] and leave it empty, *this must hold no
+  // memory of its own
+  void take(vector& x);
   // embed a block of mem inside current mem. new-alloc may happen
   void embed(T*, size_t);
 
  protected:
-  T *bgn_ = nullptr, *end_ = nullptr, *cap_ = nullptr;
+  T* bgn_ = this->inline_data();
+  T* end_ = bgn_;
+  T* cap_ = bgn_ + N;
   Alloc alloc_;
 };
 
 //================================ private ===================================//
 //
-template <class T, class Alloc>
-size_t vector<T, Alloc>::overmeasure(size_t size) {
-  size_t cap = 1U;
-  for (; cap < size; cap *= 2)
-    ;
-  return cap;
+template <class T, class Alloc, class G, size_t N>
+size_t vector<T, Alloc, G, N>::overmeasure(size_t size) {
+  return G::capacity(capacity(), size, sizeof(T));
 }
 //
-template <class T, class Alloc>
-void vector<T, Alloc>::migrate(size_t cap) {
-  auto new_mem = alloc_.allocate(cap);
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::migrate(size_t cap) {
+  migrate(cap, in_place());
+}
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::migrate(size_t cap, std::true_type) {
+  if (N && (is_inline(bgn_) || cap <= N))
+    return migrate(cap, std::false_type());
+  size_t n = size();
+  bgn_ = alloc_.reallocate(bgn_, capacity(), cap);
+  end_ = bgn_ + n;
+  cap_ = bgn_ + cap;
+}
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::migrate(size_t cap, std::false_type) {
+  if (cap <= N && N) {
+    if (is_inline(bgn_))
+      return;
+    cap = N;
+  }
+  auto new_mem = cap <= N ? this->inline_data() : alloc_.allocate(cap);
 
-  uninitialized_move(bgn_, end_, new_mem);
-  destroy(bgn_, end_);
+  uninitialized_relocate(bgn_, end_, new_mem);
 
-  alloc_.deallocate(bgn_, capacity());
+  release(bgn_, capacity());
   end_ = new_mem + size();
   cap_ = new_mem + cap;
   bgn_ = new_mem;
 }
 //
-template <class T, class Alloc>
-void vector<T, Alloc>::embed(T* pos, size_t n) {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::embed(T* pos, size_t n) {
+  if (size() + n > capacity() && in_place::value) {
+    auto off = pos - bgn_;
+    migrate(overmeasure(size() + n));
+    pos = bgn_ + off;
+  }
   if (size() + n > capacity()) {
     auto cap = overmeasure(size() + n);
     auto new_mem = alloc_.allocate(cap);
 
-    uninitialized_move(bgn_, pos, new_mem);
-    uninitialized_move(pos, end_, new_mem + (pos - bgn_) + n);
-    destroy(bgn_, end_);
+    uninitialized_relocate(bgn_, pos, new_mem);
+    uninitialized_relocate(pos, end_, new_mem + (pos - bgn_) + n);
 
-    alloc_.deallocate(bgn_, capacity());
+    release(bgn_, capacity());
     end_ = new_mem + size() + n;
     cap_ = new_mem + cap;
     bgn_ = new_mem;
   } else {
-    for (auto p = (end_ - 1); p >= pos; --p) {
-      construct(p + n, move(*p));
-      destroy_at(p);
-    }
+    uninitialized_relocate(pos, end_, pos + n);
     end_ += n;
   }
 }
+//
+template <class T, class Alloc, class G, size_t N>
+bool vector<T, Alloc, G, N>::is_inline(const T* p) {
+  return N && p == this->inline_data();
+}
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::release(T* p, size_t cap) {
+  if (!is_inline(p))
+    alloc_.deallocate(p, cap);
+}
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::take(vector& x) {
+  if (x.is_inline(x.bgn_)) {
+    // inline elements can't be stolen, they move to our own buffer
+    end_ = uninitialized_relocate(x.bgn_, x.end_, bgn_);
+  } else {
+    bgn_ = x.bgn_;
+    end_ = x.end_;
+    cap_ = x.cap_;
+  }
+  x.bgn_ = x.inline_data();
+  x.end_ = x.bgn_;
+  x.cap_ = x.bgn_ + N;
+}
 
 //================================== basic ===================================//
 // default
-template <class T, class Alloc>
-vector<T, Alloc>::vector() : vector(Alloc()) {}
-template <class T, class Alloc>
-vector<T, Alloc>::vector(const Alloc& alloc) : alloc_(alloc) {}
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>::vector() : vector(Alloc()) {}
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>::vector(const Alloc& alloc) : alloc_(alloc) {}
 // fill
-template <class T, class Alloc>
-vector<T, Alloc>::vector(size_t n, const Alloc& alloc)
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>::vector(size_t n, const Alloc& alloc)
     : vector(n, T(), alloc) {}
-template <class T, class Alloc>
-vector<T, Alloc>::vector(size_t n, const T& val, const Alloc& alloc)
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>::vector(size_t n, const T& val, const Alloc& alloc)
     : alloc_(alloc) {
-  auto cap = overmeasure(n);
-  bgn_ = alloc_.allocate(cap);
+  reserve(n);
   end_ = bgn_ + n;
-  cap_ = bgn_ + cap;
   uninitialized_fill(bgn_, end_, val);
 }
 // range
-template <class T, class Alloc>
+template <class T, class Alloc, class G, size_t N>
 template <class InputIterator>
-vector<T, Alloc>::vector(
+vector<T, Alloc, G, N>::vector(
     InputIterator first,
     InputIterator last,
     const Alloc& alloc,
@@ -228,59 +345,55 @@ vector<T, Alloc>::vector(
     push_back(*first);
 }
 // copy
-template <class T, class Alloc>
-vector<T, Alloc>::vector(const vector& x) : vector(x, Alloc()) {}
-template <class T, class Alloc>
-vector<T, Alloc>::vector(const vector& x, const Alloc& alloc) : alloc_(alloc) {
-  bgn_ = alloc_.allocate(x.capacity());
-  end_ = bgn_ + x.size();
-  cap_ = bgn_ + x.capacity();
-  uninitialized_copy(x.begin(), x.end(), bgn_);
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>::vector(const vector& x) : vector(x, Alloc()) {}
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>::vector(const vector& x, const Alloc& alloc)
+    : alloc_(alloc) {
+  reserve(x.capacity());
+  end_ = uninitialized_copy(x.begin(), x.end(), bgn_);
 }
 // move
-template <class T, class Alloc>
-vector<T, Alloc>::vector(vector&& x) : vector(move(x), Alloc()) {}
-template <class T, class Alloc>
-vector<T, Alloc>::vector(vector&& x, const Alloc& alloc) : alloc_(alloc) {
-  bgn_ = x.bgn_;
-  end_ = x.end_;
-  cap_ = x.cap_;
-  x.bgn_ = nullptr;
-  x.end_ = nullptr;
-  x.cap_ = nullptr;
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>::vector(vector&& x) : vector(move(x), x.alloc_) {}
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>::vector(vector&& x, const Alloc& alloc)
+    : alloc_(alloc) {
+  take(x);
 }
 // list
-template <class T, class Alloc>
-vector<T, Alloc>::vector(std::initializer_list<T> il, const Alloc& alloc)
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>::vector(std::initializer_list<T> il, const Alloc& alloc)
     : vector(il.begin(), il.end(), alloc) {}
 // dtor
-template <class T, class Alloc>
-vector<T, Alloc>::~vector() noexcept {
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>::~vector() noexcept {
   destroy(bgn_, end_);
-  alloc_.deallocate(bgn_, capacity());
+  release(bgn_, capacity());
 }
 // ==
-template <class T, class Alloc>
-vector<T, Alloc>& vector<T, Alloc>::operator=(const vector& x) {
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>& vector<T, Alloc, G, N>::operator=(const vector& x) {
   vector(x).swap(*this);
   return *this;
 }
 
-template <class T, class Alloc>
-vector<T, Alloc>& vector<T, Alloc>::operator=(vector&& x) {
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>& vector<T, Alloc, G, N>::operator=(vector&& x) {
   vector(move(x)).swap(*this);
   return *this;
 }
 
-template <class T, class Alloc>
-vector<T, Alloc>& vector<T, Alloc>::operator=(std::initializer_list<T> il) {
+template <class T, class Alloc, class G, size_t N>
+vector<T, Alloc, G, N>& vector<T, Alloc, G, N>::operator=(
+    std::initializer_list<T> il) {
   vector(il).swap(*this);
   return *this;
 }
 // assign
-template <class T, class Alloc>
+template <class T, class Alloc, class G, size_t N>
 template <class InputIterator>
-void vector<T, Alloc>::assign(
+void vector<T, Alloc, G, N>::assign(
     InputIterator first,
     InputIterator last,
     typename std::enable_if<!std::is_integral<InputIterator>::value>::type*) {
@@ -288,160 +401,163 @@ void vector<T, Alloc>::assign(
   for (; first != last; ++first)
     push_back(*first);
 }
-template <class T, class Alloc>
-void vector<T, Alloc>::assign(size_t n, const T& val) {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::assign(size_t n, const T& val) {
   clear();
   reserve(n);
   end_ = bgn_ + n;
   uninitialized_fill(bgn_, end_, val);
 }
-template <class T, class Alloc>
-void vector<T, Alloc>::assign(std::initializer_list<T> il) {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::assign(std::initializer_list<T> il) {
   clear();
   reserve(il.size());
   end_ = bgn_ + il.size();
   uninitialized_copy(il.begin(), il.end(), bgn_);
 }
 // get_allocator
-template <class T, class Alloc>
-Alloc vector<T, Alloc>::get_allocator() const noexcept {
+template <class T, class Alloc, class G, size_t N>
+Alloc vector<T, Alloc, G, N>::get_allocator() const noexcept {
   return alloc_;
 }
 
 //============================= element access ===============================//
 // at
-template <class T, class Alloc>
-T& vector<T, Alloc>::at(size_t n) {
+template <class T, class Alloc, class G, size_t N>
+T& vector<T, Alloc, G, N>::at(size_t n) {
   if (n >= size())
     throw std::out_of_range("out of range");
   return bgn_[n];
 }
-template <class T, class Alloc>
-const T& vector<T, Alloc>::at(size_t n) const {
+template <class T, class Alloc, class G, size_t N>
+const T& vector<T, Alloc, G, N>::at(size_t n) const {
   if (n >= size())
     throw std::out_of_range("out of range");
   return bgn_[n];
 }
 // []
-template <class T, class Alloc>
-T& vector<T, Alloc>::operator[](size_t n) {
+template <class T, class Alloc, class G, size_t N>
+T& vector<T, Alloc, G, N>::operator[](size_t n) {
   return bgn_[n];
 }
-template <class T, class Alloc>
-const T& vector<T, Alloc>::operator[](size_t n) const {
+template <class T, class Alloc, class G, size_t N>
+const T& vector<T, Alloc, G, N>::operator[](size_t n) const {
   return bgn_[n];
 }
 // front
-template <class T, class Alloc>
-T& vector<T, Alloc>::front() {
+template <class T, class Alloc, class G, size_t N>
+T& vector<T, Alloc, G, N>::front() {
   return bgn_[0];
 }
-template <class T, class Alloc>
-const T& vector<T, Alloc>::front() const {
+template <class T, class Alloc, class G, size_t N>
+const T& vector<T, Alloc, G, N>::front() const {
   return bgn_[0];
 }
 // back
-template <class T, class Alloc>
-T& vector<T, Alloc>::back() {
+template <class T, class Alloc, class G, size_t N>
+T& vector<T, Alloc, G, N>::back() {
   return end_[-1];
 }
-template <class T, class Alloc>
-const T& vector<T, Alloc>::back() const {
+template <class T, class Alloc, class G, size_t N>
+const T& vector<T, Alloc, G, N>::back() const {
   return end_[-1];
 }
 // data
-template <class T, class Alloc>
-T* vector<T, Alloc>::data() noexcept {
+template <class T, class Alloc, class G, size_t N>
+T* vector<T, Alloc, G, N>::data() noexcept {
   return bgn_;
 }
-template <class T, class Alloc>
-const T* vector<T, Alloc>::data() const noexcept {
+template <class T, class Alloc, class G, size_t N>
+const T* vector<T, Alloc, G, N>::data() const noexcept {
   return bgn_;
 }
 
 //================================ iterators =================================//
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::begin() noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::iterator
+vector<T, Alloc, G, N>::begin() noexcept {
   return bgn_;
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::end() noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::iterator
+vector<T, Alloc, G, N>::end() noexcept {
   return end_;
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::const_iterator vector<T, Alloc>::begin() const
-    noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::const_iterator
+vector<T, Alloc, G, N>::begin() const noexcept {
   return bgn_;
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::const_iterator vector<T, Alloc>::end() const
-    noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::const_iterator
+vector<T, Alloc, G, N>::end() const noexcept {
   return end_;
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::const_iterator vector<T, Alloc>::cbegin() const
-    noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::const_iterator
+vector<T, Alloc, G, N>::cbegin() const noexcept {
   return bgn_;
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::const_iterator vector<T, Alloc>::cend() const
-    noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::const_iterator
+vector<T, Alloc, G, N>::cend() const noexcept {
   return end_;
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::reverse_iterator
-vector<T, Alloc>::rbegin() noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::reverse_iterator
+vector<T, Alloc, G, N>::rbegin() noexcept {
   return reverse_iterator(end());
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::reverse_iterator vector<T, Alloc>::rend() noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::reverse_iterator
+vector<T, Alloc, G, N>::rend() noexcept {
   return reverse_iterator(begin());
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::const_reverse_iterator vector<T, Alloc>::rbegin()
-    const noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::const_reverse_iterator
+vector<T, Alloc, G, N>::rbegin() const noexcept {
   return const_reverse_iterator(end());
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::const_reverse_iterator vector<T, Alloc>::rend() const
-    noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::const_reverse_iterator
+vector<T, Alloc, G, N>::rend() const noexcept {
   return const_reverse_iterator(begin());
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::const_reverse_iterator vector<T, Alloc>::crbegin()
-    const noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::const_reverse_iterator
+vector<T, Alloc, G, N>::crbegin() const noexcept {
   return const_reverse_iterator(end());
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::const_reverse_iterator vector<T, Alloc>::crend()
-    const noexcept {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::const_reverse_iterator
+vector<T, Alloc, G, N>::crend() const noexcept {
   return const_reverse_iterator(begin());
 }
 
 //================================ capacity ==================================//
-template <class T, class Alloc>
-bool vector<T, Alloc>::empty() const noexcept {
+template <class T, class Alloc, class G, size_t N>
+bool vector<T, Alloc, G, N>::empty() const noexcept {
   return bgn_ == end_;
 }
-template <class T, class Alloc>
-size_t vector<T, Alloc>::size() const noexcept {
+template <class T, class Alloc, class G, size_t N>
+size_t vector<T, Alloc, G, N>::size() const noexcept {
   return end_ - bgn_;
 }
-template <class T, class Alloc>
-size_t vector<T, Alloc>::max_size() const {
+template <class T, class Alloc, class G, size_t N>
+size_t vector<T, Alloc, G, N>::max_size() const {
   return std::numeric_limits<size_t>::max();
 }
-template <class T, class Alloc>
-void vector<T, Alloc>::reserve(size_t cap) {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::reserve(size_t cap) {
   if (cap > capacity())
     migrate(overmeasure(cap));
 }
-template <class T, class Alloc>
-size_t vector<T, Alloc>::capacity() const noexcept {
+template <class T, class Alloc, class G, size_t N>
+size_t vector<T, Alloc, G, N>::capacity() const noexcept {
   return cap_ - bgn_;
 }
-template <class T, class Alloc>
-void vector<T, Alloc>::shrink_to_fit() {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::shrink_to_fit() {
   auto cap = overmeasure(size());
   if (cap < capacity())
     migrate(cap);
@@ -449,31 +565,35 @@ void vector<T, Alloc>::shrink_to_fit() {
 
 //================================ modifiers =================================//
 // clear
-template <class T, class Alloc>
-void vector<T, Alloc>::clear() {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::clear() {
   destroy(bgn_, end_);
   end_ = bgn_;
 }
 // insert
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos,
-                                                             const T& val) {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::iterator vector<T, Alloc, G, N>::insert(
+    const_iterator pos,
+    const T& val) {
   return emplace(pos, val);
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(const_iterator pos,
-                                                             T&& val) {
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::iterator vector<T, Alloc, G, N>::insert(
+    const_iterator pos,
+    T&& val) {
   return emplace(pos, move(val));
 }
-template <class T, class Alloc>
-void vector<T, Alloc>::insert(const_iterator pos, size_t n, const T& val) {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::insert(const_iterator pos,
+                                    size_t n,
+                                    const T& val) {
   auto dist = pos - bgn_;
   embed(const_cast<iterator>(pos), n);
   uninitialized_fill_n(bgn_ + dist, n, val);
 }
-template <class T, class Alloc>
+template <class T, class Alloc, class G, size_t N>
 template <class InputIterator>
-void vector<T, Alloc>::insert(
+void vector<T, Alloc, G, N>::insert(
     const_iterator pos,
     InputIterator first,
     InputIterator last,
@@ -481,14 +601,15 @@ void vector<T, Alloc>::insert(
   for (; first != last; ++first)
     pos = insert(pos, *first) + 1;
 }
-template <class T, class Alloc>
-void vector<T, Alloc>::insert(const_iterator pos, std::initializer_list<T> il) {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::insert(const_iterator pos,
+                                    std::initializer_list<T> il) {
   insert(pos, il.begin(), il.end());
 }
 // emplace
-template <class T, class Alloc>
+template <class T, class Alloc, class G, size_t N>
 template <class... Args>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::emplace(
+typename vector<T, Alloc, G, N>::iterator vector<T, Alloc, G, N>::emplace(
     const_iterator pos,
     Args&&... args) {
   auto dist = pos - bgn_;
@@ -497,48 +618,62 @@ typename vector<T, Alloc>::iterator vector<T, Alloc>::emplace(
   return bgn_ + dist;
 }
 // erase
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::iterator vector<T, Alloc, G, N>::erase(
     const_iterator pos) {
   return erase(pos, pos + 1);
 }
-template <class T, class Alloc>
-typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(
+template <class T, class Alloc, class G, size_t N>
+typename vector<T, Alloc, G, N>::iterator vector<T, Alloc, G, N>::erase(
     const_iterator first,
     const_iterator last) {
   destroy(first, last);
-  auto res = first;
-  for (; last != cend(); ++first, ++last) {
-    construct(const_cast<iterator>(first), move(*last));
-    destroy_at(last);
-  }
+  uninitialized_relocate(const_cast<iterator>(last), end_,
+                         const_cast<iterator>(first));
   end_ -= last - first;
-  return const_cast<iterator>(res);
+  return const_cast<iterator>(first);
 }
 // push_back
-template <class T, class Alloc>
-void vector<T, Alloc>::push_back(const T& val) {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::push_back(const T& val) {
   emplace_back(val);
 }
-template <class T, class Alloc>
-void vector<T, Alloc>::push_back(T&& val) {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::push_back(T&& val) {
   emplace_back(move(val));
 }
 // emplace_back
-template <class T, class Alloc>
+template <class T, class Alloc, class G, size_t N>
+template <class... Args>
+void vector<T, Alloc, G, N>::emplace_back(Args&&... args) {
+  if (end_ != cap_)
+    unchecked_emplace_back(forward<Args>(args)...);
+  else
+    emplace(end(), forward<Args>(args)...);
+}
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::push_back_unchecked(const T& val) {
+  unchecked_emplace_back(val);
+}
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::push_back_unchecked(T&& val) {
+  unchecked_emplace_back(move(val));
+}
+template <class T, class Alloc, class G, size_t N>
 template <class... Args>
-void vector<T, Alloc>::emplace_back(Args&&... args) {
-  emplace(end(), forward<Args>(args)...);
+void vector<T, Alloc, G, N>::unchecked_emplace_back(Args&&... args) {
+  construct(end_, forward<Args>(args)...);
+  ++end_;
 }
 // pop_back
-template <class T, class Alloc>
-void vector<T, Alloc>::pop_back() {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::pop_back() {
   --end_;
   destroy_at(end_);
 }
 // resize
-template <class T, class Alloc>
-void vector<T, Alloc>::resize(size_t new_size, T val) {
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::resize(size_t new_size, T val) {
   if (new_size > size()) {
     reserve(new_size);
     uninitialized_fill_n(end_, new_size - size(), val);
@@ -547,42 +682,71 @@ void vector<T, Alloc>::resize(size_t new_size, T val) {
   }
   end_ = bgn_ + new_size;
 }
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::resize_default_init(size_t new_size) {
+  if (new_size > size()) {
+    reserve(new_size);
+    uninitialized_default_construct_n(end_, new_size - size());
+  } else {
+    destroy(bgn_ + new_size, end_);
+  }
+  end_ = bgn_ + new_size;
+}
+template <class T, class Alloc, class G, size_t N>
+T* vector<T, Alloc, G, N>::append_uninitialized(size_t n) {
+  auto old_size = size();
+  resize_default_init(old_size + n);
+  return bgn_ + old_size;
+}
 // swap
-template <class T, class Alloc>
-void vector<T, Alloc>::swap(vector& x) {
-  mrsuyi::swap(bgn_, x.bgn_);
-  mrsuyi::swap(end_, x.end_);
-  mrsuyi::swap(cap_, x.cap_);
+template <class T, class Alloc, class G, size_t N>
+void vector<T, Alloc, G, N>::swap(vector& x) {
+  if (is_inline(bgn_) || x.is_inline(x.bgn_)) {
+    vector tmp(mrsuyi::move(x));
+    x.take(*this);
+    take(tmp);
+  } else {
+    mrsuyi::swap(bgn_, x.bgn_);
+    mrsuyi::swap(end_, x.end_);
+    mrsuyi::swap(cap_, x.cap_);
+  }
+  mrsuyi::swap(alloc_, x.alloc_);
 }
 
 //=========================== non-member functions ===========================//
-template <class T, class Alloc>
-void swap(vector<T, Alloc>& x, vector<T, Alloc>& y) {
+template <class T, class Alloc, class G, size_t N>
+void swap(vector<T, Alloc, G, N>& x, vector<T, Alloc, G, N>& y) {
   x.swap(y);
 }
-template <class T, class Alloc>
-bool operator==(const vector<T, Alloc>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc, class G, size_t N>
+bool operator==(const vector<T, Alloc, G, N>& lhs,
+                const vector<T, Alloc, G, N>& rhs) {
   return lhs.size() == rhs.size() && equal(lhs.begin(), lhs.end(), rhs.begin());
 }
-template <class T, class Alloc>
-bool operator!=(const vector<T, Alloc>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc, class G, size_t N>
+bool operator!=(const vector<T, Alloc, G, N>& lhs,
+                const vector<T, Alloc, G, N>& rhs) {
   return !(lhs == rhs);
 }
-template <class T, class Alloc>
-bool operator<(const vector<T, Alloc>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc, class G, size_t N>
+bool operator<(const vector<T, Alloc, G, N>& lhs,
+               const vector<T, Alloc, G, N>& rhs) {
   return lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(),
                                  rhs.end());
 }
-template <class T, class Alloc>
-bool operator<=(const vector<T, Alloc>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc, class G, size_t N>
+bool operator<=(const vector<T, Alloc, G, N>& lhs,
+                const vector<T, Alloc, G, N>& rhs) {
   return !(rhs < lhs);
 }
-template <class T, class Alloc>
-bool operator>(const vector<T, Alloc>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc, class G, size_t N>
+bool operator>(const vector<T, Alloc, G, N>& lhs,
+               const vector<T, Alloc, G, N>& rhs) {
   return rhs < lhs;
 }
-template <class T, class Alloc>
-bool operator>=(const vector<T, Alloc>& lhs, const vector<T>& rhs) {
+template <class T, class Alloc, class G, size_t N>
+bool operator>=(const vector<T, Alloc, G, N>& lhs,
+                const vector<T, Alloc, G, N>& rhs) {
   return !(lhs < rhs);
 }
 }  // namespace mrsuyi
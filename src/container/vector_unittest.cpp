@@ -1,6 +1,8 @@
+#include <cstring>
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+#include "memory/unique_ptr.hpp"
 #include "vector.hpp"
 
 using namespace mrsuyi;
@@ -74,12 +76,179 @@ TEST(VectorTest, SizeAndCapacity) {
   EXPECT_EQ(5, a.size());
 }
 
+TEST(VectorTest, GrowthPolicy) {
+  vector<int, allocator<int>, factor_growth_policy<3, 2>> half;
+  half.reserve(10);
+  EXPECT_EQ(10, half.capacity());
+  half.assign(10, 1);
+  half.push_back(1);
+  EXPECT_EQ(15, half.capacity());
+  half.insert(half.end(), 10, 2);
+  EXPECT_EQ(22, half.capacity());
+  EXPECT_EQ(21, half.size());
+
+  vector<int, allocator<int>, factor_growth_policy<2, 1>> twice(3, 1);
+  EXPECT_EQ(3, twice.capacity());
+  twice.push_back(1);
+  EXPECT_EQ(6, twice.capacity());
+
+  // 16 ints per step
+  vector<int, allocator<int>, step_growth_policy<64>> step;
+  for (int i = 0; i < 10; ++i)
+    step.push_back(i);
+  EXPECT_EQ(16, step.capacity());
+  for (int i = 10; i < 40; ++i)
+    step.push_back(i);
+  EXPECT_EQ(48, step.capacity());
+  EXPECT_EQ(39, step.back());
+}
+
+// allocator<T> that counts its calls
+template <class T>
+struct counting_allocator : allocator<T> {
+  template <class U>
+  using other = counting_allocator<U>;
+
+  counting_allocator() {}
+  template <class U>
+  counting_allocator(const counting_allocator<U>&) {}
+
+  T* allocate(size_t n) {
+    ++allocations;
+    return allocator<T>::allocate(n);
+  }
+  T* reallocate(T* p, size_t n, size_t new_n) {
+    ++reallocations;
+    return allocator<T>::reallocate(p, n, new_n);
+  }
+
+  static int allocations, reallocations;
+};
+template <class T>
+int counting_allocator<T>::allocations = 0;
+template <class T>
+int counting_allocator<T>::reallocations = 0;
+
+struct non_trivial {
+  non_trivial(int v) : val(v) {}
+  non_trivial(const non_trivial& other) : val(other.val) {}
+  int val;
+};
+
+TEST(VectorTest, Reallocate) {
+  // trivially copyable elements grow in place
+  vector<int, counting_allocator<int>> ints;
+  for (int i = 0; i < 1000; ++i)
+    ints.insert(ints.begin() + i / 2, i);
+  EXPECT_EQ(0, counting_allocator<int>::allocations);
+  EXPECT_EQ(11, counting_allocator<int>::reallocations);
+  EXPECT_EQ(999, ints[499]);
+  EXPECT_EQ(998, ints[500]);
+  ints.shrink_to_fit();
+  EXPECT_EQ(1024, ints.capacity());
+
+  // others are moved one by one
+  vector<non_trivial, counting_allocator<non_trivial>> objs;
+  for (int i = 0; i < 100; ++i)
+    objs.emplace_back(i);
+  EXPECT_EQ(0, counting_allocator<non_trivial>::reallocations);
+  EXPECT_EQ(8, counting_allocator<non_trivial>::allocations);
+  EXPECT_EQ(99, objs.back().val);
+}
+
+// counts live objects
+struct counted {
+  counted(int v) : val(v) { ++live; }
+  counted(const counted& other) : val(other.val) { ++live; }
+  ~counted() { --live; }
+  int val;
+  static int live;
+};
+int counted::live = 0;
+
+TEST(VectorTest, Relocate) {
+  // opted-in types are relocated bytewise, through reallocate too
+  static_assert(is_trivially_relocatable<unique_ptr<int>>::value, "");
+  static_assert(!is_trivially_relocatable<counted>::value, "");
+  vector<unique_ptr<int>, counting_allocator<unique_ptr<int>>> ptrs;
+  for (int i = 0; i < 100; ++i)
+    ptrs.insert(ptrs.begin() + i / 2, unique_ptr<int>(new int(i)));
+  EXPECT_EQ(0, counting_allocator<unique_ptr<int>>::allocations);
+  EXPECT_EQ(8, counting_allocator<unique_ptr<int>>::reallocations);
+  ptrs.erase(ptrs.begin(), ptrs.begin() + 49);
+  EXPECT_EQ(51, ptrs.size());
+  EXPECT_EQ(99, *ptrs[0]);
+  EXPECT_EQ(98, *ptrs[1]);
+  EXPECT_EQ(0, *ptrs[50]);
+
+  // others are moved & destroyed one by one, in either direction
+  {
+    vector<counted> objs;
+    for (int i = 0; i < 100; ++i)
+      objs.insert(objs.begin() + i / 2, counted(i));
+    EXPECT_EQ(100, counted::live);
+    objs.erase(objs.begin() + 10, objs.begin() + 60);
+    EXPECT_EQ(50, counted::live);
+    EXPECT_EQ(19, objs[9].val);
+    EXPECT_EQ(78, objs[10].val);
+  }
+  EXPECT_EQ(0, counted::live);
+
+  // bytewise fills
+  vector<int> zeros(100, 0), ones(100, -1), others(100, 7);
+  EXPECT_EQ(0, zeros[99]);
+  EXPECT_EQ(-1, ones[99]);
+  EXPECT_EQ(7, others[99]);
+  vector<char> chars(100, 'a');
+  EXPECT_EQ('a', chars[99]);
+  // trivially copyable but not assignable
+  struct pair_const {
+    const int x;
+    int y;
+  };
+  vector<pair_const> pairs(100, pair_const{1, 2});
+  EXPECT_EQ(1, pairs[99].x);
+  EXPECT_EQ(2, pairs[99].y);
+}
+
 TEST(VectorTest, PushEmplace) {
   vector<int> ary = {1, 2};
   ary.push_back(3);
   ary.push_back(4);
   ary.emplace_back(5);
   EXPECT_THAT(ary, ElementsAre(1, 2, 3, 4, 5));
+
+  ary.reserve(8);
+  ary.push_back_unchecked(6);
+  int seven = 7;
+  ary.push_back_unchecked(seven);
+  ary.unchecked_emplace_back(8);
+  EXPECT_THAT(ary, ElementsAre(1, 2, 3, 4, 5, 6, 7, 8));
+  EXPECT_EQ(8, ary.capacity());
+}
+
+TEST(VectorTest, DefaultInit) {
+  vector<char> buf;
+  memcpy(buf.append_uninitialized(5), "hello", 5);
+  char* tail = buf.append_uninitialized(3);
+  EXPECT_EQ(buf.data() + 5, tail);
+  memcpy(tail, "!!!", 3);
+  EXPECT_EQ(8, buf.size());
+  EXPECT_EQ(0, memcmp(buf.data(), "hello!!!", 8));
+
+  buf.resize_default_init(2);
+  EXPECT_THAT(buf, ElementsAre('h', 'e'));
+  buf.resize_default_init(100);
+  EXPECT_EQ(100, buf.size());
+  EXPECT_EQ('e', buf[1]);
+
+  // class types still get their default ctor
+  vector<vector<int>> vs;
+  vs.resize_default_init(3);
+  vs.append_uninitialized(2)->push_back(1);
+  EXPECT_EQ(5, vs.size());
+  EXPECT_TRUE(vs[2].empty());
+  EXPECT_THAT(vs[3], ElementsAre(1));
 }
 
 TEST(VectorTest, Insert) {
@@ -1,6 +1,17 @@
 #pragma once
 
+#include <type_traits>
+
 namespace mrsuyi {
+// whether [T] declares is_transparent, i.e. accepts other types than its key
+template <class T, class = void>
+struct is_transparent : std::false_type {};
+template <class T>
+struct is_transparent<
+    T,
+    typename std::conditional<true, void, typename T::is_transparent>::type>
+    : std::true_type {};
+
 // ==
 template <class T = void>
 struct equal_to {
@@ -8,6 +19,15 @@ struct equal_to {
     return lhs == rhs;
   }
 };
+template <>
+struct equal_to<void> {
+  using is_transparent = void;
+
+  template <class T, class U>
+  constexpr bool operator()(const T& lhs, const U& rhs) const {
+    return lhs == rhs;
+  }
+};
 // !=
 template <class T = void>
 struct not_equal_to {
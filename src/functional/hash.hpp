@@ -1,17 +1,19 @@
 #pragma once
 
 #include <cstddef>
+#include <cstring>
+#include "hash_bytes.hpp"
 
 namespace mrsuyi {
 template <class T>
 struct hash {};
 
 // string related
+inline size_t __hash_string(const char* s, size_t n) {
+  return hash_bytes(s, n);
+}
 inline size_t __hash_string(const char* s) {
-  unsigned long h = 0;
-  for (; *s; ++s)
-    h = 5 * h + *s;
-  return h;
+  return __hash_string(s, strlen(s));
 }
 template <>
 struct hash<char*> {
@@ -21,74 +23,100 @@ template <>
 struct hash<const char*> {
   std::size_t operator()(const char* s) const { return __hash_string(s); }
 };
+// transparent hasher for string keys
+// C strings and any string type with data()/size() hash alike, so a table of
+// strings can be searched by a C string without building a key
+struct string_hash {
+  using is_transparent = void;
+
+  std::size_t operator()(const char* s) const { return __hash_string(s); }
+  template <class String>
+  std::size_t operator()(const String& s) const {
+    return __hash_string(s.data(), s.size());
+  }
+};
 
 // single number
+// integers go through a strong mixer, an identity hash would send strided
+// keys to a handful of buckets
 template <>
 struct hash<bool> {
-  std::size_t operator()(bool n) const { return n; }
+  std::size_t operator()(bool n) const { return hash_int(n); }
 };
 template <>
 struct hash<char> {
-  std::size_t operator()(char n) const { return n; }
+  std::size_t operator()(char n) const { return hash_int(n); }
 };
 template <>
 struct hash<signed char> {
-  std::size_t operator()(signed char n) const { return n; }
+  std::size_t operator()(signed char n) const { return hash_int(n); }
 };
 template <>
 struct hash<unsigned char> {
-  std::size_t operator()(unsigned char n) const { return n; }
+  std::size_t operator()(unsigned char n) const { return hash_int(n); }
 };
 template <>
 struct hash<char16_t> {
-  std::size_t operator()(char16_t n) const { return n; }
+  std::size_t operator()(char16_t n) const { return hash_int(n); }
 };
 template <>
 struct hash<char32_t> {
-  std::size_t operator()(char32_t n) const { return n; }
+  std::size_t operator()(char32_t n) const { return hash_int(n); }
 };
 template <>
 struct hash<wchar_t> {
-  std::size_t operator()(wchar_t n) const { return n; }
+  std::size_t operator()(wchar_t n) const { return hash_int(n); }
 };
 template <>
 struct hash<short> {
-  std::size_t operator()(short n) const { return n; }
+  std::size_t operator()(short n) const { return hash_int(n); }
 };
 template <>
 struct hash<unsigned short> {
-  std::size_t operator()(unsigned short n) const { return n; }
+  std::size_t operator()(unsigned short n) const { return hash_int(n); }
 };
 template <>
 struct hash<int> {
-  std::size_t operator()(int n) const { return n; }
+  std::size_t operator()(int n) const { return hash_int(n); }
 };
 template <>
 struct hash<unsigned int> {
-  std::size_t operator()(unsigned int n) const { return n; }
+  std::size_t operator()(unsigned int n) const { return hash_int(n); }
 };
 template <>
 struct hash<long> {
-  std::size_t operator()(long n) const { return n; }
+  std::size_t operator()(long n) const { return hash_int(n); }
 };
 template <>
 struct hash<unsigned long> {
-  std::size_t operator()(unsigned long n) const { return n; }
+  std::size_t operator()(unsigned long n) const { return hash_int(n); }
 };
 template <>
 struct hash<long long> {
-  std::size_t operator()(long long n) const { return n; }
+  std::size_t operator()(long long n) const { return hash_int(n); }
 };
 template <>
 struct hash<unsigned long long> {
-  std::size_t operator()(unsigned long long n) const { return n; }
+  std::size_t operator()(unsigned long long n) const { return hash_int(n); }
 };
+// floating points hash their bits, -0 is turned into +0 first since the two
+// compare equal
 template <>
 struct hash<float> {
-  std::size_t operator()(float n) const { return n; }
+  std::size_t operator()(float n) const {
+    uint32_t bits = 0;
+    if (n != 0)
+      memcpy(&bits, &n, sizeof(n));
+    return hash_int(bits);
+  }
 };
 template <>
 struct hash<double> {
-  std::size_t operator()(double n) const { return n; }
+  std::size_t operator()(double n) const {
+    uint64_t bits = 0;
+    if (n != 0)
+      memcpy(&bits, &n, sizeof(n));
+    return hash_int(bits);
+  }
 };
 }  // namespace mrsuyi
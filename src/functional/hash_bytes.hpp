@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace mrsuyi {
+// wyhash-style hashing: every step multiplies two 64-bit words into 128 bits
+// and folds the halves together, which mixes all input bits into all output
+// bits at the cost of one wide multiplication
+static const uint64_t hash_secret[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull,
+    0x589965cc75374cc3ull,
+};
+
+// [a] * [b] in 128 bits, low half to [a] and high half to [b]
+inline void __hash_mum(uint64_t* a, uint64_t* b) {
+#ifdef __SIZEOF_INT128__
+  __uint128_t r = __uint128_t(*a) * *b;
+  *a = uint64_t(r);
+  *b = uint64_t(r >> 64);
+#else
+  uint64_t ha = *a >> 32, hb = *b >> 32, la = uint32_t(*a), lb = uint32_t(*b);
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32), c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  *a = lo;
+  *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+// fold of the 128-bit product of [a] and [b]
+inline uint64_t hash_mix(uint64_t a, uint64_t b) {
+  __hash_mum(&a, &b);
+  return a ^ b;
+}
+// strong mixer for a single integer
+inline uint64_t hash_int(uint64_t n) {
+  return hash_mix(n ^ hash_secret[0], hash_secret[1]);
+}
+
+// unaligned little reads
+inline uint64_t __hash_read64(const uint8_t* p) {
+  uint64_t v;
+  memcpy(&v, p, 8);
+  return v;
+}
+inline uint64_t __hash_read32(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+// 1 to 3 bytes, first, middle & last
+inline uint64_t __hash_read_small(const uint8_t* p, size_t n) {
+  return (uint64_t(p[0]) << 16) | (uint64_t(p[n >> 1]) << 8) | p[n - 1];
+}
+
+// hash of the [n] bytes at [data]
+// up to 16 bytes are read as two possibly overlapping words, longer input is
+// consumed 48 bytes per round by three independent 16-byte lanes so that
+// their multiplications overlap
+inline uint64_t hash_bytes(const void* data, size_t n, uint64_t seed = 0) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  seed ^= hash_mix(seed ^ hash_secret[0], hash_secret[1]);
+  uint64_t a, b;
+  if (n <= 16) {
+    if (n >= 4) {
+      // 4..16 bytes: two words covering the front and the back
+      size_t off = (n >> 3) << 2;
+      a = (__hash_read32(p) << 32) | __hash_read32(p + off);
+      b = (__hash_read32(p + n - 4) << 32) | __hash_read32(p + n - 4 - off);
+    } else if (n > 0) {
+      a = __hash_read_small(p, n);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = n;
+    if (i > 48) {
+      uint64_t seed1 = seed, seed2 = seed;
+      do {
+        seed = hash_mix(__hash_read64(p) ^ hash_secret[1],
+                        __hash_read64(p + 8) ^ seed);
+        seed1 = hash_mix(__hash_read64(p + 16) ^ hash_secret[2],
+                         __hash_read64(p + 24) ^ seed1);
+        seed2 = hash_mix(__hash_read64(p + 32) ^ hash_secret[3],
+                         __hash_read64(p + 40) ^ seed2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    for (; i > 16; p += 16, i -= 16)
+      seed = hash_mix(__hash_read64(p) ^ hash_secret[1],
+                      __hash_read64(p + 8) ^ seed);
+    // the last 16 bytes, overlapping what was consumed already
+    a = __hash_read64(p + i - 16);
+    b = __hash_read64(p + i - 8);
+  }
+  a ^= hash_secret[1];
+  b ^= seed;
+  __hash_mum(&a, &b);
+  return hash_mix(a ^ hash_secret[0] ^ n, b ^ hash_secret[1]);
+}
+}  // namespace mrsuyi
@@ -0,0 +1,62 @@
+#include <set>
+#include <string>
+#include "gtest/gtest.h"
+
+#include "hash.hpp"
+
+using namespace mrsuyi;
+
+TEST(HashTest, Bytes) {
+  // every length goes through a different read pattern
+  char buf[256];
+  for (int i = 0; i < 256; ++i)
+    buf[i] = char(i * 7);
+  std::set<uint64_t> seen;
+  for (size_t n = 0; n <= 256; ++n)
+    seen.insert(hash_bytes(buf, n));
+  EXPECT_EQ(257, seen.size());
+
+  // deterministic, seeded, and sensitive to every byte
+  EXPECT_EQ(hash_bytes(buf, 100), hash_bytes(buf, 100));
+  EXPECT_NE(hash_bytes(buf, 100), hash_bytes(buf, 100, 1));
+  for (size_t i = 0; i < 100; ++i) {
+    uint64_t before = hash_bytes(buf, 100);
+    buf[i] ^= 1;
+    EXPECT_NE(before, hash_bytes(buf, 100));
+    buf[i] ^= 1;
+  }
+}
+
+TEST(HashTest, String) {
+  std::string s = "a string long enough for the 48-byte rounds, and a bit more";
+  EXPECT_EQ(hash_bytes(s.data(), s.size()), hash<const char*>()(s.c_str()));
+  EXPECT_EQ(string_hash()(s), string_hash()(s.c_str()));
+  EXPECT_NE(hash<const char*>()("ab"), hash<const char*>()("ba"));
+}
+
+TEST(HashTest, Integer) {
+  // flipping one input bit flips about half of the output bits
+  size_t flipped = 0;
+  for (uint64_t n = 0; n < 64; ++n)
+    for (int bit = 0; bit < 64; ++bit)
+      flipped +=
+          __builtin_popcountll(hash_int(n) ^ hash_int(n ^ (1ull << bit)));
+  double ratio = double(flipped) / (64 * 64 * 64);
+  EXPECT_GT(ratio, 0.45);
+  EXPECT_LT(ratio, 0.55);
+
+  std::set<size_t> low_bits;
+  for (int i = 0; i < 1024; ++i)
+    low_bits.insert(hash<int>()(i * 1024) & 1023);
+  EXPECT_GT(low_bits.size(), 512);
+}
+
+TEST(HashTest, Float) {
+  hash<double> hd;
+  EXPECT_NE(hd(0.1), hd(0.5));
+  EXPECT_NE(hd(0.5), hd(0.9));
+  EXPECT_EQ(hd(0.0), hd(-0.0));
+  hash<float> hf;
+  EXPECT_NE(hf(0.1f), hf(0.9f));
+  EXPECT_EQ(hf(0.0f), hf(-0.0f));
+}
@@ -3,6 +3,10 @@
 #include "memory/allocator.hpp"
 #include "memory/deleter.hpp"
 #include "memory/functions.hpp"
+#include "memory/huge_page_allocator.hpp"
+#include "memory/memory_resource.hpp"
+#include "memory/pool_allocator.hpp"
 #include "memory/shared_ptr.hpp"
+#include "memory/tracking_allocator.hpp"
 #include "memory/unique_ptr.hpp"
 #include "memory/weak_ptr.hpp"
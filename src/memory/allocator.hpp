@@ -2,7 +2,9 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include <new>
 #include <type_traits>
+#include <utility>
 
 namespace mrsuyi {
 template <class T>
@@ -22,6 +24,9 @@ class allocator {
   // mem
   T* allocate(std::size_t);
   void deallocate(T* p, std::size_t n);
+  // resize the block of [p] from [n] to [new_n] elements, in place if the
+  // heap can. the bytes are moved as they are
+  T* reallocate(T* p, std::size_t n, std::size_t new_n);
 };
 
 template <class T>
@@ -44,6 +49,33 @@ void allocator<T>::deallocate(T* p, std::size_t) {
   free(p);
 }
 
+template <class T>
+T* allocator<T>::reallocate(T* p, std::size_t, std::size_t new_n) {
+  T* res = static_cast<T*>(
+      realloc(static_cast<void*>(p), new_n * sizeof(value_type)));
+  if (!res && new_n)
+    throw std::bad_alloc();
+  return res;
+}
+
+template <class T, class U>
+bool operator==(const allocator<T>&, const allocator<U>&) {
+  return true;
+}
+template <class T, class U>
+bool operator!=(const allocator<T>&, const allocator<U>&) {
+  return false;
+}
+
+// whether [Alloc] has reallocate(p, n, new_n), which containers of trivially
+// copyable elements use to grow without moving them one by one
+template <class Alloc, class = void>
+struct has_reallocate : std::false_type {};
+template <class Alloc>
+struct has_reallocate<Alloc,
+                      decltype((void)std::declval<Alloc&>().reallocate(
+                          nullptr, 0, 0))> : std::true_type {};
+
 template <class T, class Alloc>
 struct uses_allocator
     : std::integral_constant<
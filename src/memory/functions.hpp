@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstring>
+#include <type_traits>
 #include "iterator.hpp"
 
 namespace mrsuyi {
@@ -10,48 +12,196 @@ T* addressof(T& arg) {
       &const_cast<char&>(reinterpret_cast<const volatile char&>(arg)));
 }
 
-//================================ uninitialized =============================//
+//=================================== traits =================================//
+// whether a T may be moved to new memory by copying its bytes and forgetting
+// the old copy, i.e. a move-construct followed by a destroy of the source has
+// no effect beyond the bytes. true for trivially copyable types, other types
+// without pointers into themselves(e.g. unique_ptr) opt in by specializing it
+template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// whether copying [InputIt] into [ForwardIt] is a memcpy: both are pointers
+// to the same trivially copyable type
 template <class InputIt, class ForwardIt>
-ForwardIt uninitialized_copy(InputIt first, InputIt last, ForwardIt result) {
-  for (; first != last; ++result, ++first)
+struct __is_memcpyable
+    : std::integral_constant<
+          bool,
+          std::is_pointer<InputIt>::value &&
+              std::is_pointer<ForwardIt>::value &&
+              std::is_same<typename std::remove_cv<typename iterator_traits<
+                               InputIt>::value_type>::type,
+                           typename iterator_traits<ForwardIt>::value_type>::
+                  value &&
+              std::is_trivially_copyable<
+                  typename iterator_traits<ForwardIt>::value_type>::value> {};
+// whether [ForwardIt] is a pointer to trivially copyable objects, which may
+// be filled bytewise
+template <class ForwardIt>
+struct __is_memsettable
+    : std::integral_constant<
+          bool,
+          std::is_pointer<ForwardIt>::value &&
+              std::is_trivially_copyable<
+                  typename iterator_traits<ForwardIt>::value_type>::value> {};
+// whether [ForwardIt] points at scalars, which are zero when value-initialized
+template <class ForwardIt>
+struct __is_zeroable
+    : std::integral_constant<
+          bool,
+          std::is_pointer<ForwardIt>::value &&
+              std::is_scalar<
+                  typename iterator_traits<ForwardIt>::value_type>::value> {};
+
+//================================ uninitialized =============================//
+template <class InputIt, class Size, class ForwardIt>
+ForwardIt __uninitialized_copy_n(InputIt first,
+                                 Size n,
+                                 ForwardIt result,
+                                 std::false_type) {
+  for (; n > 0; ++result, ++first, --n)
     new (static_cast<void*>(mrsuyi::addressof(*result)))
         typename iterator_traits<ForwardIt>::value_type(*first);
   return result;
 }
 template <class InputIt, class Size, class ForwardIt>
-ForwardIt uninitialized_copy_n(InputIt first, Size n, ForwardIt result) {
-  for (; n > 0; ++result, ++first, --n)
+ForwardIt __uninitialized_copy_n(InputIt first,
+                                 Size n,
+                                 ForwardIt result,
+                                 std::true_type) {
+  if (n > 0)
+    memcpy(result, first, n * sizeof(*result));
+  return n > 0 ? result + n : result;
+}
+template <class InputIt, class ForwardIt>
+ForwardIt __uninitialized_copy(InputIt first,
+                               InputIt last,
+                               ForwardIt result,
+                               std::false_type) {
+  for (; first != last; ++result, ++first)
     new (static_cast<void*>(mrsuyi::addressof(*result)))
         typename iterator_traits<ForwardIt>::value_type(*first);
   return result;
 }
+template <class InputIt, class ForwardIt>
+ForwardIt __uninitialized_copy(InputIt first,
+                               InputIt last,
+                               ForwardIt result,
+                               std::true_type) {
+  return __uninitialized_copy_n(first, last - first, result, std::true_type());
+}
+template <class InputIt, class ForwardIt>
+ForwardIt uninitialized_copy(InputIt first, InputIt last, ForwardIt result) {
+  return __uninitialized_copy(first, last, result,
+                              __is_memcpyable<InputIt, ForwardIt>());
+}
+template <class InputIt, class Size, class ForwardIt>
+ForwardIt uninitialized_copy_n(InputIt first, Size n, ForwardIt result) {
+  return __uninitialized_copy_n(first, n, result,
+                                __is_memcpyable<InputIt, ForwardIt>());
+}
 
 //==================================== move ==================================//
+// moving a trivially copyable object is copying it
+template <class InputIt, class ForwardIt>
+ForwardIt __uninitialized_move(InputIt first,
+                               InputIt last,
+                               ForwardIt result,
+                               std::true_type) {
+  return __uninitialized_copy(first, last, result, std::true_type());
+}
+template <class InputIt, class ForwardIt>
+ForwardIt __uninitialized_move(InputIt first,
+                               InputIt last,
+                               ForwardIt result,
+                               std::false_type) {
+  return __uninitialized_copy(mrsuyi::make_move_iterator(first),
+                              mrsuyi::make_move_iterator(last), result,
+                              std::false_type());
+}
 template <class InputIt, class ForwardIt>
 ForwardIt uninitialized_move(InputIt first, InputIt last, ForwardIt result) {
-  return mrsuyi::uninitialized_copy(mrsuyi::make_move_iterator(first),
-                                    mrsuyi::make_move_iterator(last), result);
+  return __uninitialized_move(first, last, result,
+                              __is_memcpyable<InputIt, ForwardIt>());
+}
+template <class InputIt, class Size, class ForwardIt>
+ForwardIt __uninitialized_move_n(InputIt first,
+                                 Size n,
+                                 ForwardIt result,
+                                 std::true_type) {
+  return __uninitialized_copy_n(first, n, result, std::true_type());
+}
+template <class InputIt, class Size, class ForwardIt>
+ForwardIt __uninitialized_move_n(InputIt first,
+                                 Size n,
+                                 ForwardIt result,
+                                 std::false_type) {
+  return __uninitialized_copy_n(mrsuyi::make_move_iterator(first), n, result,
+                                std::false_type());
 }
 template <class InputIt, class Size, class ForwardIt>
 ForwardIt uninitialized_move_n(InputIt first, Size n, ForwardIt result) {
-  return mrsuyi::uninitialized_copy_n(mrsuyi::make_move_iterator(first), n,
-                                      result);
+  return __uninitialized_move_n(first, n, result,
+                                __is_memcpyable<InputIt, ForwardIt>());
 }
 
 //==================================== fill ==================================//
+template <class ForwardIt, class Size, class T>
+ForwardIt __uninitialized_fill_n(ForwardIt first,
+                                 Size n,
+                                 const T& x,
+                                 std::false_type) {
+  for (; n > 0; ++first, --n)
+    new (static_cast<void*>(mrsuyi::addressof(*first)))
+        typename iterator_traits<ForwardIt>::value_type(x);
+  return first;
+}
+// a memset if the bytes of [x] are all the same(always for single bytes, and
+// zero for most fills of larger types), else a copy of its bytes per element
+// that the compiler vectorizes. never assigns, the storage holds no objects
+// yet and the type may not even be assignable
+template <class ForwardIt, class Size, class T>
+ForwardIt __uninitialized_fill_n(ForwardIt first,
+                                 Size n,
+                                 const T& x,
+                                 std::true_type) {
+  if (n <= 0)
+    return first;
+  typename iterator_traits<ForwardIt>::value_type val(x);
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&val);
+  size_t i = 1;
+  while (i < sizeof(val) && bytes[i] == bytes[0])
+    ++i;
+  if (i == sizeof(val)) {
+    memset(static_cast<void*>(first), bytes[0], n * sizeof(val));
+  } else {
+    for (Size j = 0; j < n; ++j)
+      memcpy(static_cast<void*>(first + j), &val, sizeof(val));
+  }
+  return first + n;
+}
 template <class ForwardIt, class T>
-void uninitialized_fill(ForwardIt first, ForwardIt last, const T& x) {
+void __uninitialized_fill(ForwardIt first,
+                          ForwardIt last,
+                          const T& x,
+                          std::false_type) {
   for (; first != last; ++first)
     new (static_cast<void*>(mrsuyi::addressof(*first)))
         typename iterator_traits<ForwardIt>::value_type(x);
 }
-
+template <class ForwardIt, class T>
+void __uninitialized_fill(ForwardIt first,
+                          ForwardIt last,
+                          const T& x,
+                          std::true_type) {
+  __uninitialized_fill_n(first, last - first, x, std::true_type());
+}
+template <class ForwardIt, class T>
+void uninitialized_fill(ForwardIt first, ForwardIt last, const T& x) {
+  __uninitialized_fill(first, last, x, __is_memsettable<ForwardIt>());
+}
 template <class ForwardIt, class Size, class T>
 ForwardIt uninitialized_fill_n(ForwardIt first, Size n, const T& x) {
-  for (; n--; ++first)
-    new (static_cast<void*>(mrsuyi::addressof(*first)))
-        typename iterator_traits<ForwardIt>::value_type(x);
-  return first;
+  return __uninitialized_fill_n(first, n, x, __is_memsettable<ForwardIt>());
 }
 
 //================================ default-ctor ==============================//
@@ -70,8 +220,29 @@ void uninitialized_default_construct_n(ForwardIt first, Size n) {
 }
 
 //================================ value-ctor ==============================//
+template <class ForwardIt, class Size>
+ForwardIt __uninitialized_value_construct_n(ForwardIt first,
+                                            Size n,
+                                            std::false_type) {
+  for (; n > 0; ++first, --n)
+    new (static_cast<void*>(mrsuyi::addressof(*first)))
+        typename iterator_traits<ForwardIt>::value_type();
+  return first;
+}
+template <class ForwardIt, class Size>
+ForwardIt __uninitialized_value_construct_n(ForwardIt first,
+                                            Size n,
+                                            std::true_type) {
+  using value_type = typename iterator_traits<ForwardIt>::value_type;
+  return __uninitialized_fill_n(first, n, value_type(), std::true_type());
+}
 template <class ForwardIt>
 void uninitialized_value_construct(ForwardIt first, ForwardIt last) {
+  if (__is_zeroable<ForwardIt>::value) {
+    __uninitialized_value_construct_n(first, mrsuyi::distance(first, last),
+                                      __is_zeroable<ForwardIt>());
+    return;
+  }
   for (; first != last; ++first)
     new (static_cast<void*>(mrsuyi::addressof(*first)))
         typename iterator_traits<ForwardIt>::value_type();
@@ -79,14 +250,12 @@ void uninitialized_value_construct(ForwardIt first, ForwardIt last) {
 
 template <class ForwardIt, class Size>
 void uninitialized_value_construct_n(ForwardIt first, Size n) {
-  for (; n > 0; ++first, --n)
-    new (static_cast<void*>(mrsuyi::addressof(*first)))
-        typename iterator_traits<ForwardIt>::value_type();
+  __uninitialized_value_construct_n(first, n, __is_zeroable<ForwardIt>());
 }
 
 //==================================== ctor ==================================//
 template <class T, class... Args>
-void construct(T* t, Args... args) {
+void construct(T* t, Args&&... args) {
   new (static_cast<void*>(t)) T(mrsuyi::forward<Args>(args)...);
 }
 
@@ -105,4 +274,39 @@ void destroy_n(ForwardIt first, Size n) {
   for (; n > 0; ++first, --n)
     destroy_at(mrsuyi::addressof(*first));
 }
+
+//================================= relocate =================================//
+// move [first, last) to the uninitialized [result] and destroy the sources,
+// leaving [first, last) uninitialized except where it overlaps the result
+template <class T>
+T* __uninitialized_relocate(T* first, T* last, T* result, std::true_type) {
+  if (first != last)
+    memmove(static_cast<void*>(result), static_cast<void*>(first),
+            (last - first) * sizeof(T));
+  return result + (last - first);
+}
+template <class T>
+T* __uninitialized_relocate(T* first, T* last, T* result, std::false_type) {
+  T* res = result + (last - first);
+  if (result < first) {
+    for (; first != last; ++first, ++result) {
+      new (static_cast<void*>(result)) T(mrsuyi::move(*first));
+      first->~T();
+    }
+  } else {
+    // back to front, a right shift would overwrite what it is to move next
+    for (result = res; last != first;) {
+      --last;
+      --result;
+      new (static_cast<void*>(result)) T(mrsuyi::move(*last));
+      last->~T();
+    }
+  }
+  return res;
+}
+template <class T>
+T* uninitialized_relocate(T* first, T* last, T* result) {
+  return __uninitialized_relocate(first, last, result,
+                                  is_trivially_relocatable<T>());
+}
 }  // namespace mrsuyi
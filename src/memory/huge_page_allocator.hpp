@@ -0,0 +1,227 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace mrsuyi {
+//================================= options ==================================//
+static const size_t huge_page_size = 2 << 20;
+
+// where the pages of a mapped buffer come from
+enum class numa_policy {
+  // wherever the kernel puts them, usually the node of the first toucher
+  local,
+  // only the nodes of [huge_page_options::nodes]
+  bind,
+  // round-robin over the nodes of [huge_page_options::nodes]
+  interleave,
+};
+
+struct huge_page_options {
+  // buffers of at least [threshold] bytes are mapped, smaller ones malloc'ed
+  size_t threshold = huge_page_size;
+  // try reserved 2MB pages(MAP_HUGETLB) before transparent huge pages
+  bool explicit_pages = false;
+  numa_policy numa = numa_policy::local;
+  // bit i stands for node i, 0 for every node the process may use
+  uint64_t nodes = 0;
+};
+
+//================================= mapping ==================================//
+inline size_t __huge_page_round(size_t bytes) {
+  return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+}
+
+// apply the numa policy of [opt] to pages not touched yet. it is only a hint,
+// a kernel without numa support or a bad node mask leaves the default
+inline void __huge_page_place(void* p, size_t len,
+                              const huge_page_options& opt) {
+#if defined(SYS_mbind) && defined(SYS_get_mempolicy)
+  // values of MPOL_* & MPOL_F_MEMS_ALLOWED, numaif.h is not always there
+  static const int mpol_bind = 2, mpol_interleave = 3, mems_allowed = 1 << 2;
+  if (opt.numa == numa_policy::local)
+    return;
+  unsigned long mask = opt.nodes;
+  if (!mask)
+    syscall(SYS_get_mempolicy, nullptr, &mask, sizeof(mask) * 8 + 1, nullptr,
+            mems_allowed);
+  int mode = opt.numa == numa_policy::bind ? mpol_bind : mpol_interleave;
+  syscall(SYS_mbind, p, len, mode, &mask, sizeof(mask) * 8 + 1, 0);
+#endif
+}
+
+// [bytes] from malloc below [opt.threshold], else from a fresh mapping on
+// 2MB boundaries, backed by huge pages where the system has them
+inline void* huge_page_allocate(size_t bytes, const huge_page_options& opt) {
+  if (bytes < opt.threshold) {
+    void* p = malloc(bytes);
+    if (!p && bytes)
+      throw std::bad_alloc();
+    return p;
+  }
+  size_t len = __huge_page_round(bytes);
+  void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  // fails unless pages were reserved in /proc/sys/vm/nr_hugepages
+  if (opt.explicit_pages)
+    p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+  if (p == MAP_FAILED) {
+    // transparent huge pages only back aligned 2MB ranges, so map a page more
+    // than needed and cut the ends off
+    char* raw = static_cast<char*>(mmap(nullptr, len + huge_page_size,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (raw == MAP_FAILED)
+      throw std::bad_alloc();
+    char* bgn = reinterpret_cast<char*>(
+        __huge_page_round(reinterpret_cast<uintptr_t>(raw)));
+    if (bgn != raw)
+      munmap(raw, bgn - raw);
+    munmap(bgn + len, raw + huge_page_size - bgn);
+    p = bgn;
+#ifdef MADV_HUGEPAGE
+    madvise(p, len, MADV_HUGEPAGE);
+#endif
+  }
+  __huge_page_place(p, len, opt);
+  return p;
+}
+// [bytes] & [opt] must be what [p] was allocated with
+inline void huge_page_deallocate(void* p,
+                                 size_t bytes,
+                                 const huge_page_options& opt);
+// resize [p] from [bytes] to [new_bytes], keeping the contents. malloc'ed
+// blocks are realloc'ed. a mapping is resized where it is if the addresses
+// after it are free, else its pages are moved(page tables, not bytes) to the
+// start of a new aligned mapping, so a huge buffer grows without ever being
+// held twice and stays on 2MB boundaries. reserved pages(MAP_HUGETLB) can
+// neither grow nor move, those are copied
+inline void* huge_page_reallocate(void* p,
+                                  size_t bytes,
+                                  size_t new_bytes,
+                                  const huge_page_options& opt) {
+  if (!p)
+    return huge_page_allocate(new_bytes, opt);
+  if (bytes < opt.threshold && new_bytes < opt.threshold) {
+    void* res = realloc(p, new_bytes);
+    if (!res && new_bytes)
+      throw std::bad_alloc();
+    return res;
+  }
+#ifdef MREMAP_MAYMOVE
+  if (bytes >= opt.threshold && new_bytes >= opt.threshold) {
+    size_t len = __huge_page_round(bytes);
+    size_t new_len = __huge_page_round(new_bytes);
+    if (mremap(p, len, new_len, 0) != MAP_FAILED)
+      return p;
+    void* res = huge_page_allocate(new_bytes, opt);
+#ifdef MREMAP_FIXED
+    // the old pages replace the head of the new mapping
+    if (!opt.explicit_pages && new_len > len &&
+        mremap(p, len, len, MREMAP_MAYMOVE | MREMAP_FIXED, res) != MAP_FAILED)
+      return res;
+#endif
+    memcpy(res, p, bytes < new_bytes ? bytes : new_bytes);
+    huge_page_deallocate(p, bytes, opt);
+    return res;
+  }
+#endif
+  void* res = huge_page_allocate(new_bytes, opt);
+  memcpy(res, p, bytes < new_bytes ? bytes : new_bytes);
+  huge_page_deallocate(p, bytes, opt);
+  return res;
+}
+inline void huge_page_deallocate(void* p,
+                                 size_t bytes,
+                                 const huge_page_options& opt) {
+  if (!p)
+    return;
+  if (bytes < opt.threshold)
+    return free(p);
+  munmap(p, __huge_page_round(bytes));
+}
+
+//============================ huge_page_allocator ===========================//
+// allocator for big flat buffers, e.g. the elements of a large vector or the
+// buckets of a large hash_table, whose random accesses otherwise miss the TLB
+// on every 4K page. small requests go to malloc unchanged
+template <class T>
+class huge_page_allocator {
+ public:
+  using value_type = T;
+
+  template <class U>
+  using other = huge_page_allocator<U>;
+
+  // ctor & dtor
+  huge_page_allocator() noexcept;
+  huge_page_allocator(const huge_page_options& opt) noexcept;
+  template <class U>
+  huge_page_allocator(const huge_page_allocator<U>& alloc) noexcept;
+
+  // mem
+  T* allocate(std::size_t n);
+  void deallocate(T* p, std::size_t n);
+  T* reallocate(T* p, std::size_t n, std::size_t new_n);
+
+  const huge_page_options& options() const noexcept;
+
+ private:
+  huge_page_options opt_;
+};
+
+template <class T>
+huge_page_allocator<T>::huge_page_allocator() noexcept {}
+
+template <class T>
+huge_page_allocator<T>::huge_page_allocator(
+    const huge_page_options& opt) noexcept
+    : opt_(opt) {}
+
+template <class T>
+template <class U>
+huge_page_allocator<T>::huge_page_allocator(
+    const huge_page_allocator<U>& alloc) noexcept
+    : opt_(alloc.options()) {}
+
+template <class T>
+T* huge_page_allocator<T>::allocate(std::size_t n) {
+  return static_cast<T*>(huge_page_allocate(n * sizeof(T), opt_));
+}
+
+template <class T>
+void huge_page_allocator<T>::deallocate(T* p, std::size_t n) {
+  huge_page_deallocate(p, n * sizeof(T), opt_);
+}
+
+template <class T>
+T* huge_page_allocator<T>::reallocate(T* p, std::size_t n, std::size_t new_n) {
+  return static_cast<T*>(
+      huge_page_reallocate(p, n * sizeof(T), new_n * sizeof(T), opt_));
+}
+
+template <class T>
+const huge_page_options& huge_page_allocator<T>::options() const noexcept {
+  return opt_;
+}
+
+// only the threshold decides how a buffer is freed
+template <class T, class U>
+bool operator==(const huge_page_allocator<T>& a,
+                const huge_page_allocator<U>& b) {
+  return a.options().threshold == b.options().threshold;
+}
+template <class T, class U>
+bool operator!=(const huge_page_allocator<T>& a,
+                const huge_page_allocator<U>& b) {
+  return !(a == b);
+}
+}  // namespace mrsuyi
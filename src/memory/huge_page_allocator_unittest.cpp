@@ -0,0 +1,119 @@
+#include <sys/mman.h>
+#include <cstdint>
+#include <cstring>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "container/hash_table.hpp"
+#include "container/vector.hpp"
+#include "huge_page_allocator.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(HugePageAllocatorTest, Allocate) {
+  huge_page_allocator<char> alloc;
+  // small buffers are left to malloc
+  char* small = alloc.allocate(100);
+  memset(small, 1, 100);
+  alloc.deallocate(small, 100);
+
+  // big ones are mapped on 2MB boundaries
+  size_t n = 3 * huge_page_size + 1;
+  char* big = alloc.allocate(n);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(big) % huge_page_size);
+  memset(big, 1, n);
+  EXPECT_EQ(1, big[n - 1]);
+  alloc.deallocate(big, n);
+
+  // explicit pages fall back when none are reserved, numa is only a hint
+  huge_page_options opt;
+  opt.threshold = 1 << 16;
+  opt.explicit_pages = true;
+  opt.numa = numa_policy::bind;
+  opt.nodes = 1;
+  huge_page_allocator<long> bound(opt);
+  long* p = bound.allocate(1 << 14);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % huge_page_size);
+  p[(1 << 14) - 1] = 1;
+  bound.deallocate(p, 1 << 14);
+
+  opt.numa = numa_policy::interleave;
+  opt.nodes = 0;
+  huge_page_allocator<int> spread(opt);
+  int* q = spread.allocate(1 << 20);
+  memset(q, 0, sizeof(int) << 20);
+  spread.deallocate(q, 1 << 20);
+
+  huge_page_allocator<int> rebound(bound);
+  assert(rebound == bound);
+  assert(rebound != alloc);
+}
+
+TEST(HugePageAllocatorTest, Reallocate) {
+  huge_page_options opt;
+  size_t n = huge_page_size;
+  char* p = static_cast<char*>(huge_page_allocate(n, opt));
+  memset(p, 7, n);
+  // grows where it is while the next addresses are free
+  void* after = mmap(p + n, huge_page_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (after != MAP_FAILED && after != p + n) {
+    munmap(after, huge_page_size);
+    after = MAP_FAILED;
+  }
+  if (after != MAP_FAILED) {
+    // else moves, to a 2MB boundary still
+    char* q = static_cast<char*>(huge_page_reallocate(p, n, 3 * n, opt));
+    EXPECT_NE(p, q);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(q) % huge_page_size);
+    EXPECT_EQ(7, q[0]);
+    EXPECT_EQ(7, q[n - 1]);
+    q[3 * n - 1] = 1;
+    munmap(after, huge_page_size);
+    p = q;
+    n *= 3;
+  }
+  char* q = static_cast<char*>(huge_page_reallocate(p, n, n + 1, opt));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(q) % huge_page_size);
+  EXPECT_EQ(7, q[huge_page_size - 1]);
+  huge_page_deallocate(q, n + 1, opt);
+
+  // reserved pages are copied when they can't grow, or fall back to
+  // transparent ones when none are reserved
+  opt.explicit_pages = true;
+  vector<int, huge_page_allocator<int>> v(opt);
+  for (int i = 0; i < (1 << 22); ++i) {
+    v.push_back(i);
+    if (v.size() == v.capacity() && v.size() * sizeof(int) >= opt.threshold)
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(v.data()) % huge_page_size);
+  }
+  EXPECT_EQ((1 << 22) - 1, v.back());
+  EXPECT_EQ(12345, v[12345]);
+}
+
+TEST(HugePageAllocatorTest, Containers) {
+  huge_page_options opt;
+  opt.threshold = 1 << 16;
+  vector<int, huge_page_allocator<int>> v(opt);
+  for (int i = 0; i < 100000; ++i)
+    v.push_back(i);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(v.data()) % huge_page_size);
+  EXPECT_EQ(99999, v.back());
+  // grown from malloc into a mapping, then remapped
+  for (int i = 100000; i < 1000000; ++i)
+    v.push_back(i);
+  for (int i = 0; i < 1000000; i += 1000)
+    EXPECT_EQ(i, v[i]);
+
+  // the buckets grow into mappings, the nodes stay below the threshold
+  hash_table<int, int, hash<int>, identity<int>, equal_to<int>,
+             huge_page_allocator<int>>
+      ht(16, hash<int>(), equal_to<int>(), opt);
+  for (int i = 0; i < 100000; ++i)
+    ht.emplace_unique(i);
+  EXPECT_EQ(100000, ht.size());
+  EXPECT_EQ(1, ht.count_unique(4242));
+  auto copy = ht;
+  EXPECT_EQ(1, copy.count_unique(99999));
+}
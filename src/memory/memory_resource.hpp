@@ -0,0 +1,269 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace mrsuyi {
+//=============================== memory_resource ============================//
+// where a polymorphic_allocator gets its memory from
+class memory_resource {
+ public:
+  virtual ~memory_resource() {}
+
+  void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+    return do_allocate(bytes, align);
+  }
+  void deallocate(void* p,
+                  size_t bytes,
+                  size_t align = alignof(std::max_align_t)) {
+    do_deallocate(p, bytes, align);
+  }
+  bool is_equal(const memory_resource& other) const noexcept {
+    return do_is_equal(other);
+  }
+
+ protected:
+  virtual void* do_allocate(size_t bytes, size_t align) = 0;
+  virtual void do_deallocate(void* p, size_t bytes, size_t align) = 0;
+  virtual bool do_is_equal(const memory_resource& other) const noexcept = 0;
+};
+
+inline bool operator==(const memory_resource& a, const memory_resource& b) {
+  return &a == &b || a.is_equal(b);
+}
+inline bool operator!=(const memory_resource& a, const memory_resource& b) {
+  return !(a == b);
+}
+
+// malloc & free
+class __new_delete_resource : public memory_resource {
+ protected:
+  void* do_allocate(size_t bytes, size_t align) override {
+    void* p;
+    if (align <= alignof(std::max_align_t)) {
+      p = malloc(bytes);
+      if (!p && bytes)
+        throw std::bad_alloc();
+    } else if (posix_memalign(&p, align, bytes)) {
+      throw std::bad_alloc();
+    }
+    return p;
+  }
+  void do_deallocate(void* p, size_t, size_t) override { free(p); }
+  bool do_is_equal(const memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+inline memory_resource* new_delete_resource() noexcept {
+  static __new_delete_resource res;
+  return &res;
+}
+
+//============================== monotonic_buffer ============================//
+// arena for memory that dies all at once, e.g. everything built while serving
+// one request. allocation bumps a pointer through the current chunk and
+// deallocation does nothing, memory only comes back through release() or the
+// dtor. chunks come from [upstream] and grow geometrically, an optional
+// initial buffer(typically on the stack) is used up first
+class monotonic_buffer : public memory_resource {
+ public:
+  // ctor & dtor
+  explicit monotonic_buffer(memory_resource* upstream = new_delete_resource());
+  // first chunk of [initial_size] bytes
+  monotonic_buffer(size_t initial_size,
+                   memory_resource* upstream = new_delete_resource());
+  // [buffer] of [size] bytes is used before asking [upstream], it is not owned
+  monotonic_buffer(void* buffer,
+                   size_t size,
+                   memory_resource* upstream = new_delete_resource());
+  monotonic_buffer(const monotonic_buffer&) = delete;
+  ~monotonic_buffer() override;
+
+  monotonic_buffer& operator=(const monotonic_buffer&) = delete;
+
+  // give every chunk back to upstream and start over from the initial buffer
+  void release();
+
+  // observers
+  memory_resource* upstream_resource() const;
+  // bytes taken from upstream and still held
+  size_t upstream_bytes() const;
+
+ protected:
+  void* do_allocate(size_t bytes, size_t align) override;
+  void do_deallocate(void*, size_t, size_t) override;
+  bool do_is_equal(const memory_resource& other) const noexcept override;
+
+  // header in front of each chunk from upstream
+  struct chunk {
+    chunk* prev;
+    size_t size;
+  };
+
+  // get a chunk with room for [bytes] aligned at [align]
+  void grow(size_t bytes, size_t align);
+
+  static const size_t default_size = 1024;
+  static const size_t growth_factor = 2;
+
+ protected:
+  memory_resource* upstream_;
+  void* initial_;
+  size_t initial_size_;
+  chunk* chunks_;
+  size_t upstream_bytes_;
+  // size of the next chunk
+  size_t next_size_;
+  // free part of the current chunk
+  char* cur_;
+  char* end_;
+};
+
+//==================================== basic =================================//
+inline monotonic_buffer::monotonic_buffer(memory_resource* upstream)
+    : monotonic_buffer(nullptr, 0, upstream) {}
+inline monotonic_buffer::monotonic_buffer(size_t initial_size,
+                                          memory_resource* upstream)
+    : monotonic_buffer(nullptr, 0, upstream) {
+  next_size_ = initial_size ? initial_size : default_size;
+}
+inline monotonic_buffer::monotonic_buffer(void* buffer,
+                                          size_t size,
+                                          memory_resource* upstream)
+    : upstream_(upstream),
+      initial_(buffer),
+      initial_size_(size),
+      chunks_(nullptr),
+      upstream_bytes_(0),
+      next_size_(size ? size * growth_factor : default_size),
+      cur_(static_cast<char*>(buffer)),
+      end_(static_cast<char*>(buffer) + size) {}
+inline monotonic_buffer::~monotonic_buffer() {
+  release();
+}
+
+inline void monotonic_buffer::release() {
+  while (chunks_) {
+    chunk* prev = chunks_->prev;
+    upstream_->deallocate(chunks_, chunks_->size, alignof(chunk));
+    chunks_ = prev;
+  }
+  upstream_bytes_ = 0;
+  cur_ = static_cast<char*>(initial_);
+  end_ = cur_ + initial_size_;
+}
+
+//================================= observers ================================//
+inline memory_resource* monotonic_buffer::upstream_resource() const {
+  return upstream_;
+}
+inline size_t monotonic_buffer::upstream_bytes() const {
+  return upstream_bytes_;
+}
+
+//================================= protected ================================//
+inline void* monotonic_buffer::do_allocate(size_t bytes, size_t align) {
+  uintptr_t p = (reinterpret_cast<uintptr_t>(cur_) + align - 1) & ~(align - 1);
+  if (!cur_ || p + bytes > reinterpret_cast<uintptr_t>(end_)) {
+    grow(bytes, align);
+    p = (reinterpret_cast<uintptr_t>(cur_) + align - 1) & ~(align - 1);
+  }
+  cur_ = reinterpret_cast<char*>(p + bytes);
+  return reinterpret_cast<void*>(p);
+}
+inline void monotonic_buffer::do_deallocate(void*, size_t, size_t) {}
+inline bool monotonic_buffer::do_is_equal(
+    const memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+inline void monotonic_buffer::grow(size_t bytes, size_t align) {
+  // the worst case padding after the header, so that a huge request still
+  // fits the chunk made for it
+  size_t need = sizeof(chunk) + bytes + align;
+  size_t size = next_size_;
+  while (size < need)
+    size *= growth_factor;
+  chunk* c = static_cast<chunk*>(upstream_->allocate(size, alignof(chunk)));
+  c->prev = chunks_;
+  c->size = size;
+  chunks_ = c;
+  upstream_bytes_ += size;
+  next_size_ = size * growth_factor;
+  cur_ = reinterpret_cast<char*>(c + 1);
+  end_ = reinterpret_cast<char*>(c) + size;
+}
+
+//============================ polymorphic_allocator =========================//
+// allocator over a memory_resource, containers of different resources share
+// one type. it is not propagated by copies: a copied container allocates from
+// the default resource, a moved one keeps the resource of its source
+template <class T>
+class polymorphic_allocator {
+ public:
+  using value_type = T;
+
+  template <class U>
+  using other = polymorphic_allocator<U>;
+
+  // ctor & dtor
+  polymorphic_allocator() noexcept;
+  polymorphic_allocator(memory_resource* resource) noexcept;
+  template <class U>
+  polymorphic_allocator(const polymorphic_allocator<U>& alloc) noexcept;
+
+  // mem
+  T* allocate(std::size_t n);
+  void deallocate(T* p, std::size_t n);
+
+  memory_resource* resource() const noexcept;
+
+ private:
+  memory_resource* resource_;
+};
+
+template <class T>
+polymorphic_allocator<T>::polymorphic_allocator() noexcept
+    : resource_(new_delete_resource()) {}
+
+template <class T>
+polymorphic_allocator<T>::polymorphic_allocator(
+    memory_resource* resource) noexcept
+    : resource_(resource) {}
+
+template <class T>
+template <class U>
+polymorphic_allocator<T>::polymorphic_allocator(
+    const polymorphic_allocator<U>& alloc) noexcept
+    : resource_(alloc.resource()) {}
+
+template <class T>
+T* polymorphic_allocator<T>::allocate(std::size_t n) {
+  return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+}
+
+template <class T>
+void polymorphic_allocator<T>::deallocate(T* p, std::size_t n) {
+  if (p)
+    resource_->deallocate(p, n * sizeof(T), alignof(T));
+}
+
+template <class T>
+memory_resource* polymorphic_allocator<T>::resource() const noexcept {
+  return resource_;
+}
+
+template <class T, class U>
+bool operator==(const polymorphic_allocator<T>& a,
+                const polymorphic_allocator<U>& b) {
+  return *a.resource() == *b.resource();
+}
+template <class T, class U>
+bool operator!=(const polymorphic_allocator<T>& a,
+                const polymorphic_allocator<U>& b) {
+  return !(a == b);
+}
+}  // namespace mrsuyi
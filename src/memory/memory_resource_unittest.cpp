@@ -0,0 +1,104 @@
+#include <cstdint>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "container/flat_hash_table.hpp"
+#include "container/forward_list.hpp"
+#include "container/hash_table.hpp"
+#include "container/list.hpp"
+#include "container/vector.hpp"
+#include "memory_resource.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(MonotonicBufferTest, Allocate) {
+  alignas(64) char buf[256];
+  monotonic_buffer arena(buf, sizeof(buf));
+  // the initial buffer goes first
+  char* a = static_cast<char*>(arena.allocate(100, 1));
+  EXPECT_EQ(buf, a);
+  char* b = static_cast<char*>(arena.allocate(8, 8));
+  EXPECT_EQ(buf + 104, b);
+  EXPECT_EQ(0, arena.upstream_bytes());
+  // deallocation gives nothing back
+  arena.deallocate(b, 8, 8);
+  EXPECT_EQ(buf + 112, arena.allocate(1, 1));
+
+  // then chunks from upstream, which grow
+  void* c = arena.allocate(200, 64);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(c) % 64);
+  size_t first = arena.upstream_bytes();
+  EXPECT_GE(first, 200);
+  for (int i = 0; i < 100; ++i)
+    memset(arena.allocate(100), i, 100);
+  EXPECT_GE(arena.upstream_bytes(), first * 3);
+  // larger than the next chunk
+  memset(arena.allocate(1 << 20), 0, 1 << 20);
+
+  arena.release();
+  EXPECT_EQ(0, arena.upstream_bytes());
+  EXPECT_EQ(buf, arena.allocate(1, 1));
+
+  monotonic_buffer other(64);
+  EXPECT_EQ(new_delete_resource(), other.upstream_resource());
+  assert(arena == arena);
+  assert(arena != other);
+}
+
+TEST(MonotonicBufferTest, Containers) {
+  char buf[1024];
+  monotonic_buffer arena(buf, sizeof(buf));
+  using alloc = polymorphic_allocator<int>;
+
+  vector<int, alloc> v(&arena);
+  for (int i = 0; i < 100; ++i)
+    v.push_back(i);
+  EXPECT_EQ(99, v.back());
+  // moves keep the resource
+  auto moved = move(v);
+  assert(moved.get_allocator() == alloc(&arena));
+  moved.push_back(100);
+  EXPECT_EQ(101, moved.size());
+
+  list<int, alloc> l({1, 2, 3}, &arena);
+  l.push_back(4);
+  l.pop_front();
+  EXPECT_THAT(l, ElementsAre(2, 3, 4));
+  auto l2 = move(l);
+  l.push_back(5);
+  EXPECT_THAT(l, ElementsAre(5));
+
+  forward_list<int, alloc> fl({1, 2, 3}, &arena);
+  fl.push_front(0);
+  EXPECT_THAT(fl, ElementsAre(0, 1, 2, 3));
+
+  hash_table<int, int, hash<int>, identity<int>, equal_to<int>, alloc> ht(
+      16, hash<int>(), equal_to<int>(), &arena);
+  for (int i = 0; i < 1000; ++i)
+    ht.emplace_unique(i);
+  for (int i = 0; i < 1000; i += 2)
+    ht.erase_unique(i);
+  EXPECT_EQ(500, ht.size());
+  EXPECT_EQ(1, ht.count_unique(999));
+  EXPECT_GT(arena.upstream_bytes(), 1000 * sizeof(int));
+
+  // copies go to the default resource
+  auto copy = ht;
+  EXPECT_EQ(500, copy.size());
+  EXPECT_EQ(new_delete_resource(), copy.get_allocator().resource());
+  auto ht_moved = move(ht);
+  EXPECT_EQ(&arena, ht_moved.get_allocator().resource());
+  auto v_copy = moved;
+  EXPECT_EQ(new_delete_resource(), v_copy.get_allocator().resource());
+
+  flat_hash_table<int, int, hash<int>, identity<int>, equal_to<int>, alloc>
+      flat(16, hash<int>(), equal_to<int>(), &arena);
+  for (int i = 0; i < 100; ++i)
+    flat.emplace_unique(i);
+  auto flat_copy = flat;
+  EXPECT_EQ(100, flat_copy.size());
+  EXPECT_EQ(new_delete_resource(), flat_copy.get_allocator().resource());
+  auto flat_moved = move(flat);
+  EXPECT_EQ(&arena, flat_moved.get_allocator().resource());
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace mrsuyi {
+//================================ size classes ==============================//
+// requests up to [pool_max_size] bytes are rounded up to a multiple of
+// [pool_granularity] and served from the pool of that size, larger ones go to
+// malloc
+static const size_t pool_granularity = 16;
+static const size_t pool_max_size = 256;
+static const size_t pool_classes = pool_max_size / pool_granularity;
+// bytes carved from malloc at a time by a pool
+static const size_t pool_chunk_size = 64 * 1024;
+// blocks moved between a thread cache and its pool at a time
+static const size_t pool_batch = 32;
+
+// a free block, linked through its first bytes
+struct __pool_block {
+  __pool_block* next;
+};
+
+// blocks of one size class shared by all threads. chunks are never given back
+// to the system, freed blocks wait for the next allocation of their size
+class __pool_central {
+ public:
+  __pool_central() : free_(nullptr), cur_(nullptr), end_(nullptr), size_(0) {}
+  __pool_central(const __pool_central&) = delete;
+  __pool_central& operator=(const __pool_central&) = delete;
+
+  void init(size_t block_size) { size_ = block_size; }
+  // link [n] blocks into a list, returned by its head
+  __pool_block* take(size_t n) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    __pool_block* head = nullptr;
+    for (; n && free_; --n) {
+      __pool_block* b = free_;
+      free_ = b->next;
+      b->next = head;
+      head = b;
+    }
+    for (; n; --n) {
+      if (cur_ == end_) {
+        cur_ = static_cast<char*>(malloc(pool_chunk_size));
+        if (!cur_)
+          throw std::bad_alloc();
+        end_ = cur_ + pool_chunk_size / size_ * size_;
+      }
+      __pool_block* b = reinterpret_cast<__pool_block*>(cur_);
+      cur_ += size_;
+      b->next = head;
+      head = b;
+    }
+    return head;
+  }
+  // take back the list [first, last]
+  void give(__pool_block* first, __pool_block* last) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    last->next = free_;
+    free_ = first;
+  }
+
+ private:
+  std::mutex mutex_;
+  __pool_block* free_;
+  // rest of the current chunk
+  char* cur_;
+  char* end_;
+  size_t size_;
+};
+
+// all pools, built on first use and kept for the whole process so that the
+// caches of threads exiting late can still flush into them
+inline __pool_central* __pool_centrals() {
+  static __pool_central* centrals = [] {
+    __pool_central* res = new __pool_central[pool_classes];
+    for (size_t i = 0; i < pool_classes; ++i)
+      res[i].init((i + 1) * pool_granularity);
+    return res;
+  }();
+  return centrals;
+}
+
+// set once the cache of the calling thread is destroyed, blocks allocated or
+// freed by thread_local objects destroyed after it go straight to the pools
+inline bool& __pool_cache_gone() {
+  static thread_local bool gone = false;
+  return gone;
+}
+
+// per-thread free lists in front of the pools, most allocations and
+// deallocations never lock. a thread flushes its blocks back when it exits
+class __pool_cache {
+ public:
+  __pool_cache() {
+    for (size_t i = 0; i < pool_classes; ++i) {
+      lists_[i].head = nullptr;
+      lists_[i].count = 0;
+    }
+  }
+  ~__pool_cache() {
+    for (size_t i = 0; i < pool_classes; ++i)
+      if (lists_[i].head)
+        flush(i, lists_[i].count);
+    __pool_cache_gone() = true;
+  }
+
+  void* allocate(size_t cls) {
+    list& l = lists_[cls];
+    if (!l.head) {
+      l.head = __pool_centrals()[cls].take(pool_batch);
+      l.count = pool_batch;
+    }
+    __pool_block* b = l.head;
+    l.head = b->next;
+    --l.count;
+    return b;
+  }
+  void deallocate(void* p, size_t cls) {
+    list& l = lists_[cls];
+    __pool_block* b = static_cast<__pool_block*>(p);
+    b->next = l.head;
+    l.head = b;
+    // keep up to two batches, so that alternating allocations &
+    // deallocations at the boundary don't hit the pool every time
+    if (++l.count >= 2 * pool_batch)
+      flush(cls, pool_batch);
+  }
+
+ private:
+  struct list {
+    __pool_block* head;
+    size_t count;
+  };
+
+  // give the first [n] blocks of list [cls] back to the pool
+  void flush(size_t cls, size_t n) {
+    list& l = lists_[cls];
+    __pool_block* first = l.head;
+    __pool_block* last = first;
+    for (size_t i = 1; i < n; ++i)
+      last = last->next;
+    l.head = last->next;
+    l.count -= n;
+    __pool_centrals()[cls].give(first, last);
+  }
+
+  list lists_[pool_classes];
+};
+
+inline __pool_cache& __pool_thread_cache() {
+  static thread_local __pool_cache cache;
+  return cache;
+}
+
+// [bytes] from the pool of its size class, or from malloc above
+// [pool_max_size]
+inline void* pool_allocate(size_t bytes) {
+  if (!bytes || bytes > pool_max_size) {
+    void* p = malloc(bytes);
+    if (!p && bytes)
+      throw std::bad_alloc();
+    return p;
+  }
+  size_t cls = (bytes - 1) / pool_granularity;
+  if (__pool_cache_gone())
+    return __pool_centrals()[cls].take(1);
+  return __pool_thread_cache().allocate(cls);
+}
+// [bytes] must be what [p] was allocated with. blocks may be freed by another
+// thread than the one that allocated them
+inline void pool_deallocate(void* p, size_t bytes) {
+  if (!p)
+    return;
+  if (!bytes || bytes > pool_max_size)
+    return free(p);
+  size_t cls = (bytes - 1) / pool_granularity;
+  if (__pool_cache_gone()) {
+    __pool_block* b = static_cast<__pool_block*>(p);
+    return __pool_centrals()[cls].give(b, b);
+  }
+  __pool_thread_cache().deallocate(p, cls);
+}
+
+//=============================== pool_allocator =============================//
+// stateless allocator over the pools, meant for node-based containers, which
+// rebind it to their node type through other<>
+template <class T>
+class pool_allocator {
+ public:
+  using value_type = T;
+
+  template <class U>
+  using other = pool_allocator<U>;
+
+  // ctor & dtor
+  pool_allocator() noexcept;
+  template <class U>
+  pool_allocator(const pool_allocator<U>& alloc) noexcept;
+  ~pool_allocator() noexcept;
+
+  // mem
+  T* allocate(std::size_t n);
+  void deallocate(T* p, std::size_t n);
+};
+
+template <class T>
+pool_allocator<T>::pool_allocator() noexcept {}
+
+template <class T>
+template <class U>
+pool_allocator<T>::pool_allocator(const pool_allocator<U>&) noexcept {}
+
+template <class T>
+pool_allocator<T>::~pool_allocator() noexcept {}
+
+template <class T>
+T* pool_allocator<T>::allocate(std::size_t n) {
+  static_assert(alignof(T) <= pool_granularity,
+                "pool_allocator can't align T");
+  return static_cast<T*>(pool_allocate(n * sizeof(T)));
+}
+
+template <class T>
+void pool_allocator<T>::deallocate(T* p, std::size_t n) {
+  pool_deallocate(p, n * sizeof(T));
+}
+
+template <class T, class U>
+bool operator==(const pool_allocator<T>&, const pool_allocator<U>&) {
+  return true;
+}
+template <class T, class U>
+bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&) {
+  return false;
+}
+}  // namespace mrsuyi
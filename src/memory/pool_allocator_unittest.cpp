@@ -0,0 +1,96 @@
+#include <thread>
+#include <vector>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "container/forward_list.hpp"
+#include "container/hash_table.hpp"
+#include "container/list.hpp"
+#include "pool_allocator.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(PoolAllocatorTest, Allocate) {
+  pool_allocator<int> alloc;
+  // freed blocks are reused first
+  int* a = alloc.allocate(1);
+  *a = 1;
+  alloc.deallocate(a, 1);
+  EXPECT_EQ(a, alloc.allocate(1));
+
+  // blocks of one size class never overlap
+  std::vector<char*> blocks;
+  for (int i = 0; i < 1000; ++i) {
+    blocks.push_back(static_cast<char*>(pool_allocate(40)));
+    memset(blocks.back(), i, 40);
+  }
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(char(i), blocks[i][39]);
+  for (char* b : blocks)
+    pool_deallocate(b, 40);
+
+  // beyond the largest class
+  pool_allocator<double> big;
+  double* d = big.allocate(1000);
+  d[999] = 1;
+  big.deallocate(d, 1000);
+
+  pool_allocator<long> rebound(alloc);
+  assert(rebound == alloc);
+}
+
+TEST(PoolAllocatorTest, Containers) {
+  list<int, pool_allocator<int>> l = {1, 2, 3};
+  l.push_back(4);
+  l.pop_front();
+  EXPECT_THAT(l, ElementsAre(2, 3, 4));
+
+  forward_list<int, pool_allocator<int>> fl = {1, 2, 3};
+  fl.push_front(0);
+  EXPECT_THAT(fl, ElementsAre(0, 1, 2, 3));
+
+  hash_table<int, int, hash<int>, identity<int>, equal_to<int>,
+             pool_allocator<int>>
+      ht;
+  for (int i = 0; i < 1000; ++i)
+    ht.emplace_unique(i);
+  for (int i = 0; i < 1000; i += 2)
+    ht.erase_unique(i);
+  auto nh = ht.extract(1);
+  EXPECT_EQ(1, nh.value());
+  auto copy = ht;
+  EXPECT_EQ(499, copy.size());
+  EXPECT_EQ(1, copy.count_unique(999));
+}
+
+TEST(PoolAllocatorTest, Threads) {
+  // blocks allocated on one thread and freed on another
+  const int threads = 4, per_thread = 10000;
+  std::vector<std::vector<int*>> made(threads);
+  std::vector<std::thread> pool;
+  for (int t = 0; t < threads; ++t) {
+    pool.emplace_back([&made, t] {
+      pool_allocator<int> alloc;
+      for (int i = 0; i < per_thread; ++i) {
+        made[t].push_back(alloc.allocate(1));
+        *made[t].back() = t;
+      }
+    });
+  }
+  for (auto& th : pool)
+    th.join();
+  pool.clear();
+  for (int t = 0; t < threads; ++t) {
+    pool.emplace_back([&made, t, threads] {
+      pool_allocator<int> alloc;
+      auto& mine = made[(t + 1) % threads];
+      for (int* p : mine) {
+        EXPECT_EQ((t + 1) % threads, *p);
+        alloc.deallocate(p, 1);
+      }
+    });
+  }
+  for (auto& th : pool)
+    th.join();
+}
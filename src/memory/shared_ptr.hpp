@@ -3,6 +3,7 @@
 #include <cstddef>
 #include "allocator.hpp"
 #include "deleter.hpp"
+#include "functions.hpp"
 #include "unique_ptr.hpp"
 #include "weak_ptr.hpp"
 
@@ -403,4 +404,8 @@ template <class T>
 bool operator>=(const shared_ptr<T>& lhs, std::nullptr_t) noexcept {
   return lhs.get() >= nullptr;
 }
+
+// the control block holds no pointer back to the shared_ptr
+template <class T>
+struct is_trivially_relocatable<shared_ptr<T>> : std::true_type {};
 }  // namespace mrsuyi
@@ -0,0 +1,328 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#endif
+#include "allocator.hpp"
+
+namespace mrsuyi {
+//================================== snapshot ================================//
+// totals of one allocation_tag at some point in time
+struct allocation_snapshot {
+  const char* label;
+  // bytes currently allocated, the most ever at once, and all ever allocated
+  size_t live_bytes;
+  size_t peak_bytes;
+  size_t total_bytes;
+  // the same in allocate calls
+  size_t live_calls;
+  size_t peak_calls;
+  size_t total_calls;
+  // allocations that got their stack captured
+  size_t samples;
+};
+
+static const size_t max_sample_frames = 32;
+
+// a sampled allocation. [weight] is the bytes it stands for, about the sample
+// interval, so summing the weights per stack estimates where bytes come from
+struct allocation_sample {
+  size_t bytes;
+  size_t weight;
+  size_t depth;
+  void* frames[max_sample_frames];
+};
+
+// allocation counters & sampling, compiled in by defining
+// MRSUYI_TRACK_ALLOCATIONS and empty otherwise, in which case a
+// tracking_allocator costs nothing over its inner allocator
+#ifdef MRSUYI_TRACK_ALLOCATIONS
+static const bool allocation_tracking = true;
+#else
+static const bool allocation_tracking = false;
+#endif
+template <bool Enabled>
+struct allocation_counters {
+  void allocated(size_t) {}
+  void deallocated(size_t) {}
+  void set_sample_interval(size_t) {}
+  void fill(allocation_snapshot&) const {}
+  template <class F>
+  void for_each_sample(F) const {}
+};
+template <>
+struct allocation_counters<true> {
+  // samples kept per tag, later ones overwrite the oldest
+  static const size_t max_samples = 1024;
+
+  allocation_counters() : samples(nullptr) {}
+  ~allocation_counters() { delete[] samples; }
+
+  void allocated(size_t bytes) {
+    raise(peak_bytes, live_bytes.fetch_add(bytes) + bytes);
+    raise(peak_calls, live_calls.fetch_add(1) + 1);
+    total_bytes += bytes;
+    ++total_calls;
+    size_t interval = sample_interval.load(std::memory_order_relaxed);
+    if (interval) {
+      // a sample each time the bytes seen cross a multiple of the interval,
+      // as with tcmalloc, big allocations are the likeliest to be caught
+      size_t before = sample_bytes.fetch_add(bytes);
+      if (before / interval != (before + bytes) / interval)
+        sample(bytes, interval);
+    }
+  }
+  void deallocated(size_t bytes) {
+    live_bytes -= bytes;
+    --live_calls;
+  }
+  void set_sample_interval(size_t bytes) { sample_interval = bytes; }
+  void fill(allocation_snapshot& st) const {
+    st.live_bytes = live_bytes;
+    st.peak_bytes = peak_bytes;
+    st.total_bytes = total_bytes;
+    st.live_calls = live_calls;
+    st.peak_calls = peak_calls;
+    st.total_calls = total_calls;
+    std::lock_guard<std::mutex> guard(mutex);
+    st.samples = sample_count;
+  }
+  template <class F>
+  void for_each_sample(F f) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    size_t n = sample_count < max_samples ? sample_count : max_samples;
+    for (size_t i = 0; i < n; ++i)
+      f(static_cast<const allocation_sample&>(samples[i]));
+  }
+
+  // lift [peak] to [now] unless another thread got it higher already
+  static void raise(std::atomic<size_t>& peak, size_t now) {
+    size_t seen = peak.load(std::memory_order_relaxed);
+    while (seen < now && !peak.compare_exchange_weak(seen, now)) {
+    }
+  }
+  void sample(size_t bytes, size_t interval) {
+    allocation_sample s;
+    s.bytes = bytes;
+    s.weight = bytes > interval ? bytes : interval;
+#if defined(__GLIBC__)
+    s.depth = backtrace(s.frames, max_sample_frames);
+#else
+    s.depth = 0;
+#endif
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!samples)
+      samples = new allocation_sample[max_samples];
+    samples[sample_count++ % max_samples] = s;
+  }
+
+  std::atomic<size_t> live_bytes{0};
+  std::atomic<size_t> peak_bytes{0};
+  std::atomic<size_t> total_bytes{0};
+  std::atomic<size_t> live_calls{0};
+  std::atomic<size_t> peak_calls{0};
+  std::atomic<size_t> total_calls{0};
+  std::atomic<size_t> sample_interval{0};
+  std::atomic<size_t> sample_bytes{0};
+  mutable std::mutex mutex;
+  allocation_sample* samples;
+  size_t sample_count = 0;
+};
+
+//=============================== allocation_tag =============================//
+// named set of counters shared by every tracking_allocator pointing at it,
+// typically one per container or per kind of container. tags register
+// themselves so that all of them can be dumped at once, they must outlive the
+// allocators using them
+class allocation_tag {
+ public:
+  // ctor & dtor
+  // [label] is not copied
+  explicit allocation_tag(const char* label);
+  allocation_tag(const allocation_tag&) = delete;
+  ~allocation_tag();
+
+  allocation_tag& operator=(const allocation_tag&) = delete;
+
+  // record
+  void allocated(size_t bytes);
+  void deallocated(size_t bytes);
+  // capture the stack of about one allocation every [bytes] bytes, 0 to stop
+  void set_sample_interval(size_t bytes);
+
+  // observers
+  const char* label() const;
+  allocation_snapshot snapshot() const;
+  // visit the samples kept, the latest [max_samples] of them in no order
+  template <class F>
+  void for_each_sample(F f) const;
+
+  // visit every live tag
+  template <class F>
+  static void for_each(F f);
+
+ protected:
+  static std::mutex& registry_mutex();
+  static allocation_tag*& registry();
+
+ protected:
+  const char* label_;
+  allocation_counters<allocation_tracking> counters_;
+  allocation_tag* prev_;
+  allocation_tag* next_;
+};
+
+// where default-constructed tracking_allocators count
+inline allocation_tag* untagged_allocations() {
+  static allocation_tag* tag = new allocation_tag("untagged");
+  return tag;
+}
+
+//==================================== basic =================================//
+inline allocation_tag::allocation_tag(const char* label)
+    : label_(label), prev_(nullptr) {
+  std::lock_guard<std::mutex> guard(registry_mutex());
+  next_ = registry();
+  if (next_)
+    next_->prev_ = this;
+  registry() = this;
+}
+inline allocation_tag::~allocation_tag() {
+  std::lock_guard<std::mutex> guard(registry_mutex());
+  if (prev_)
+    prev_->next_ = next_;
+  else
+    registry() = next_;
+  if (next_)
+    next_->prev_ = prev_;
+}
+
+//=================================== record =================================//
+inline void allocation_tag::allocated(size_t bytes) {
+  counters_.allocated(bytes);
+}
+inline void allocation_tag::deallocated(size_t bytes) {
+  counters_.deallocated(bytes);
+}
+inline void allocation_tag::set_sample_interval(size_t bytes) {
+  counters_.set_sample_interval(bytes);
+}
+
+//================================= observers ================================//
+inline const char* allocation_tag::label() const {
+  return label_;
+}
+inline allocation_snapshot allocation_tag::snapshot() const {
+  allocation_snapshot st = {label_, 0, 0, 0, 0, 0, 0, 0};
+  counters_.fill(st);
+  return st;
+}
+template <class F>
+void allocation_tag::for_each_sample(F f) const {
+  counters_.for_each_sample(f);
+}
+template <class F>
+void allocation_tag::for_each(F f) {
+  std::lock_guard<std::mutex> guard(registry_mutex());
+  for (allocation_tag* t = registry(); t; t = t->next_)
+    f(static_cast<const allocation_tag&>(*t));
+}
+
+//================================= protected ================================//
+inline std::mutex& allocation_tag::registry_mutex() {
+  static std::mutex* mutex = new std::mutex;
+  return *mutex;
+}
+inline allocation_tag*& allocation_tag::registry() {
+  static allocation_tag* head = nullptr;
+  return head;
+}
+
+//============================= tracking_allocator ===========================//
+// [Inner] counted against an allocation_tag, e.g.
+//   allocation_tag tag("sessions");
+//   vector<int, tracking_allocator<allocator<int>>> v(&tag);
+template <class Inner>
+class tracking_allocator {
+ public:
+  using value_type = typename Inner::value_type;
+  using inner_allocator_type = Inner;
+
+  template <class U>
+  using other = tracking_allocator<typename Inner::template other<U>>;
+
+  // ctor & dtor
+  tracking_allocator() noexcept;
+  tracking_allocator(allocation_tag* tag,
+                     const Inner& inner = Inner()) noexcept;
+  template <class I>
+  tracking_allocator(const tracking_allocator<I>& alloc) noexcept;
+
+  // mem
+  value_type* allocate(std::size_t n);
+  void deallocate(value_type* p, std::size_t n);
+
+  allocation_tag* tag() const noexcept;
+  const Inner& inner() const noexcept;
+
+ private:
+  allocation_tag* tag_;
+  Inner inner_;
+};
+
+template <class Inner>
+tracking_allocator<Inner>::tracking_allocator() noexcept
+    : tag_(untagged_allocations()) {}
+
+template <class Inner>
+tracking_allocator<Inner>::tracking_allocator(allocation_tag* tag,
+                                              const Inner& inner) noexcept
+    : tag_(tag), inner_(inner) {}
+
+template <class Inner>
+template <class I>
+tracking_allocator<Inner>::tracking_allocator(
+    const tracking_allocator<I>& alloc) noexcept
+    : tag_(alloc.tag()), inner_(alloc.inner()) {}
+
+template <class Inner>
+typename Inner::value_type* tracking_allocator<Inner>::allocate(
+    std::size_t n) {
+  value_type* p = inner_.allocate(n);
+  if (allocation_tracking)
+    tag_->allocated(n * sizeof(value_type));
+  return p;
+}
+
+template <class Inner>
+void tracking_allocator<Inner>::deallocate(value_type* p, std::size_t n) {
+  // containers free null with a size of 0, which changes nothing
+  if (allocation_tracking && p)
+    tag_->deallocated(n * sizeof(value_type));
+  inner_.deallocate(p, n);
+}
+
+template <class Inner>
+allocation_tag* tracking_allocator<Inner>::tag() const noexcept {
+  return tag_;
+}
+
+template <class Inner>
+const Inner& tracking_allocator<Inner>::inner() const noexcept {
+  return inner_;
+}
+
+template <class I, class J>
+bool operator==(const tracking_allocator<I>& a,
+                const tracking_allocator<J>& b) {
+  return a.tag() == b.tag() && a.inner() == b.inner();
+}
+template <class I, class J>
+bool operator!=(const tracking_allocator<I>& a,
+                const tracking_allocator<J>& b) {
+  return !(a == b);
+}
+}  // namespace mrsuyi
@@ -0,0 +1,109 @@
+#include <cstring>
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "container/hash_table.hpp"
+#include "container/list.hpp"
+#include "container/vector.hpp"
+#include "memory_resource.hpp"
+#include "tracking_allocator.hpp"
+
+using namespace mrsuyi;
+using namespace testing;
+
+TEST(TrackingAllocatorTest, Counters) {
+  allocation_tag tag("counters");
+  tracking_allocator<allocator<int>> alloc(&tag);
+  int* a = alloc.allocate(10);
+  int* b = alloc.allocate(5);
+  alloc.deallocate(a, 10);
+  int* c = alloc.allocate(1);
+  alloc.deallocate(b, 5);
+  alloc.deallocate(c, 1);
+
+  auto st = tag.snapshot();
+  EXPECT_STREQ("counters", st.label);
+  // counters only exist with MRSUYI_TRACK_ALLOCATIONS
+  if (allocation_tracking) {
+    EXPECT_EQ(0, st.live_bytes);
+    EXPECT_EQ(15 * sizeof(int), st.peak_bytes);
+    EXPECT_EQ(16 * sizeof(int), st.total_bytes);
+    EXPECT_EQ(0, st.live_calls);
+    EXPECT_EQ(2, st.peak_calls);
+    EXPECT_EQ(3, st.total_calls);
+  } else {
+    EXPECT_EQ(0, st.peak_bytes + st.total_bytes + st.total_calls);
+  }
+
+  // rebinding keeps the tag
+  tracking_allocator<allocator<double>> rebound(alloc);
+  EXPECT_EQ(&tag, rebound.tag());
+  assert(rebound == alloc);
+  EXPECT_EQ(untagged_allocations(), tracking_allocator<allocator<int>>().tag());
+
+  bool found = false;
+  allocation_tag::for_each([&found, &tag](const allocation_tag& t) {
+    found |= &t == &tag;
+  });
+  EXPECT_TRUE(found);
+}
+
+TEST(TrackingAllocatorTest, Containers) {
+  allocation_tag vectors("vectors"), tables("tables");
+  {
+    using alloc = tracking_allocator<allocator<int>>;
+    vector<int, alloc> v(&vectors);
+    for (int i = 0; i < 1000; ++i)
+      v.push_back(i);
+    hash_table<int, int, hash<int>, identity<int>, equal_to<int>, alloc> ht(
+        16, hash<int>(), equal_to<int>(), &tables);
+    for (int i = 0; i < 1000; ++i)
+      ht.emplace_unique(i);
+    if (allocation_tracking) {
+      EXPECT_EQ(v.capacity() * sizeof(int), vectors.snapshot().live_bytes);
+      // the nodes and the bucket array
+      EXPECT_EQ(1000 + 1, tables.snapshot().live_calls);
+    }
+  }
+  if (allocation_tracking) {
+    EXPECT_EQ(0, vectors.snapshot().live_bytes);
+    EXPECT_EQ(0, tables.snapshot().live_bytes);
+    EXPECT_GT(tables.snapshot().peak_bytes, 1000 * sizeof(int));
+  }
+
+  // over another stateful allocator
+  char buf[4096];
+  monotonic_buffer arena(buf, sizeof(buf));
+  allocation_tag lists("lists");
+  using arena_alloc = tracking_allocator<polymorphic_allocator<int>>;
+  list<int, arena_alloc> l({1, 2, 3}, arena_alloc(&lists, &arena));
+  EXPECT_THAT(l, ElementsAre(1, 2, 3));
+  if (allocation_tracking) {
+    EXPECT_EQ(4, lists.snapshot().live_calls);
+  }
+}
+
+TEST(TrackingAllocatorTest, Samples) {
+  allocation_tag tag("samples");
+  tag.set_sample_interval(1024);
+  tracking_allocator<allocator<char>> alloc(&tag);
+  for (int i = 0; i < 100; ++i)
+    alloc.deallocate(alloc.allocate(128), 128);
+  char* big = alloc.allocate(1 << 16);
+  alloc.deallocate(big, 1 << 16);
+
+  size_t samples = 0, weight = 0;
+  tag.for_each_sample([&](const allocation_sample& s) {
+    ++samples;
+    weight += s.weight;
+    EXPECT_LE(s.depth, max_sample_frames);
+  });
+  EXPECT_EQ(tag.snapshot().samples, samples);
+  if (allocation_tracking) {
+    // 12800 bytes in 128s and one big block
+    EXPECT_EQ(13, samples);
+    EXPECT_EQ(12 * 1024 + (1 << 16), weight);
+  } else {
+    EXPECT_EQ(0, samples);
+  }
+}
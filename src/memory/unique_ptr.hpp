@@ -2,6 +2,7 @@
 
 #include <type_traits>
 #include "deleter.hpp"
+#include "functions.hpp"
 
 namespace mrsuyi {
 //========================== general unique-ptr ==============================//
@@ -263,4 +264,10 @@ bool operator>=(const unique_ptr<T, D>& lhs, std::nullptr_t) noexcept {
   return lhs.get() >= nullptr;
 }
 
+// a unique_ptr is its pointer & deleter, it may be relocated bytewise as long
+// as the deleter may
+template <class T, class D>
+struct is_trivially_relocatable<unique_ptr<T, D>>
+    : is_trivially_relocatable<D> {};
+
 }  // namespace mrsuyi
@@ -21,12 +21,14 @@ struct pair {
   template <class U, class V>
   pair(const pair<U, V>& p) : first(p.first), second(p.second) {}
   template <class U, class V>
-  pair(pair<U, V>&& p) : first(move(p.first)), second(move(p.second)) {}
+  pair(pair<U, V>&& p)
+      : first(mrsuyi::move(p.first)), second(mrsuyi::move(p.second)) {}
 
   // initialization
   pair(const T1&, const T2&);
   template <class U, class V>
-  pair(U&& a, V&& b) : first(move(a)), second(move(b)) {}
+  pair(U&& a, V&& b)
+      : first(mrsuyi::forward<U>(a)), second(mrsuyi::forward<V>(b)) {}
 
   // = assign
   pair& operator=(const pair&) = default;
@@ -52,7 +54,7 @@ struct pair {
 
 template <class T1, class T2>
 constexpr pair<T1, T2> make_pair(T1&& t1, T2&& t2) {
-  return pair<T1, T2>(move(t1), move(t2));
+  return pair<T1, T2>(mrsuyi::move(t1), mrsuyi::move(t2));
 }
 
 template <class T1, class T2>
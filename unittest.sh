@@ -1,4 +1,5 @@
 #!/usr/bin/env bash
 
 ninja -v -C out -j 10 &&
-out/unittest
+out/unittest &&
+out/unittest_instrumented